@@ -0,0 +1,277 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Clock.h>				// for Clock
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/OSServices.h>			// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor
+#include <AutopinPlus/ProcessTree.h>		// for ProcessTree, etc
+#include <AutopinPlus/SharedOSServices.h>	// for SharedOSServices
+#include <QList>							// for QList
+#include <QObject>							// for QObject
+#include <QString>							// for QString
+#include <QTimer>							// for QTimer
+#include <set>								// for set
+#include <utility>							// for pair
+
+namespace AutopinPlus {
+
+/*!
+ * \brief Splits the cpus of the system between several observed applications.
+ *
+ * Every application gets a share of whole cores which is tuned by its own control strategy. The shares are split
+ * according to the weights of the applications and rebalanced periodically: one core is moved from one application
+ * to another and the move is kept if it improves the global objective, otherwise it is reverted. The performance of
+ * every application is measured with its own performance monitor.
+ */
+class Arbiter : public QObject {
+	Q_OBJECT
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config  Pointer to the global configuration
+	 * \param[in] service Pointer to the os services of the system
+	 * \param[in] context Refernce to the context of the object calling the constructor
+	 */
+	Arbiter(Configuration *config, OSServices *service, const AutopinContext &context);
+
+	/*!
+	 * \brief Adds an application
+	 *
+	 * All applications have to be added before calling init().
+	 *
+	 * \param[in] name   The name of the application
+	 * \param[in] config The configuration of the application
+	 * \param[in] share  The os services which restrict the application to its share
+	 */
+	void addApplication(QString name, Configuration *config, SharedOSServices *share);
+
+	/*!
+	 * \brief Reads the configuration and splits the cpus between the applications
+	 */
+	void init();
+
+	/*!
+	 * \brief Sets the process and the performance monitor of an application
+	 *
+	 * \param[in] name    The name of the application
+	 * \param[in] proc    The observed process of the application
+	 * \param[in] monitor The performance monitor used for measuring the application
+	 */
+	void observe(QString name, ObservedProcess *proc, PerformanceMonitor *monitor);
+
+	/*!
+	 * \brief Removes an application whose process has terminated
+	 *
+	 * The cores of the application are given to the remaining applications.
+	 *
+	 * \param[in] name The name of the application
+	 */
+	void removeApplication(QString name);
+
+	/*!
+	 * \brief Returns the configuration of the arbiter
+	 *
+	 * \return A list with the options of the arbiter
+	 */
+	Configuration::configopts getConfigOpts();
+
+  signals:
+	/*!
+	 * \brief Is emitted when the process of an application which is not traced has terminated
+	 *
+	 * \param[in] pid The pid of the process
+	 */
+	void sig_ProcessTerminated(int pid);
+
+  public slots:
+	/*!
+	 * \brief Starts measuring and rebalancing the applications
+	 */
+	void slot_autopinReady();
+
+  private slots:
+	/*!
+	 * \brief Measures the applications and moves a core between them
+	 *
+	 * The termination of traced processes is reported by the os services, all other
+	 * processes are checked here.
+	 */
+	void slot_rebalance();
+
+  private:
+	/*!
+	 * \brief Stores the state of an application
+	 */
+	struct application {
+		//! The name of the application
+		QString name;
+		//! The configuration of the application
+		Configuration *config;
+		//! The os services which restrict the application to its share
+		SharedOSServices *share;
+		//! The observed process of the application
+		ObservedProcess *proc;
+		//! The performance monitor used for measuring the application
+		PerformanceMonitor *monitor;
+		//! The weight of the application in the objective
+		double weight;
+		//! The minimal number of cores of the application
+		int min_cores;
+		//! The reference performance of the application, 0 if the best performance is used
+		double reference;
+		//! The best performance measured so far
+		double best;
+		//! The performance in the last interval
+		double performance;
+		//! The indices of the cores of the application
+		QList<int> cores;
+		//! The tasks measured in the current interval
+		ProcessTree::autopin_tid_list tasks;
+		//! Whether the process of the application is still running
+		bool active;
+	};
+
+	/*!
+	 * \brief Available objectives
+	 */
+	enum objective_type { THROUGHPUT, SLOWDOWN, NONE };
+
+	/*!
+	 * \brief Returns the application with the given name
+	 *
+	 * \param[in] name The name of the application
+	 *
+	 * \return A pointer to the application or nullptr if there is no such application
+	 */
+	application *findApplication(const QString &name);
+
+	/*!
+	 * \brief Assigns the cores of an application to its share
+	 *
+	 * \param[in] app The application
+	 */
+	void applyShare(application &app);
+
+	/*!
+	 * \brief Starts measuring the tasks of all active applications
+	 */
+	void startMeasurement();
+
+	/*!
+	 * \brief Stops measuring and updates the performance of all active applications
+	 */
+	void stopMeasurement();
+
+	/*!
+	 * \brief Computes the objective for some performance values
+	 *
+	 * \param[in] performance The performance of every application, in the order of the applications
+	 *
+	 * \return The value of the objective, greater values are better
+	 */
+	double evaluate(const QList<double> &performance);
+
+	/*!
+	 * \brief Moves the last core of an application to another application
+	 *
+	 * \param[in] from The index of the application which gives away the core
+	 * \param[in] to   The index of the application which receives the core
+	 */
+	void moveCore(int from, int to);
+
+	/*!
+	 * \brief Returns a string representation of the shares of all applications
+	 *
+	 * \return The names and the numbers of cores of the active applications
+	 */
+	QString sharesString();
+
+	/*!
+	 * \brief Pointer to the global configuration
+	 */
+	Configuration *config;
+
+	/*!
+	 * \brief Pointer to the os services of the system
+	 */
+	OSServices *service;
+
+	/*!
+	 * \brief The runtime context
+	 */
+	AutopinContext context;
+
+	/*!
+	 * \brief The observed applications
+	 */
+	QList<application> applications;
+
+	/*!
+	 * \brief The cpus of every physical core, sorted by socket and core
+	 */
+	QList<QList<int>> cores;
+
+	/*!
+	 * \brief The objective which is optimized
+	 */
+	objective_type objective = THROUGHPUT;
+
+	/*!
+	 * \brief The interval between two rebalancing steps in seconds
+	 */
+	int interval = 10;
+
+	/*!
+	 * \brief The minimal relative improvement of the objective for keeping a move
+	 */
+	double threshold = 0.02;
+
+	/*!
+	 * \brief The timer for the rebalancing steps
+	 */
+	QTimer timer;
+
+	/*!
+	 * \brief The start of the current measurement
+	 */
+	Clock measure_start;
+
+	/*!
+	 * \brief The move which is currently evaluated as a pair of application indices, (-1, -1) if there is none
+	 */
+	std::pair<int, int> pending_move = std::make_pair(-1, -1);
+
+	/*!
+	 * \brief The performance of all applications before the pending move
+	 */
+	QList<double> pending_performance;
+
+	/*!
+	 * \brief The moves which didn't improve the objective since the last successful move
+	 */
+	std::set<std::pair<int, int>> rejected_moves;
+};
+
+} // namespace AutopinPlus
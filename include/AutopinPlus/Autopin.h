@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <AutopinPlus/Arbiter.h>
 #include <AutopinPlus/AutopinContext.h>
 #include <AutopinPlus/ControlStrategy.h>
 #include <AutopinPlus/DataLogger.h>
@@ -96,14 +97,56 @@ signals:
 	 */
 	void sig_autopinReady();
 
-  private:
+  private slots:
+	/*!
+	 * \brief Dispatches terminated tasks to the observed applications
+	 *
+	 * This is only used if several applications are observed. If the process of an
+	 * application terminates, its control strategy is stopped and its cores are
+	 * given to the other applications. autopin+ exits when all applications have
+	 * terminated.
+	 *
+	 * \param[in] tid	The tid of the terminated task
+	 */
+	void slot_TaskTerminated(int tid);
+
+  protected:
+	/*!
+	 * \brief Stores all components belonging to one observed application
+	 */
+	struct application {
+		//! The name of the application, empty if only one application is observed
+		QString name;
+		//! The configuration of the application
+		Configuration *config;
+		//! The os services used by the application
+		OSServices *service;
+		//! The observed process
+		ObservedProcess *proc;
+		//! The performance monitors
+		PerformanceMonitor::monitor_list monitors;
+		//! The control strategy
+		ControlStrategy *strategy;
+		//! The data loggers
+		QList<DataLogger *> loggers;
+		//! The pinning history
+		PinningHistory *history;
+	};
+
+	/*!
+	 * \brief Creates and initializes all components of an application
+	 *
+	 * \param[in] app	The application, its name, configuration and os services have to be set
+	 */
+	void createApplication(application &app);
+
 	/*!
 	 * \brief Factory function for the os services
 	 *
 	 * Creates the os services.
 	 *
 	 */
-	void createOSServices();
+	virtual void createOSServices();
 
 	/*!
 	 * \brief Factory function for performance monitors
@@ -111,8 +154,20 @@ signals:
 	 * Reads the configuration and creates all requested
 	 * performance monitors.
 	 *
+	 * \param[in]	config	The configuration of the application
+	 * \param[out] monitors	The list to which the monitors are added
+	 */
+	void createPerformanceMonitors(Configuration *config, PerformanceMonitor::monitor_list &monitors);
+
+	/*!
+	 * \brief Factory function for a single performance monitor
+	 *
+	 * \param[in]	config	The configuration of the application
+	 * \param[in]	id	The identifier of the monitor in the configuration
+	 * \param[out] monitors	The list to which the monitor is added
 	 */
-	void createPerformanceMonitors();
+	virtual void createPerformanceMonitor(Configuration *config, QString id,
+										  PerformanceMonitor::monitor_list &monitors);
 
 	/*!
 	 * \brief Factory function for the pinning history
@@ -123,33 +178,42 @@ signals:
 	 *
 	 * - .xml: XMLPinningHistory
 	 *
+	 * \param[in,out] app	The application
 	 */
-	void createPinningHistory();
+	void createPinningHistory(application &app);
 
 	/*!
 	 * \brief Provide environment options for the pinning history
+	 *
+	 * \param[in] app	The application
 	 */
-	void setPinningHistoryEnv();
+	void setPinningHistoryEnv(const application &app);
 
 	/*!
 	 * \brief Factory function for the control strategy
 	 *
 	 * Reads the configuration and creates the requested
 	 * control strategy.
+	 *
+	 * \param[in,out] app	The application
 	 */
-	void createControlStrategy();
+	void createControlStrategy(application &app);
 
 	/*!
 	 * \brief Factory function for data loggers
 	 *
 	 * Reads the configuration and creates all requested data loggers.
+	 *
+	 * \param[in,out] app	The application
 	 */
-	void createDataLoggers();
+	void createDataLoggers(application &app);
 
 	/*!
-	 * \brief Creates all global connections between Qt signals and slots
+	 * \brief Creates all connections between Qt signals and slots of an application
+	 *
+	 * \param[in] app	The application
 	 */
-	void createComponentConnections();
+	void createComponentConnections(const application &app);
 
 	/*!
 	 * Stores a pointer to an instance of the class OutputChannel.
@@ -177,29 +241,19 @@ signals:
 	OSServices *service;
 
 	/*!
-	 * Stores a pointer to an instance of the class ObservedProcess.
-	 */
-	ObservedProcess *proc;
-
-	/*!
-	 * Stores a list of pointers to performance monitors.
-	 */
-	PerformanceMonitor::monitor_list monitors;
-
-	/*!
-	 * Stores a pointer to an instance of a subclass of ControlStrategy.
+	 * Stores the components of all observed applications.
 	 */
-	ControlStrategy *strategy;
+	QList<application> applications;
 
 	/*!
-	 * Stores a list of pointers to data loggers.
+	 * Stores a pointer to the arbiter if several applications are observed.
 	 */
-	QList<DataLogger *> loggers;
+	Arbiter *arbiter;
 
 	/*!
-	 * Stores a pointer to an instance of a subclass of PinningHistory
+	 * Stores the performance monitors used by the arbiter.
 	 */
-	PinningHistory *history;
+	PerformanceMonitor::monitor_list arbiter_monitors;
 };
 
 } // namespace AutopinPlus
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional> // for function
+#include <qglobal.h>  // for qint64
+
+namespace AutopinPlus {
+
+/*!
+ * \brief Measures elapsed time in milliseconds.
+ *
+ * This class is used like QElapsedTimer. All instances read the same time source, which is a monotonic clock unless
+ * another source has been set with setSource(). The simulator uses this to run control strategies in virtual time.
+ */
+class Clock {
+  public:
+	/*!
+	 * \brief Function returning the current time in milliseconds.
+	 */
+	typedef std::function<qint64()> time_source;
+
+	/*!
+	 * \brief Returns the current time.
+	 *
+	 * \return The current time in milliseconds, only differences between two calls are meaningful.
+	 */
+	static qint64 now();
+
+	/*!
+	 * \brief Replaces the time source.
+	 *
+	 * \param[in] source The new time source, an empty function restores the monotonic clock
+	 */
+	static void setSource(time_source source);
+
+	/*!
+	 * \brief Starts the measurement.
+	 */
+	void start();
+
+	/*!
+	 * \brief Marks the measurement as invalid.
+	 */
+	void invalidate();
+
+	/*!
+	 * \brief Returns whether the measurement has been started.
+	 *
+	 * \return false if start() hasn't been called since the last call of invalidate().
+	 */
+	bool isValid() const;
+
+	/*!
+	 * \brief Returns the time since the last call of start().
+	 *
+	 * \return The elapsed time in milliseconds.
+	 */
+	qint64 elapsed() const;
+
+  private:
+	/*!
+	 * \brief The time of the last call of start(), -1 if the measurement is invalid.
+	 */
+	qint64 start_time = -1;
+
+	/*!
+	 * \brief The time source, the monotonic clock is used if it is empty.
+	 */
+	static time_source source;
+};
+
+} // namespace AutopinPlus
@@ -35,9 +35,14 @@
 #include <AutopinPlus/OSServices.h>
 #include <AutopinPlus/PerformanceMonitor.h>
 #include <AutopinPlus/PinningHistory.h>
+#include <AutopinPlus/PinningSpace.h>
 #include <deque>
+#include <functional>
 #include <map>
 #include <QObject>
+#include <QRegExp>
+#include <QStringList>
+#include <set>
 
 namespace AutopinPlus {
 
@@ -133,14 +138,186 @@ class ControlStrategy : public QObject {
 	 */
 	typedef std::map<int, int> sortmap;
 
+	/*!
+	 * \brief Function returning the value of an option of the control strategy
+	 *
+	 * The argument is the name of the option without the prefix of the strategy.
+	 * If the option does not exist the list is empty.
+	 */
+	typedef std::function<QStringList(const QString &)> option_reader;
+
+	/*!
+	 * \brief Rule which assigns a role to the tasks matching all of its criteria
+	 */
+	struct role_rule {
+		//! The role assigned by the rule
+		QString role;
+		//! Regular expression for the name of the task
+		QRegExp comm;
+		//! Regular expression for the name of the process the task belongs to
+		QRegExp process;
+		//! Minimum cpu share of the task
+		double min_share;
+		//! Maximum cpu share of the task
+		double max_share;
+	};
+
 	/*!
 	 * \brief Reads pinnings from the configuration
 	 *
+	 * Besides explicit pinnings of the form <cpus_a>:<cpus_b>:... the option may contain
+	 * entries of the form auto:<threads> which are replaced by the pinnings returned by
+	 * generatePinnings() and entries of the form model:<threads> which are replaced by the
+	 * pinnings returned by predictPinnings(). Every task of an explicit pinning is assigned
+	 * to a set of cores as accepted by readCpuSet().
+	 *
 	 * \param[in] opt Name of the configuration option where
 	 * 	the pinnings are stored.
+	 * \param[in] type Whether bigger or smaller results of the strategy are better, this is
+	 * 	only used for predicting pinnings
 	 * \return A list of pinnings
 	 */
-	PinningHistory::pinning_list readPinnings(QString opt);
+	PinningHistory::pinning_list readPinnings(QString opt, PerformanceMonitor::montype type);
+
+	/*!
+	 * \brief Reads the set of cores of a single task in a pinning
+	 *
+	 * The set is either a list of cores and ranges (e. g. 0-3,8) or one of the names
+	 * socket<n>, node<n> and llc<n>, which stand for all cores of the socket with the
+	 * id n, of the NUMA node n or of the n-th last level cache (counted from 0 in the
+	 * order of the lowest core sharing the cache). Cores which are not part of the
+	 * topology of the system are rejected.
+	 *
+	 * \param[in] entry The set of cores as a string
+	 * \return The set of cores. If the entry is not valid the set will be empty.
+	 */
+	PinningHistory::autopin_cpuset readCpuSet(QString entry);
+
+	/*!
+	 * \brief Generates pinnings from the hardware topology of the system
+	 *
+	 * The following placements are generated for the given number of threads:
+	 * compact (one thread per core, cores as close as possible), smt (all hardware
+	 * threads of a core are used before the next core), scatter (round robin over the
+	 * sockets), llc (round robin over the last level caches) and numa (round robin over
+	 * the NUMA nodes). Placements which result in the same pinning are only returned once.
+	 *
+	 * \param[in] threads The number of threads in each pinning
+	 * \return A list of pinnings
+	 */
+	PinningHistory::pinning_list generatePinnings(int threads);
+
+	/*!
+	 * \brief Predicts good pinnings from the results stored in the pinning history
+	 *
+	 * A PerformanceModel is trained on all results of the pinning history and used to rank
+	 * the placements of generatePinnings() and <name>.model_candidates random pinnings. The
+	 * <name>.model_seeds pinnings with the best predicted performance are returned. The
+	 * penalty of the model is read from <name>.model_regularization. If the history doesn't
+	 * contain any results, no pinnings are returned.
+	 *
+	 * \param[in] threads The number of threads in each pinning
+	 * \param[in] type Whether bigger or smaller results in the pinning history are better,
+	 * 	i. e. the objective of the strategy which has stored them
+	 * \return A list of pinnings, ordered from the best predicted performance
+	 */
+	PinningHistory::pinning_list predictPinnings(int threads, PerformanceMonitor::montype type);
+
+	/*!
+	 * \brief Reads the space of pinnings searched by the control strategy from the configuration
+	 *
+	 * The processors are read from the option <name>.cpus and default to all processors
+	 * used in the given pinnings or, if there are none, to all processors of the system.
+	 * The number of threads is read from the option <name>.threads and defaults to the
+	 * size of the biggest of the given pinnings.
+	 *
+	 * \param[in] pinnings Pinnings used for determining the default values
+	 * \return The configured pinning space
+	 */
+	PinningSpace readPinningSpace(const PinningHistory::pinning_list &pinnings);
+
+	/*!
+	 * \brief Reads the rules which assign roles to tasks
+	 *
+	 * The option roles lists the roles in the order in which their rules are checked.
+	 * The rule of a role consists of the options role.<role>.comm and role.<role>.process
+	 * (regular expressions for the name of the task and of its process) as well as
+	 * role.<role>.min_share and role.<role>.max_share (bounds for the fraction of its
+	 * lifetime the task has been running). Tasks matching none of the rules have the
+	 * role "default". The option pin_roles lists the roles whose tasks are pinned and
+	 * defaults to all roles except "ignore" followed by "default". The option role_delay
+	 * is the time in milliseconds a new task runs before it is classified.
+	 *
+	 * \param[in] option Function for reading the options
+	 */
+	void readRoles(const option_reader &option);
+
+	/*!
+	 * \brief Returns the options read by readRoles()
+	 *
+	 * \return A list with the configuration options
+	 */
+	Configuration::configopts getRoleOpts();
+
+	/*!
+	 * \brief Determines the role of a task
+	 *
+	 * \param[in] tid The tid of the task
+	 * \return The role of the first matching rule or "default"
+	 */
+	QString getTaskRole(int tid);
+
+	/*!
+	 * \brief Determines if a task is pinned
+	 *
+	 * \param[in] tid	The tid of the task
+	 * \param[in] index	The position of the task in tasks
+	 * \param[in] ignored	Positions of tasks which are never pinned
+	 * \param[out] role	The role of the task
+	 * \return True if the task has one of the roles in pin_roles
+	 */
+	bool selectTask(int tid, int index, const std::set<int> &ignored, QString &role);
+
+	/*!
+	 * \brief Returns the tasks which are pinned in the order they are assigned to a pinning
+	 *
+	 * The tasks are grouped by their roles in the order of pin_roles. Within a role
+	 * the order of tasks is kept.
+	 *
+	 * \param[in] ignored Positions of tasks in tasks which are never pinned
+	 * \param[out] roles The roles of the selected tasks
+	 * \return The selected tasks
+	 */
+	autopin_tasklist selectTasks(const std::set<int> &ignored, QStringList &roles);
+
+	/*!
+	 * \brief Selects the entry of the applied pinning for a task created after the pinning was applied
+	 *
+	 * The entries of a pinning belong to the roles of the tasks they were assigned to
+	 * (see entry_roles). A free entry of the role of the task is preferred, otherwise
+	 * the first free entry which does not belong to any role is taken and assigned to
+	 * the role.
+	 *
+	 * \param[in] role	The role of the task
+	 * \param[in] used	The entries which are in use
+	 * \return The index of the entry or -1 if there is no free entry
+	 */
+	int selectEntry(const QString &role, const std::set<int> &used);
+
+	/*!
+	 * \brief Returns an identity of a task which is stable across runs
+	 *
+	 * The identity has the form <creator>/<name>#<n>. <creator> is the identity of the
+	 * task which has created the task or, if it is not known, of the main task of the
+	 * process. <name> is the name of the task and <n> the smallest number which is not
+	 * used by another running task with the same creator and name. Tasks without a
+	 * creator have the identity <name>#<n>. The characters %, /, # and : are escaped
+	 * in names. The identity of a task does not change while the task is running.
+	 *
+	 * \param[in] tid The tid of the task
+	 * \return The identity of the task
+	 */
+	QString getTaskId(int tid);
 
 	/*!
 	 * \brief Adds a pinning to the pinning history
@@ -182,7 +359,8 @@ class ControlStrategy : public QObject {
 	 * \brief Get running tasks
 	 *
 	 * Refreshes the current tasks of the observed process and stores
-	 * them in tasks sorted by tid.
+	 * them in tasks sorted by tid. New tasks are assigned an identity
+	 * (see getTaskId()) in this order.
 	 */
 	void refreshTasks();
 
@@ -191,6 +369,37 @@ class ControlStrategy : public QObject {
 	 */
 	QString name;
 
+	/*!
+	 * Identities of the running tasks
+	 */
+	std::map<int, QString> task_ids;
+
+	/*!
+	 * Rules for assigning roles to tasks in the order in which they are checked
+	 */
+	std::deque<role_rule> role_rules;
+
+	/*!
+	 * Roles whose tasks are pinned
+	 */
+	QStringList pin_roles;
+
+	/*!
+	 * Options read by readRoles()
+	 */
+	Configuration::configopts role_opts;
+
+	/*!
+	 * Time in milliseconds a new task runs before it is classified, so that it has
+	 * set its name and its cpu share is meaningful
+	 */
+	int role_delay;
+
+	/*!
+	 * Roles of the entries of the applied pinning, empty for entries which don't belong to a role
+	 */
+	QStringList entry_roles;
+
 	/*!
 	 * \brief Data structure for sorting tasks
 	 *
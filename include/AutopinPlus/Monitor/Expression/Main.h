@@ -0,0 +1,189 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/ProcessTree.h>		// for ProcessTree, etc
+#include <functional>						// for function
+#include <map>								// for map
+#include <qstring.h>						// for QString
+#include <vector>							// for vector
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Expression {
+
+/*!
+ * \brief A virtual performance monitor which combines the values of other monitors.
+ *
+ * The value of this monitor is computed from an arithmetic expression over the values of other monitors, e.g.
+ * "instructions / cycles". All monitors used in the expression are started and stopped together, so the expression
+ * is evaluated over the same measurement window.
+ */
+class Main : public PerformanceMonitor {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] name     Name of this monitor
+	 * \param[in] config   Pointer to the configuration
+	 * \param[in] monitors Reference to the list of all monitors, the operands are looked up in init()
+	 * \param[in] context  Pointer to the context
+	 */
+	Main(QString name, Configuration *config, const PerformanceMonitor::monitor_list &monitors,
+		 const AutopinContext &context);
+
+	// Overridden from the base class
+	void init() override;
+
+	// Overridden from the base class
+	Configuration::configopts getConfigOpts() override;
+
+	// Overridden from the base class
+	void start(int tid) override;
+
+	// Overridden from the base class
+	double value(int tid) override;
+
+	// Overridden from the base class
+	double stop(int tid) override;
+
+	// Overridden from the base class
+	void clear(int tid) override;
+
+	// Overridden from the base class
+	ProcessTree::autopin_tid_list getMonitoredTasks() override;
+
+	// Overridden from the base class
+	double getCoverage(int tid) override;
+
+	// Overridden from the base class
+	bool isProcessWide() override;
+
+	// Overridden from the base class
+	bool isCumulative() override;
+
+  private:
+	/*!
+	 * \brief A single element of the expression in reverse polish notation.
+	 *
+	 * An element is either an operator ('+', '-', '*', '/' or 'n' for negation), a constant ('c') or the value of a
+	 * monitor ('m').
+	 */
+	struct element {
+		//! The kind of the element
+		char kind;
+		//! The value of a constant
+		double constant;
+		//! The monitor whose value is used
+		PerformanceMonitor *monitor;
+	};
+
+	/*!
+	 * \brief Parses the expression into program.
+	 *
+	 * \exception Exception This exception will be thrown if the expression is invalid.
+	 */
+	void parse();
+
+	/*!
+	 * \brief Parses a sum or difference, starting at the current position.
+	 */
+	void parseSum();
+
+	/*!
+	 * \brief Parses a product or quotient, starting at the current position.
+	 */
+	void parseProduct();
+
+	/*!
+	 * \brief Parses a number, a monitor name, a negation or an expression in parentheses.
+	 */
+	void parseFactor();
+
+	/*!
+	 * \brief Returns the next token of the expression without consuming it.
+	 *
+	 * \return The token, or the empty string at the end of the expression.
+	 */
+	QString peek();
+
+	/*!
+	 * \brief Returns the next token of the expression and consumes it.
+	 *
+	 * \return The token, or the empty string at the end of the expression.
+	 */
+	QString next();
+
+	/*!
+	 * \brief Evaluates the expression.
+	 *
+	 * \param[in] read Function returning the value of a monitor.
+	 *
+	 * \return The value of the expression. Divisions by zero yield 0.
+	 */
+	double evaluate(const std::function<double(PerformanceMonitor *)> &read);
+
+	/*!
+	 * \brief The list of all monitors.
+	 */
+	const PerformanceMonitor::monitor_list &monitors;
+
+	/*!
+	 * \brief The expression as configured.
+	 */
+	QString expression;
+
+	/*!
+	 * \brief The current position while parsing the expression.
+	 */
+	int position = 0;
+
+	/*!
+	 * \brief The position after the token returned by the last call of peek().
+	 */
+	int next_position = 0;
+
+	/*!
+	 * \brief The expression in reverse polish notation.
+	 */
+	std::vector<element> program;
+
+	/*!
+	 * \brief The monitors used in the expression, each only once.
+	 */
+	std::vector<PerformanceMonitor *> operands;
+
+	/*!
+	 * \brief The tasks which are currently monitored.
+	 */
+	ProcessTree::autopin_tid_list tasks;
+
+	/*!
+	 * \brief Whether the expression grows with the length of a measurement, e.g. a sum of event counts.
+	 */
+	bool cumulative = false;
+};
+
+} // namespace Expression
+} // namespace Monitor
+} // namespace AutopinPlus
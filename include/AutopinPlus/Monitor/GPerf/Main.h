@@ -29,6 +29,7 @@
 #include <qlist.h>							  // for QList
 #include <qmap.h>							  // for QMap
 #include <qstring.h>						  // for QString
+#include <set>								  // for set
 #include <sys/types.h>						  // for pid_t
 
 namespace AutopinPlus {
@@ -37,17 +38,24 @@ namespace GPerf {
 
 /*!
  * \brief A generic performance monitor based on the perf subsystem of the Linux kernel.
+ *
+ * Several gperf monitors can form a group: the counters of all monitors of a group are opened as one perf event
+ * group per thread and processor, which the kernel schedules together, and all of them are read with a single read()
+ * of the group leader using PERF_FORMAT_GROUP. The state of a group is kept by its leader, the other monitors forward
+ * their calls to it.
  */
 class Main : public PerformanceMonitor {
   public:
 	/*!
 	 * \brief Constructor
 	 *
-	 * \param[in] name    Name of this monitor
-	 * \param[in] config  Pointer to the configuration
-	 * \param[in] context Pointer to the context
+	 * \param[in] name     Name of this monitor
+	 * \param[in] config   Pointer to the configuration
+	 * \param[in] monitors Reference to the list of all monitors, the group leader is looked up in init()
+	 * \param[in] context  Pointer to the context
 	 */
-	Main(QString name, Configuration *config, const AutopinContext &context);
+	Main(QString name, Configuration *config, const PerformanceMonitor::monitor_list &monitors,
+		 const AutopinContext &context);
 
 	// Overridden from the base class
 	void init() override;
@@ -73,6 +81,12 @@ class Main : public PerformanceMonitor {
 	// Overridden from the base class
 	QString getUnit() override;
 
+	// Overridden from the base class
+	double getCoverage(int tid) override;
+
+	// Overridden from the base class
+	bool isProcessWide() override;
+
   private:
 	/*!
 	 * \brief Parses a string to a sensor.
@@ -113,6 +127,108 @@ class Main : public PerformanceMonitor {
 	 */
 	int perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags);
 
+	/*!
+	 * \brief The state of a group of counters for a single thread.
+	 */
+	struct group_state {
+		//! The file descriptors for every processor, the first one of each list is the group leader
+		QList<QList<int>> fds;
+		//! The values of the last read of the group, in the order of the group
+		QList<double> values;
+		//! The share of the time the group was running during the last read
+		double coverage = 1;
+		//! The monitors which haven't returned their value from the last read yet
+		std::set<Main *> unread;
+		//! The monitors which are currently monitoring the thread
+		std::set<Main *> active;
+	};
+
+	/*!
+	 * \brief Starts a monitor of the group of this leader.
+	 *
+	 * If the thread is already monitored by the group, all counters of the group are reset together.
+	 *
+	 * \param[in] monitor The monitor which is started.
+	 * \param[in] thread  The thread to be monitored.
+	 */
+	void groupStart(Main *monitor, int thread);
+
+	/*!
+	 * \brief Returns the value of a monitor of the group of this leader.
+	 *
+	 * The group is only read again if the monitor has already returned its value of the last read, so monitors
+	 * queried one after the other (e.g. by an expression) get values of the same interval.
+	 *
+	 * \param[in] monitor The monitor whose value is requested.
+	 * \param[in] thread  The monitored thread.
+	 *
+	 * \return The value of the monitor.
+	 */
+	double groupValue(Main *monitor, int thread);
+
+	/*!
+	 * \brief Stops a monitor of the group of this leader without reading its value.
+	 *
+	 * The counters are closed when the last monitor of the group has stopped monitoring the thread.
+	 *
+	 * \param[in] monitor The monitor which is stopped.
+	 * \param[in] thread  The monitored thread.
+	 */
+	void groupClear(Main *monitor, int thread);
+
+	/*!
+	 * \brief Reads all counters of the group for a thread with one read() per processor.
+	 *
+	 * \param[in,out] group The group of the thread.
+	 *
+	 * \return False if a counter could not be read.
+	 */
+	bool groupRead(group_state &group);
+
+	/*!
+	 * \brief Closes the counters of a group.
+	 *
+	 * \param[in] fds The file descriptors of the group, the leaders are closed last.
+	 */
+	void groupClose(const QList<QList<int>> &fds);
+
+	/*!
+	 * \brief Returns the processors on which counters are created.
+	 *
+	 * \return The configured processors, the processors determined by the sensor or -1 for all processors.
+	 */
+	QList<int> counterProcessors();
+
+	/*!
+	 * The list of all monitors.
+	 */
+	const PerformanceMonitor::monitor_list &monitors;
+
+	/*!
+	 * The name of the monitor leading the group of this monitor, as configured by the user.
+	 */
+	QString group;
+
+	/*!
+	 * The leader of the group of this monitor, nullptr if the monitor is not part of a group.
+	 */
+	Main *leader = nullptr;
+
+	/*!
+	 * The other monitors of the group if this monitor is the leader, in the order in which they are read.
+	 */
+	QList<Main *> members;
+
+	/*!
+	 * The state of the group for every monitored thread if this monitor is the leader.
+	 */
+	QMap<int, group_state> groups;
+
+	/*!
+	 * Stores if the counters are inherited by the tasks created by a monitored task.
+	 */
+	bool inherit = false;
+
 	/*!
 	 * The list of processors to monitor, as configured by the user.
 	 */
@@ -127,6 +243,12 @@ class Main : public PerformanceMonitor {
 	 * A mapping from a specific thread to a list of associated file descriptors.
 	 */
 	QMap<int, QList<int>> threads;
+
+	/*!
+	 * The share of the time the counters of a thread were running at the last read. The entries are kept after a
+	 * thread is stopped, so the coverage of the final value can still be queried.
+	 */
+	QMap<int, double> coverage;
 }; // class Main
 
 } // namespace GPerf
@@ -0,0 +1,265 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor
+#include <AutopinPlus/ProcessTree.h>		// for ProcessTree, etc
+#include <linux/perf_event.h>				// for perf_event_attr
+#include <map>								// for map
+#include <qmap.h>							// for QMap
+#include <qmutex.h>							// for QMutex
+#include <qstring.h>						// for QString
+#include <qthread.h>						// for QThread
+#include <stdint.h>							// for uint64_t
+#include <sys/types.h>						// for pid_t
+#include <utility>							// for pair
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace MemShare {
+
+/*!
+ * \brief A performance monitor which samples memory accesses to find out which threads share data.
+ *
+ * Every monitored thread gets a sampling perf event (e.g. the load latency event of Intel processors) which records
+ * the data address and the data source of the sampled accesses into a ring buffer. A background thread drains the ring
+ * buffers, so they don't overflow during long measurements. From these samples the monitor determines which threads
+ * access the same cache lines and which of these accesses were served by a modified line in another core's cache
+ * (HITM), which indicates true or false sharing.
+ *
+ * The value of a thread is the number of its sampled accesses to cache lines which were also accessed by other
+ * threads. The main purpose of this monitor is however to provide the affinity graph to the cluster control strategy.
+ */
+class Main : public PerformanceMonitor {
+  public:
+	/*!
+	 * \brief Data type for storing the affinity between pairs of threads.
+	 *
+	 * The key is a pair of thread ids with the smaller id first, the value is the weight of the edge.
+	 */
+	typedef std::map<std::pair<int, int>, double> affinity_graph;
+
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] name    Name of this monitor
+	 * \param[in] config  Pointer to the configuration
+	 * \param[in] context Pointer to the context
+	 */
+	Main(QString name, Configuration *config, const AutopinContext &context);
+
+	virtual ~Main();
+
+	// Overridden from the base class
+	void init() override;
+
+	// Overridden from the base class
+	Configuration::configopts getConfigOpts() override;
+
+	// Overridden from the base class
+	void start(int tid) override;
+
+	// Overridden from the base class
+	double value(int tid) override;
+
+	// Overridden from the base class
+	double stop(int tid) override;
+
+	// Overridden from the base class
+	void clear(int tid) override;
+
+	// Overridden from the base class
+	ProcessTree::autopin_tid_list getMonitoredTasks() override;
+
+	// Overridden from the base class
+	QString getUnit() override;
+
+	/*!
+	 * \brief Returns the affinity graph of all threads sampled since the monitor was started.
+	 *
+	 * Two threads are connected if they accessed the same cache lines. For every shared cache line, the smaller of
+	 * the two sample counts is added to the weight of the edge. Accesses which hit a modified line in another cache are
+	 * additionally weighted with the configured "hitm_weight".
+	 *
+	 * \return The affinity graph.
+	 */
+	affinity_graph getAffinityGraph();
+
+  private:
+	/*!
+	 * \brief The background thread which drains the ring buffers.
+	 */
+	class Reader : public QThread {
+	  public:
+		/*!
+		 * \brief Constructor
+		 *
+		 * \param[in] monitor The monitor whose ring buffers are drained
+		 */
+		explicit Reader(Main &monitor);
+
+		/*!
+		 * \brief Stops the thread
+		 *
+		 * This function blocks until the thread has exited.
+		 */
+		void deinit();
+
+	  protected:
+		// Overridden from the base class
+		void run() override;
+
+	  private:
+		//! The monitor whose ring buffers are drained
+		Main &monitor;
+
+		//! Set to request the thread to exit
+		volatile bool exreq = false;
+	};
+
+	/*!
+	 * \brief The perf event and the ring buffer of a single thread.
+	 */
+	struct sampler {
+		//! The file descriptor of the perf event
+		int fd;
+		//! The start address of the mapped ring buffer
+		void *buffer;
+	};
+
+	/*!
+	 * \brief Sample counts of a single thread for a single cache line.
+	 */
+	struct line_samples {
+		//! The number of sampled accesses
+		int accesses = 0;
+		//! The number of sampled accesses which hit a modified line in another cache
+		int hitm = 0;
+	};
+
+	/*!
+	 * \brief Reads all new samples from the ring buffer of a thread.
+	 *
+	 * The caller has to hold the mutex.
+	 *
+	 * \param[in] tid The thread
+	 */
+	void drain(int tid);
+
+	/*!
+	 * \brief Reads all new samples from the ring buffers of all threads.
+	 *
+	 * The caller has to hold the mutex.
+	 */
+	void drainAll();
+
+	/*!
+	 * \brief Unmaps the ring buffer of a thread and closes its perf event.
+	 *
+	 * The caller has to hold the mutex.
+	 *
+	 * \param[in] tid The thread
+	 */
+	void closeSampler(int tid);
+
+	/*!
+	 * \brief Halves all sample counts until at most half of max_lines cache lines have samples left.
+	 */
+	void age();
+
+	/*!
+	 * \brief A wrapper around the "perf_event_open()" syscall.
+	 *
+	 * \param[in] attr     The "perf_event_attr" describing the desired event.
+	 * \param[in] pid      The thread to be monitored.
+	 * \param[in] cpu      The CPU to be monitored. Pass -1 to monitor all CPUs.
+	 * \param[in] group_fd The group leader, or -1 to create a new group.
+	 * \param[in] flags    Additional flags for the syscall.
+	 *
+	 * \return The opened file descriptor or -1 if there was an error (in which case errno will be set appropriatly).
+	 */
+	int perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags);
+
+	/*!
+	 * The perf event used for sampling.
+	 */
+	perf_event_attr attr;
+
+	/*!
+	 * The number of data pages of each ring buffer, a power of two.
+	 */
+	int pages = 64;
+
+	/*!
+	 * The size of a memory page in bytes.
+	 */
+	long page_size = 4096;
+
+	/*!
+	 * The size of a cache line in bytes, a power of two.
+	 */
+	int line_size = 64;
+
+	/*!
+	 * The interval in milliseconds in which the reader drains the ring buffers.
+	 */
+	int interval = 100;
+
+	/*!
+	 * The additional weight of accesses which hit a modified line in another cache.
+	 */
+	double hitm_weight = 4;
+
+	/*!
+	 * The maximum number of cache lines for which samples are kept.
+	 */
+	int max_lines = 1 << 20;
+
+	/*!
+	 * The samplers of all monitored threads.
+	 */
+	QMap<int, sampler> samplers;
+
+	/*!
+	 * The sample counts of all threads, indexed by cache line and thread.
+	 */
+	std::map<uint64_t, std::map<int, line_samples>> lines;
+
+	/*!
+	 * The number of samples of the current measurement the kernel has dropped because a ring buffer was full.
+	 */
+	uint64_t lost = 0;
+
+	/*!
+	 * Mutex for accessing the ring buffers and the samples, which are shared with the reader.
+	 */
+	QMutex mutex;
+
+	/*!
+	 * The background thread which drains the ring buffers.
+	 */
+	Reader reader;
+}; // class Main
+
+} // namespace MemShare
+} // namespace Monitor
+} // namespace AutopinPlus
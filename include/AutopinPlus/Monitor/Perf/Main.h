@@ -60,6 +60,8 @@ class Main : public PerformanceMonitor {
 	void clear(int tid) override;
 	ProcessTree::autopin_tid_list getMonitoredTasks() override;
 	Configuration::configopts getConfigOpts() override;
+	double getCoverage(int tid) override;
+	bool isProcessWide() override;
 
   private:
 	/*!
@@ -72,6 +74,11 @@ class Main : public PerformanceMonitor {
 	 */
 	descriptor_map perfds;
 
+	/*!
+	 * \brief Stores the share of the time the counter of a task was running at the last read
+	 */
+	std::map<int, double> coverage;
+
 	/*!
 	 * \brief Creates a new performance counter
 	 *
@@ -108,6 +115,11 @@ class Main : public PerformanceMonitor {
 	 * Stores the event to be measured by perf
 	 */
 	perf_hw_id event_type;
+
+	/*!
+	 * Stores if the counters are inherited by the tasks created by a monitored task
+	 */
+	bool inherit;
 };
 
 } // namespace Perf
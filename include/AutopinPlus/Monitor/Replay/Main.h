@@ -0,0 +1,105 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>						 // for AutopinContext
+#include <AutopinPlus/Configuration.h>						 // for Configuration, etc
+#include <AutopinPlus/OS/Simulator/OSServicesSimulator.h> // for OSServicesSimulator
+#include <AutopinPlus/PerformanceMonitor.h>					 // for PerformanceMonitor, etc
+#include <AutopinPlus/ProcessTree.h>						 // for ProcessTree, etc
+#include <map>												 // for map
+#include <qstring.h>										 // for QString
+#include <random>											 // for mt19937, normal_distribution
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Replay {
+
+/*!
+ * \brief A performance monitor which measures the work done by a simulated process.
+ *
+ * The work of a thread grows with the performance the trace recorded for the current pinning, so the value of
+ * this monitor is proportional to the recorded value of the pinning in effect during the measurement. Optionally,
+ * gaussian noise is added to the values to test how robust a strategy is against measurement jitter.
+ */
+class Main : public PerformanceMonitor {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] name    Name of this monitor
+	 * \param[in] config  Pointer to the configuration
+	 * \param[in] service Pointer to the simulated os services
+	 * \param[in] context Pointer to the context
+	 */
+	Main(QString name, Configuration *config, OS::Simulator::OSServicesSimulator *service,
+		 const AutopinContext &context);
+
+	// Overridden from the base class
+	void init() override;
+
+	// Overridden from the base class
+	Configuration::configopts getConfigOpts() override;
+
+	// Overridden from the base class
+	void start(int tid) override;
+
+	// Overridden from the base class
+	double value(int tid) override;
+
+	// Overridden from the base class
+	double stop(int tid) override;
+
+	// Overridden from the base class
+	void clear(int tid) override;
+
+	// Overridden from the base class
+	ProcessTree::autopin_tid_list getMonitoredTasks() override;
+
+  private:
+	/*!
+	 * \brief The simulated os services
+	 */
+	OS::Simulator::OSServicesSimulator *service;
+
+	/*!
+	 * \brief Standard deviation of the noise relative to the value
+	 */
+	double noise = 0;
+
+	/*!
+	 * \brief Seed of the noise, fixed so simulations can be repeated
+	 */
+	int seed = 0;
+
+	/*!
+	 * \brief Random number generator for the noise
+	 */
+	std::mt19937 generator;
+
+	/*!
+	 * \brief The work of the monitored threads at the start of the measurement
+	 */
+	std::map<int, double> base;
+};
+
+} // namespace Replay
+} // namespace Monitor
+} // namespace AutopinPlus
@@ -0,0 +1,303 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor
+#include <AutopinPlus/ProcessTree.h>		// for ProcessTree, etc
+#include <deque>							// for deque
+#include <linux/perf_event.h>				// for perf_event_attr
+#include <map>								// for map
+#include <qlist.h>							// for QList
+#include <qmutex.h>							// for QMutex
+#include <qstring.h>						// for QString
+#include <qthread.h>						// for QThread
+#include <stdint.h>							// for uint64_t
+#include <sys/types.h>						// for pid_t
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Sampling {
+
+/*!
+ * \brief A performance monitor which samples an event on every processor instead of counting it per thread.
+ *
+ * The monitor opens one sampling perf event with a ring buffer per processor, which records the instruction pointer,
+ * the thread, the time and the processor of every sample. A background thread drains the ring buffers, so they don't
+ * overflow between two reads, and keeps the samples of all monitored threads. This needs a constant number of file
+ * descriptors regardless of the number of threads, and provides a time series within every measurement (e.g. for
+ * phase detection or load balancing) instead of a single value.
+ *
+ * The value of a thread is the number of events estimated from its samples, i.e. the number of samples multiplied by
+ * the sample period. As the events are sampled on all processors, this requires the permission to monitor the whole
+ * system (see /proc/sys/kernel/perf_event_paranoid).
+ */
+class Main : public PerformanceMonitor {
+  public:
+	/*!
+	 * \brief A single sample of a thread.
+	 */
+	struct sample {
+		//! The time of the sample in nanoseconds (CLOCK_MONOTONIC)
+		uint64_t time;
+		//! The instruction pointer of the thread
+		uint64_t ip;
+		//! The processor the thread was running on
+		int cpu;
+	};
+
+	/*!
+	 * \brief Data type for storing the samples of a thread in chronological order.
+	 */
+	typedef std::deque<sample> sample_list;
+
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] name    Name of this monitor
+	 * \param[in] config  Pointer to the configuration
+	 * \param[in] context Pointer to the context
+	 */
+	Main(QString name, Configuration *config, const AutopinContext &context);
+
+	virtual ~Main();
+
+	// Overridden from the base class
+	void init() override;
+
+	// Overridden from the base class
+	Configuration::configopts getConfigOpts() override;
+
+	// Overridden from the base class
+	void start(int tid) override;
+
+	// Overridden from the base class
+	double value(int tid) override;
+
+	// Overridden from the base class
+	double stop(int tid) override;
+
+	// Overridden from the base class
+	void clear(int tid) override;
+
+	// Overridden from the base class
+	ProcessTree::autopin_tid_list getMonitoredTasks() override;
+
+	/*!
+	 * \brief Returns the samples of a thread since it was started.
+	 *
+	 * Only the latest samples are kept, see the "max_samples" option. The samples of a stopped thread remain available
+	 * until the next measurement is started.
+	 *
+	 * \param[in] tid The thread
+	 *
+	 * \return The samples in chronological order.
+	 */
+	sample_list getSamples(int tid);
+
+	/*!
+	 * \brief Returns the sample rate of a thread since it was started.
+	 *
+	 * \param[in] tid The thread
+	 *
+	 * \return The number of samples per second, or 0 if the thread has not been monitored.
+	 */
+	double getRate(int tid);
+
+  private:
+	/*!
+	 * \brief The background thread which drains the ring buffers.
+	 */
+	class Reader : public QThread {
+	  public:
+		/*!
+		 * \brief Constructor
+		 *
+		 * \param[in] monitor The monitor whose ring buffers are drained
+		 */
+		explicit Reader(Main &monitor);
+
+		/*!
+		 * \brief Stops the thread
+		 *
+		 * This function blocks until the thread has exited.
+		 */
+		void deinit();
+
+	  protected:
+		// Overridden from the base class
+		void run() override;
+
+	  private:
+		//! The monitor whose ring buffers are drained
+		Main &monitor;
+
+		//! Set to request the thread to exit
+		volatile bool exreq = false;
+	};
+
+	/*!
+	 * \brief The perf event and the ring buffer of a single processor.
+	 */
+	struct sampler {
+		//! The file descriptor of the perf event
+		int fd;
+		//! The start address of the mapped ring buffer
+		void *buffer;
+	};
+
+	/*!
+	 * \brief The samples of a single thread.
+	 */
+	struct thread_samples {
+		//! The time the thread was started in nanoseconds (CLOCK_MONOTONIC)
+		uint64_t start = 0;
+		//! The time the thread was stopped, 0 while it is monitored
+		uint64_t stop = 0;
+		//! The number of samples since the thread was started
+		uint64_t count = 0;
+		//! The latest samples of the thread
+		sample_list samples;
+	};
+
+	/*!
+	 * \brief Opens the sampling events of all processors and starts the reader.
+	 *
+	 * \return False if an event could not be opened.
+	 */
+	bool openSamplers();
+
+	/*!
+	 * \brief Stops the reader and closes the sampling events of all processors.
+	 */
+	void closeSamplers();
+
+	/*!
+	 * \brief Enables or disables the sampling events of all processors.
+	 *
+	 * \param[in] request PERF_EVENT_IOC_ENABLE or PERF_EVENT_IOC_DISABLE
+	 *
+	 * \return False if the request failed for any processor.
+	 */
+	bool controlSamplers(unsigned long request);
+
+	/*!
+	 * \brief Returns whether any thread is currently being monitored.
+	 *
+	 * \return True if at least one thread hasn't been stopped yet.
+	 */
+	bool active();
+
+	/*!
+	 * \brief Reads all new samples from the ring buffers of all processors.
+	 *
+	 * The caller has to hold the mutex.
+	 */
+	void drainAll();
+
+	/*!
+	 * \brief Reads all new samples from the ring buffer of a processor.
+	 *
+	 * The caller has to hold the mutex.
+	 *
+	 * \param[in] s The sampler of the processor
+	 */
+	void drain(const sampler &s);
+
+	/*!
+	 * \brief Returns the current time.
+	 *
+	 * \return The time in nanoseconds (CLOCK_MONOTONIC), the clock used for the samples.
+	 */
+	static uint64_t now();
+
+	/*!
+	 * \brief A wrapper around the "perf_event_open()" syscall.
+	 *
+	 * \param[in] attr     The "perf_event_attr" describing the desired event.
+	 * \param[in] pid      The thread to be monitored. Pass -1 to monitor all threads.
+	 * \param[in] cpu      The CPU to be monitored.
+	 * \param[in] group_fd The group leader, or -1 to create a new group.
+	 * \param[in] flags    Additional flags for the syscall.
+	 *
+	 * \return The opened file descriptor or -1 if there was an error (in which case errno will be set appropriatly).
+	 */
+	int perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags);
+
+	/*!
+	 * The perf event used for sampling.
+	 */
+	perf_event_attr attr;
+
+	/*!
+	 * The list of processors to sample, as configured by the user. If empty, all processors are sampled.
+	 */
+	QList<int> processors;
+
+	/*!
+	 * The number of data pages of each ring buffer, a power of two.
+	 */
+	int pages = 16;
+
+	/*!
+	 * The size of a memory page in bytes.
+	 */
+	long page_size = 4096;
+
+	/*!
+	 * The interval in milliseconds in which the reader drains the ring buffers.
+	 */
+	int interval = 100;
+
+	/*!
+	 * The maximum number of samples kept for every thread.
+	 */
+	int max_samples = 10000;
+
+	/*!
+	 * The samplers of all processors, empty until the first thread is started.
+	 */
+	QList<sampler> samplers;
+
+	/*!
+	 * The samples of all threads of the current measurement.
+	 */
+	std::map<int, thread_samples> threads;
+
+	/*!
+	 * The number of samples the kernel has dropped because a ring buffer was full.
+	 */
+	uint64_t lost = 0;
+
+	/*!
+	 * Mutex for accessing the ring buffers and the samples, which are shared with the reader.
+	 */
+	QMutex mutex;
+
+	/*!
+	 * The background thread which drains the ring buffers.
+	 */
+	Reader reader;
+}; // class Main
+
+} // namespace Sampling
+} // namespace Monitor
+} // namespace AutopinPlus
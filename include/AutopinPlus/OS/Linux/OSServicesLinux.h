@@ -66,7 +66,7 @@ class OSServicesLinux : public OSServices {
 	QString getHostname() override;
 	QString getCommDefaultAddr() override;
 	int createProcess(QString cmd, bool wait) override;
-	void setAffinity(int tid, int cpu) override;
+	void setAffinity(int tid, const std::set<int> &cpus) override;
 	void attachToProcess(ObservedProcess *observed_process) override;
 	void detachFromProcess() override;
 	void initCommChannel(ObservedProcess *proc) override;
@@ -96,6 +96,93 @@ class OSServicesLinux : public OSServices {
 	 */
 	int getTaskSortId(int tid) override;
 
+	/*!
+	 * \brief Returns the hardware topology of the system
+	 *
+	 * The topology is read from /sys/devices/system/cpu and /sys/devices/system/node.
+	 * The last level cache of a cpu is the data or unified cache with the highest
+	 * level, it is identified by the lowest cpu sharing it. If no cache information is
+	 * available the socket is used instead.
+	 *
+	 * \return A list containing all online cpus sorted by their number. If the topology
+	 * 	cannot be determined the list will be empty.
+	 */
+	autopin_topology getTopology() override;
+
+	/*!
+	 * \brief Determines on which NUMA nodes the memory of a task is located
+	 *
+	 * The information is read from /proc/<tid>/numa_maps. The page counts of every
+	 * mapping are converted to kB using the page size of the mapping. As numa_maps
+	 * describes the address space of the whole process, all tasks of a process
+	 * yield the same result.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return A map containing the amount of memory in kB for every node on which
+	 * 	the task has memory. If numa_maps cannot be read the map will be empty.
+	 */
+	autopin_memory_nodes getMemoryNodes(int tid) override;
+
+	/*!
+	 * \brief Moves the memory of a task to another NUMA node
+	 *
+	 * This uses the migrate_pages(2) system call. Pages which cannot be moved
+	 * (e. g. because they are shared with other processes) stay where they are.
+	 *
+	 * \param[in] tid	The id of the task
+	 * \param[in] from	The nodes from which the memory will be moved
+	 * \param[in] to	The node to which the memory will be moved
+	 */
+	void migrateMemory(int tid, const QList<int> &from, int to) override;
+
+	/*!
+	 * \brief Returns information for classifying a task
+	 *
+	 * The names are read from /proc/<tid>/comm and from the comm file of the thread
+	 * group leader. The cpu share is the user and system time of the task divided by
+	 * the time since its creation.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return The name, process name and cpu share of the task
+	 */
+	autopin_task_info getTaskInfo(int tid) override;
+
+	/*!
+	 * \brief Returns the task which has created a task
+	 *
+	 * The creator is only known for tasks which have been created while the
+	 * observed process was traced.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return The id of the creating task or -1 if it is not known
+	 */
+	int getTaskCreator(int tid) override;
+
+	/*!
+	 * \brief Determines if a process is still running
+	 *
+	 * A process is running if /proc/<pid>/stat exists and the process is not a zombie.
+	 *
+	 * \param[in] pid	The id of the process
+	 *
+	 * \return True if the process exists and has not terminated
+	 */
+	bool isRunning(int pid) override;
+
+	/*!
+	 * \brief Returns the current frequency and the thermal throttling of all cpus
+	 *
+	 * The frequencies are read from cpufreq/scaling_cur_freq and cpufreq/cpuinfo_max_freq
+	 * and the throttling from the core and package counters in thermal_throttle below
+	 * /sys/devices/system/cpu/cpu<n>.
+	 *
+	 * \return A map containing the state of every online cpu
+	 */
+	autopin_cpu_states getCpuStates() override;
+
 	/*!
 	 * \brief Returns the hostname of the host running autopin+
 	 *
@@ -189,6 +276,25 @@ class OSServicesLinux : public OSServices {
 	 */
 	static ProcessTree::autopin_tid_list convertQStringList(QStringList &qlist);
 
+	/*!
+	 * \brief Reads a single value from the sysfs
+	 *
+	 * \param[in] path The path of the file in the sysfs
+	 *
+	 * \return The content of the file without leading and trailing whitespace. If the
+	 * 	file cannot be read the string is empty.
+	 */
+	static QString readSysfsEntry(QString path);
+
+	/*!
+	 * \brief Converts a cpu list as used by the kernel (e. g. "0-3,8") to a list of integers
+	 *
+	 * \param[in] list The cpu list
+	 *
+	 * \return The numbers of all cpus in the list
+	 */
+	static QList<int> parseCpuList(QString list);
+
 	/*!
 	 * Mutex for thread-safe access
 	 */
@@ -32,6 +32,7 @@
 #include <AutopinPlus/Error.h>
 #include <AutopinPlus/ObservedProcess.h>
 #include <AutopinPlus/ProcessTree.h>
+#include <map>
 #include <QMutex>
 #include <QString>
 #include <QThread>
@@ -84,6 +85,15 @@ class TraceThread : public QThread {
 	 */
 	static void alrmSignalHandler(int param);
 
+	/*!
+	 * \brief Returns the task which has created a task
+	 *
+	 * \param[in] tid The tid of the created task
+	 * \return The tid of the creating task or -1 if the task has not been
+	 * 	created while it was traced
+	 */
+	int getCreator(int tid);
+
   protected:
 	/*!
 	 * \brief The method which will be executed by the thread
@@ -141,6 +151,16 @@ signals:
 	 */
 	ProcessTree::autopin_tid_list new_tasks;
 
+	/*!
+	 * Maps the tids of created tasks to the tids of the tasks which created them
+	 */
+	std::map<int, int> creators;
+
+	/*!
+	 * Mutex for accessing creators
+	 */
+	QMutex creator_mutex;
+
 	/*!
 	 * Pointer to the internal representation of the process observed by the thread
 	 */
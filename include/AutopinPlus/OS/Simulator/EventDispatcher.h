@@ -0,0 +1,121 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>						  // for map
+#include <QAbstractEventDispatcher>	  // for QAbstractEventDispatcher
+#include <QEventLoop>				  // for QEventLoop
+#include <QList>					  // for QList
+#include <QObject>					  // for QObject
+#include <QSocketNotifier>			  // for QSocketNotifier
+#include <qglobal.h>				  // for qint64
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+/*!
+ * \brief Event dispatcher which runs the Qt event loop in virtual time.
+ *
+ * Instead of waiting for the next timer, the virtual time jumps to it. All posted events are delivered before the
+ * time advances. The virtual time is used as the source of Clock, so the control strategies measure durations in
+ * virtual time as well. The event loop exits when no timers are left or the end of the simulation is reached.
+ *
+ * An instance has to be created before the application object, so that Qt uses it for the main thread.
+ */
+class EventDispatcher : public QAbstractEventDispatcher {
+	Q_OBJECT
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] parent The parent object
+	 */
+	explicit EventDispatcher(QObject *parent = nullptr);
+
+	/*!
+	 * \brief Destructor
+	 */
+	virtual ~EventDispatcher();
+
+	/*!
+	 * \brief Returns the current virtual time.
+	 *
+	 * \return The time in milliseconds since the start of the simulation.
+	 */
+	qint64 now() const;
+
+	/*!
+	 * \brief Sets the end of the simulation.
+	 *
+	 * \param[in] end The virtual time in milliseconds after which the event loop exits, -1 for no limit
+	 */
+	void setEnd(qint64 end);
+
+	// Overridden from base class
+	bool processEvents(QEventLoop::ProcessEventsFlags flags) override;
+	bool hasPendingEvents() override;
+	void registerSocketNotifier(QSocketNotifier *notifier) override;
+	void unregisterSocketNotifier(QSocketNotifier *notifier) override;
+	void registerTimer(int timerId, int interval, QObject *object) override;
+	bool unregisterTimer(int timerId) override;
+	bool unregisterTimers(QObject *object) override;
+	QList<TimerInfo> registeredTimers(QObject *object) const override;
+	void wakeUp() override;
+	void interrupt() override;
+	void flush() override;
+
+  private:
+	/*!
+	 * \brief A registered timer
+	 */
+	struct timer {
+		//! The interval of the timer in milliseconds
+		int interval;
+		//! The object receiving the timer events
+		QObject *object;
+		//! The virtual time of the next timer event
+		qint64 due;
+	};
+
+	/*!
+	 * \brief The registered timers by their id.
+	 */
+	std::map<int, timer> timers;
+
+	/*!
+	 * \brief The current virtual time in milliseconds.
+	 */
+	qint64 time = 0;
+
+	/*!
+	 * \brief The end of the simulation, -1 for no limit.
+	 */
+	qint64 end = -1;
+
+	/*!
+	 * \brief Whether processEvents() shall return as soon as possible.
+	 */
+	bool interrupted = false;
+};
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
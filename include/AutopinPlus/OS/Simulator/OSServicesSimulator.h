@@ -0,0 +1,210 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h> // for AutopinContext
+#include <AutopinPlus/Configuration.h>	// for Configuration
+#include <AutopinPlus/OSServices.h>		// for OSServices, etc
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h> // for PinningHistory, etc
+#include <AutopinPlus/ProcessTree.h>	// for ProcessTree, etc
+#include <map>							// for map
+#include <QString>						// for QString
+#include <set>							// for set
+#include <qglobal.h>					// for qint64
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+/*!
+ * \brief Simulated os services which replay recorded measurements
+ *
+ * The simulated process consists of a fixed number of threads. The performance of every thread depends on the
+ * current pinning of all threads and is looked up in a pinning history which has been recorded on a real system.
+ * Pinnings which haven't been recorded get the value of the most similar recorded pinning. The work done by every
+ * thread is integrated over the virtual time, it is read by the replay performance monitor.
+ */
+class OSServicesSimulator : public OSServices {
+	Q_OBJECT
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config  Pointer to the configuration
+	 * \param[in] context Refernce to the context of the object calling the constructor
+	 */
+	OSServicesSimulator(Configuration *config, const AutopinContext &context);
+
+	/*!
+	 * \brief Destructor
+	 */
+	virtual ~OSServicesSimulator();
+
+	/*!
+	 * \brief Returns the work done by a thread
+	 *
+	 * \param[in] tid The id of the thread
+	 *
+	 * \return The integral of the recorded performance over the virtual time (in milliseconds) the thread has existed.
+	 */
+	double getWork(int tid);
+
+	/*!
+	 * \brief Returns the current pinning of all threads
+	 *
+	 * \return The cpus of every thread in the order of the threads, unpinned threads may use all cpus.
+	 */
+	PinningHistory::autopin_pinning getPinning();
+
+	/*!
+	 * \brief Returns the recorded performance of a pinning
+	 *
+	 * \param[in] pinning The pinning
+	 *
+	 * \return The value of the pinning or of the most similar recorded pinning.
+	 */
+	double getPerformance(const PinningHistory::autopin_pinning &pinning);
+
+	/*!
+	 * \brief Returns whether greater or smaller recorded values are better
+	 *
+	 * \return The type of the recorded values
+	 */
+	PerformanceMonitor::montype getValType();
+
+	/*!
+	 * \brief Writes a summary of the simulation to the output
+	 */
+	void summary();
+
+	// Overridden from base class
+	void init() override;
+	QString getHostname() override;
+	QString getCommDefaultAddr() override;
+	int createProcess(QString cmd, bool wait) override;
+	void setAffinity(int tid, const std::set<int> &cpus) override;
+	void attachToProcess(ObservedProcess *observed_process) override;
+	void detachFromProcess() override;
+	void initCommChannel(ObservedProcess *proc) override;
+	void deinitCommChannel() override;
+	void connectCommChannel(int timeout) override;
+	void sendMsg(int event_id, int arg, double val) override;
+	ProcessTree::autopin_tid_list getPid(QString proc) override;
+	QString getCmd(int pid) override;
+	ProcessTree::autopin_tid_list getProcessThreads(int pid) override;
+	ProcessTree::autopin_tid_list getChildProcesses(int pid) override;
+	autopin_topology getTopology() override;
+
+  private:
+	/*!
+	 * \brief Adds the work done since the last update to all threads
+	 */
+	void updateWork();
+
+	/*!
+	 * \brief Pointer to the configuration
+	 */
+	Configuration *config;
+
+	/*!
+	 * \brief The configuration of the trace
+	 */
+	Configuration *trace_config = nullptr;
+
+	/*!
+	 * \brief The recorded measurements
+	 */
+	PinningHistory *trace = nullptr;
+
+	/*!
+	 * \brief The recorded pinnings and their values
+	 */
+	std::map<PinningHistory::autopin_pinning, double> recorded;
+
+	/*!
+	 * \brief The best recorded pinning
+	 */
+	PinningHistory::pinning_result best;
+
+	/*!
+	 * \brief Whether greater or smaller recorded values are better
+	 */
+	PerformanceMonitor::montype valtype = PerformanceMonitor::montype::MAX;
+
+	/*!
+	 * \brief The cpus of the simulated system
+	 */
+	std::set<int> cpus;
+
+	/*!
+	 * \brief The number of sockets of the simulated system
+	 */
+	int sockets = 1;
+
+	/*!
+	 * \brief The pid of the simulated process
+	 */
+	int pid = 1000;
+
+	/*!
+	 * \brief The number of threads of the simulated process
+	 */
+	int threads = 0;
+
+	/*!
+	 * \brief Whether the simulated process has been started
+	 */
+	bool running = false;
+
+	/*!
+	 * \brief The cpus of every pinned thread
+	 */
+	std::map<int, std::set<int>> affinities;
+
+	/*!
+	 * \brief The work done by every thread
+	 */
+	std::map<int, double> work;
+
+	/*!
+	 * \brief The performance of the current pinning
+	 */
+	double performance = 0;
+
+	/*!
+	 * \brief The virtual time of the last update of the work
+	 */
+	qint64 last_update = 0;
+
+	/*!
+	 * \brief The virtual time at which the best performance has been reached first, -1 if it hasn't been reached
+	 */
+	qint64 best_time = -1;
+
+	/*!
+	 * \brief The best performance which has been reached
+	 */
+	double best_reached = 0;
+};
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
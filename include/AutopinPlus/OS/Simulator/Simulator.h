@@ -0,0 +1,73 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/Autopin.h>							 // for Autopin
+#include <AutopinPlus/Configuration.h>						 // for Configuration
+#include <AutopinPlus/OS/Simulator/OSServicesSimulator.h> // for OSServicesSimulator
+#include <AutopinPlus/PerformanceMonitor.h>					 // for PerformanceMonitor, etc
+#include <QString>											 // for QString
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+/*!
+ * \brief autopin+ running against a recorded trace instead of a real process
+ *
+ * The simulator uses the same configuration as autopin+, but the observed process and
+ * the performance monitors of type "replay" are simulated from a pinning history
+ * (see OSServicesSimulator). Together with the EventDispatcher, which has to be created
+ * before the application, all timers fire in virtual time, so strategies can be run
+ * for hours of simulated time within seconds.
+ */
+class Simulator : public Autopin {
+	Q_OBJECT
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in]	argc	Reference to the number of command line arguments of the application
+	 * \param[in] argv	String array with command line arguments
+	 */
+	Simulator(int &argc, char **argv);
+
+  public slots:
+	/*!
+	 * \brief Writes the summary of the simulation
+	 */
+	void slot_simulatorSummary();
+
+  protected:
+	// Overridden from base class
+	void createOSServices() override;
+	void createPerformanceMonitor(Configuration *config, QString id,
+								  PerformanceMonitor::monitor_list &monitors) override;
+
+  private:
+	/*!
+	 * \brief The simulated os services
+	 */
+	OSServicesSimulator *simulator = nullptr;
+};
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
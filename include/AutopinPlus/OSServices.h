@@ -33,8 +33,10 @@
 #include <AutopinPlus/ObservedProcess.h>
 #include <deque>
 #include <map>
+#include <QList>
 #include <QObject>
 #include <QString>
+#include <set>
 #include <string>
 
 extern "C" {
@@ -55,6 +57,72 @@ class OSServices : public QObject {
 	Q_OBJECT
 
   public:
+	/*!
+	 * \brief Describes the position of a logical cpu in the hardware topology
+	 *
+	 * All ids are only unique within their own category. If the operating system
+	 * does not provide some of the information the corresponding ids are 0.
+	 */
+	struct autopin_cpu {
+		//! The number of the logical cpu as used by setAffinity()
+		int cpu;
+		//! The id of the physical core the cpu belongs to (unique within a socket)
+		int core;
+		//! The id of the socket (physical package) the cpu belongs to
+		int socket;
+		//! The id of the NUMA node the cpu belongs to
+		int node;
+		//! The id of the last level cache the cpu is attached to
+		int llc;
+	};
+
+	/*!
+	 * \brief Data type for storing the topology of the system
+	 */
+	typedef std::deque<autopin_cpu> autopin_topology;
+
+	/*!
+	 * \brief Data type for storing the amount of memory (in kB) on every NUMA node
+	 */
+	typedef std::map<int, unsigned long> autopin_memory_nodes;
+
+	/*!
+	 * \brief Describes the current clock frequency and the thermal throttling of a logical cpu
+	 *
+	 * If the operating system does not provide some of the information the
+	 * corresponding fields are 0.
+	 */
+	struct autopin_cpu_state {
+		//! The current frequency in MHz
+		double frequency;
+		//! The maximum frequency in MHz
+		double max_frequency;
+		//! The number of times the cpu has been throttled because of its temperature
+		unsigned long throttle_count;
+	};
+
+	/*!
+	 * \brief Data type for storing the state of every logical cpu
+	 */
+	typedef std::map<int, autopin_cpu_state> autopin_cpu_states;
+
+	/*!
+	 * \brief Describes a task for classifying it by its behaviour
+	 *
+	 * If the operating system does not provide some of the information the
+	 * corresponding fields are empty or 0.
+	 */
+	struct autopin_task_info {
+		//! The name of the task
+		QString name;
+		//! The id of the process the task belongs to
+		int pid;
+		//! The name of the process the task belongs to
+		QString process;
+		//! The fraction of its lifetime the task has spent running on a cpu
+		double cpu_share;
+	};
+
 	/*!
 	 * \brief Constructor
 	 *
@@ -111,13 +179,15 @@ class OSServices : public QObject {
 	virtual int createProcess(QString cmd, bool wait) = 0;
 
 	/*!
-	 * \brief Assigns a task to a certain core
+	 * \brief Assigns a task to a set of cores
+	 *
+	 * The operating system may move the task freely between the cores of the set.
 	 *
 	 * \param[in] tid	The id of the task
-	 * \param[in] cpu	The number of the core the task will be assigned to
+	 * \param[in] cpus	The numbers of the cores the task will be assigned to
 	 *
 	 */
-	virtual void setAffinity(int tid, int cpu) = 0;
+	virtual void setAffinity(int tid, const std::set<int> &cpus) = 0;
 
 	/*!
 	 * \brief Attaches autopin+ to a process
@@ -238,6 +308,86 @@ class OSServices : public QObject {
 	 */
 	virtual int getTaskSortId(int tid);
 
+	/*!
+	 * \brief Returns the hardware topology of the system
+	 *
+	 * The standard implementation returns an empty list.
+	 *
+	 * \return A list containing all online cpus sorted by their number. If the topology
+	 * 	cannot be determined or an error has occured the list will be empty.
+	 */
+	virtual autopin_topology getTopology();
+
+	/*!
+	 * \brief Determines on which NUMA nodes the memory of a task is located
+	 *
+	 * The standard implementation returns an empty map.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return A map containing the amount of memory in kB for every node on which
+	 * 	the task has memory. If the information is not available or an error has
+	 * 	occured the map will be empty.
+	 */
+	virtual autopin_memory_nodes getMemoryNodes(int tid);
+
+	/*!
+	 * \brief Moves the memory of a task to another NUMA node
+	 *
+	 * As all tasks of a process share their address space, this moves the memory
+	 * of the whole process. The standard implementation does nothing.
+	 *
+	 * \param[in] tid	The id of the task
+	 * \param[in] from	The nodes from which the memory will be moved
+	 * \param[in] to	The node to which the memory will be moved
+	 */
+	virtual void migrateMemory(int tid, const QList<int> &from, int to);
+
+	/*!
+	 * \brief Returns information for classifying a task
+	 *
+	 * The standard implementation returns the task itself as its process, empty
+	 * names and a cpu share of 0.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return The name, process name and cpu share of the task
+	 */
+	virtual autopin_task_info getTaskInfo(int tid);
+
+	/*!
+	 * \brief Returns the task which has created a task
+	 *
+	 * The standard implementation returns -1.
+	 *
+	 * \param[in] tid	The id of the task
+	 *
+	 * \return The id of the creating task or -1 if it is not known
+	 */
+	virtual int getTaskCreator(int tid);
+
+	/*!
+	 * \brief Determines if a process is still running
+	 *
+	 * This is used for processes whose termination is not reported because they
+	 * are not traced. The standard implementation returns true.
+	 *
+	 * \param[in] pid	The id of the process
+	 *
+	 * \return True if the process exists and has not terminated
+	 */
+	virtual bool isRunning(int pid);
+
+	/*!
+	 * \brief Returns the current frequency and the thermal throttling of all cpus
+	 *
+	 * The standard implementation returns an empty map.
+	 *
+	 * \return A map containing the state of every online cpu. If the information
+	 * 	is not available the map will be empty.
+	 */
+	virtual autopin_cpu_states getCpuStates();
+
 signals:
 	/*!
 	 * \brief Signals that a task has terminated
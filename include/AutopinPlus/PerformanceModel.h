@@ -0,0 +1,167 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/OSServices.h>			// for OSServices, etc
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <map>								// for map
+#include <qstring.h>						// for QString
+#include <vector>							// for vector
+
+namespace AutopinPlus {
+
+/*!
+ * \brief A ridge regression model predicting the performance of pinnings from their placement.
+ *
+ * Pinnings are described by features of their placement on the hardware topology, e.g. how many sockets are used
+ * and how many threads share a core or a last level cache, so results measured for some pinnings carry over to
+ * pinnings which have never been measured. The placement is taken from the description of the cores relative to the
+ * topology (see PinningHistory::showPlacement()), so results of pinnings which don't fit this system can be used as
+ * well. The model is trained on all results of a pinning history. As the values of different phases are not
+ * comparable, they are normalized by the mean value of their phase and bigger normalized values are always "better".
+ */
+class PerformanceModel {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] topology       The topology of the system on which the pinnings are placed
+	 * \param[in] regularization The weight of the penalty on the squared coefficients. Bigger values make the model
+	 *                           more conservative when there are only few results.
+	 */
+	PerformanceModel(const OSServices::autopin_topology &topology, double regularization = 1);
+
+	/*!
+	 * \brief Trains the model on all results of a pinning history.
+	 *
+	 * This includes the results which don't fit the topology of this system (see
+	 * PinningHistory::getUnplacedResults()).
+	 *
+	 * \param[in] history The pinning history.
+	 * \param[in] type    Whether bigger or smaller values of the history are better.
+	 *
+	 * \return The number of results the model has been trained on.
+	 */
+	int train(const PinningHistory &history, PerformanceMonitor::montype type);
+
+	/*!
+	 * \brief Predicts the performance of a pinning.
+	 *
+	 * \param[in] pinning The pinning.
+	 *
+	 * \return The predicted performance relative to the mean of a phase, bigger values are better.
+	 */
+	double predict(const PinningHistory::autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Computes the features of a pinning.
+	 *
+	 * The features are a constant 1, the number of threads relative to the number of cpus, the share of the sockets
+	 * which are used, the share of the threads on the most loaded socket and the shares of the threads which share
+	 * their core, their last level cache or their cpu with another thread. A thread which may run on several cpus is
+	 * placed on the lowest one, threads on cpus which are not part of the topology are ignored.
+	 *
+	 * \param[in] pinning The pinning.
+	 *
+	 * \return The features of the pinning.
+	 */
+	std::vector<double> features(const PinningHistory::autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Computes the features of a pinning given by its placement.
+	 *
+	 * The features are the same as for a pinning of this system. Cores which don't exist on this system are assumed
+	 * to share the last level cache with the other cores of their socket.
+	 *
+	 * \param[in] placement The placement as returned by PinningHistory::showPlacement().
+	 *
+	 * \return The features of the pinning.
+	 */
+	std::vector<double> features(const QString &placement) const;
+
+	/*!
+	 * \brief Returns the coefficients of the features.
+	 *
+	 * \return The coefficients in the order of features(), all zero if the model hasn't been trained.
+	 */
+	const std::vector<double> &getWeights() const;
+
+  private:
+	/*!
+	 * \brief The position of a thread on the topology.
+	 */
+	struct placed_thread {
+		//! The description of the core relative to the topology
+		QString name;
+		//! The index of the socket
+		int socket;
+		//! The index of the physical core within the socket
+		int core;
+		//! The id of the last level cache
+		int llc;
+	};
+
+	/*!
+	 * \brief Determines the position of a thread from the description of its core.
+	 *
+	 * \param[in]  name   The description of the core as returned by PinningHistory::showPlacement().
+	 * \param[out] result The position of the thread.
+	 *
+	 * \return False if the description is not valid.
+	 */
+	bool place(const QString &name, placed_thread &result) const;
+
+	/*!
+	 * \brief Computes the features of threads placed on the topology.
+	 *
+	 * \param[in] placed The positions of the threads.
+	 *
+	 * \return The features of the threads.
+	 */
+	std::vector<double> features(const std::vector<placed_thread> &placed) const;
+
+	/*!
+	 * \brief The description of the cpus of the system by their number.
+	 */
+	std::map<int, QString> names;
+
+	/*!
+	 * \brief The last level caches of the cpus of the system by their description.
+	 */
+	std::map<QString, int> llcs;
+
+	/*!
+	 * \brief The number of sockets of the system.
+	 */
+	int sockets = 0;
+
+	/*!
+	 * \brief The weight of the penalty on the squared coefficients.
+	 */
+	double regularization;
+
+	/*!
+	 * \brief The coefficients of the features.
+	 */
+	std::vector<double> weights;
+};
+
+} // namespace AutopinPlus
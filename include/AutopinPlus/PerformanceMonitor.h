@@ -107,6 +107,42 @@ class PerformanceMonitor {
 	 */
 	virtual QString getUnit();
 
+	/*!
+	 * \brief Returns the share of the last measurement of a task during which the monitor was actually counting
+	 *
+	 * The kernel multiplexes hardware counters if more events are requested than the PMU provides. Monitors
+	 * which extrapolate their values to the whole measurement report the fraction of the time the counters were
+	 * running here, so callers can judge how reliable a value is.
+	 *
+	 * \param[in] tid	The tid of the task
+	 *
+	 * \return Value between 0 and 1. Monitors which are not multiplexed always return 1.
+	 */
+	virtual double getCoverage(int tid);
+
+	/*!
+	 * \brief Checks whether the monitor measures the tasks created by a monitored task as well
+	 *
+	 * Process-wide monitors count a task together with all tasks it creates after it has been started (e.g. with the
+	 * inherit flag of perf). Control strategies only have to start them for the tasks which exist when a measurement
+	 * begins, tasks created later are included in the values of their creators. The values of a terminated task
+	 * remain readable until it is stopped.
+	 *
+	 * \return True if the monitor is process-wide, false if every task has to be started separately.
+	 */
+	virtual bool isProcessWide();
+
+	/*!
+	 * \brief Checks whether the values of the monitor accumulate over the measurement
+	 *
+	 * Most monitors count events, so their values grow with the length of a measurement and have to be divided by
+	 * its duration to get a rate. Other monitors (e.g. ratios like instructions per cycle) already yield a rate
+	 * which must be compared as it is.
+	 *
+	 * \return True if the values are counts, false if they are independent of the length of the measurement.
+	 */
+	virtual bool isCumulative();
+
 	/*!
 	 * \brief Returns the configuration options of the monitor
 	 *
@@ -31,12 +31,15 @@
 #include <AutopinPlus/AutopinContext.h>
 #include <AutopinPlus/Configuration.h>
 #include <AutopinPlus/Error.h>
+#include <AutopinPlus/OSServices.h>
+#include <AutopinPlus/PerformanceMonitor.h>
 #include <deque>
 #include <list>
 #include <map>
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <set>
 
 namespace AutopinPlus {
 
@@ -60,9 +63,14 @@ class PinningHistory {
 
   public:
 	/*!
-	 * \brief Data structure that maps tasks to cores
+	 * \brief Data type for storing the cores a single task may run on
 	 */
-	typedef std::deque<int> autopin_pinning;
+	typedef std::set<int> autopin_cpuset;
+
+	/*!
+	 * \brief Data structure that maps tasks to sets of cores
+	 */
+	typedef std::deque<autopin_cpuset> autopin_pinning;
 
 	/*!
 	 * \brief Data structure for storing a list of pinnings
@@ -74,6 +82,30 @@ class PinningHistory {
 	 */
 	typedef std::pair<autopin_pinning, double> pinning_result;
 
+	/*!
+	 * \brief Data structure for storing a pinning which is only known by its placement and its performance value
+	 */
+	typedef std::pair<QString, double> placement_result;
+
+	/*!
+	 * \brief Data type for storing statistics about repeated measurements of a pinning
+	 *
+	 * If a pinning has been measured several times its value in the history is the mean of
+	 * all results. The statistics make it possible to continue the aggregation later.
+	 */
+	typedef struct {
+		int samples;
+		double variance;
+	} pinning_stats;
+
+	/*!
+	 * \brief Data type for storing additional named measurements of a pinning
+	 *
+	 * This is used by control strategies which optimize more than one value, e. g.
+	 * runtime and energy.
+	 */
+	typedef std::map<QString, double> pinning_metrics;
+
 	/*!
 	 * \brief Constructor
 	 *
@@ -108,10 +140,26 @@ class PinningHistory {
 	 */
 	virtual void addPinning(int phase, autopin_pinning pinning, double value);
 
+	/*!
+	 * \brief Adds a new pinning with measurement statistics to the pinning history
+	 *
+	 * Works like addPinning(int, autopin_pinning, double), but additionally stores how
+	 * many results have been aggregated into the value and their variance. Adding the
+	 * pinning again without statistics removes them.
+	 *
+	 * \param[in] phase	The current phase of the observed process
+	 * \param[in] pinning	The pinning which will be added to the history
+	 * \param[in] value	Mean performance result for the pinning
+	 * \param[in] stats	Statistics about the aggregated results
+	 */
+	virtual void addPinning(int phase, autopin_pinning pinning, double value, pinning_stats stats);
+
 	/*!
 	 * \brief Reads a pinning from the history
 	 *
-	 * The best pinning for every phase is updated on every call of addPinning().
+	 * The best pinning for every phase is updated on every call of addPinning(). Whether
+	 * the pinning with the biggest or the smallest value is the best one depends on the
+	 * objective, see setObjective().
 	 *
 	 * \param[in] phase The desired process phase
 	 *
@@ -120,6 +168,23 @@ class PinningHistory {
 	 */
 	virtual pinning_result getBestPinning(int phase) const;
 
+	/*!
+	 * \brief Sets whether bigger or smaller values are better
+	 *
+	 * The best pinnings of all phases are determined again. The objective is stored in
+	 * the history, so the values keep their meaning when they are read again later.
+	 *
+	 * \param[in] type MIN if smaller values are better, bigger values are better otherwise
+	 */
+	void setObjective(PerformanceMonitor::montype type);
+
+	/*!
+	 * \brief Returns whether bigger or smaller values are better
+	 *
+	 * \return MIN if smaller values are better, MAX otherwise
+	 */
+	PerformanceMonitor::montype getObjective() const;
+
 	/*!
 	 * \brief Reads all pinnings of a phase
 	 *
@@ -130,6 +195,161 @@ class PinningHistory {
 	 */
 	std::list<pinning_result> getPinnings(int phase) const;
 
+	/*!
+	 * \brief Returns the phases for which pinnings are stored
+	 *
+	 * \return The ids of all process phases which have at least
+	 * 	one pinning in the history
+	 */
+	std::set<int> getPhases() const;
+
+	/*!
+	 * \brief Reads the measurement statistics of a pinning
+	 *
+	 * \param[in] phase   The desired process phase
+	 * \param[in] pinning The desired pinning
+	 *
+	 * \return The statistics of the pinning. If no statistics have been stored
+	 * 	the number of samples is 0.
+	 */
+	pinning_stats getPinningStats(int phase, const autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Stores additional measurements of a pinning
+	 *
+	 * Existing measurements with the same names are replaced.
+	 *
+	 * \param[in] phase   The phase of the observed process
+	 * \param[in] pinning The pinning
+	 * \param[in] metrics The measurements
+	 */
+	void setPinningMetrics(int phase, const autopin_pinning &pinning, const pinning_metrics &metrics);
+
+	/*!
+	 * \brief Reads the additional measurements of a pinning
+	 *
+	 * \param[in] phase   The desired process phase
+	 * \param[in] pinning The desired pinning
+	 *
+	 * \return The measurements of the pinning. If none have been stored the map is empty.
+	 */
+	pinning_metrics getPinningMetrics(int phase, const autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Stores the tasks to which the entries of a pinning have been applied
+	 *
+	 * \param[in] phase   The phase of the observed process
+	 * \param[in] pinning The pinning
+	 * \param[in] tasks   The identities of the tasks (see ControlStrategy::getTaskId())
+	 * 	in the order of the entries of the pinning
+	 */
+	void setPinningTasks(int phase, const autopin_pinning &pinning, const QStringList &tasks);
+
+	/*!
+	 * \brief Reads the tasks to which the entries of a pinning have been applied
+	 *
+	 * \param[in] phase   The desired process phase
+	 * \param[in] pinning The desired pinning
+	 *
+	 * \return The identities of the tasks. If none have been stored the list is empty.
+	 */
+	QStringList getPinningTasks(int phase, const autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Converts a set of cores to a string
+	 *
+	 * \param[in] cpus The set of cores
+	 *
+	 * \return A list of cores and ranges, e. g. "0-3,8"
+	 */
+	static QString showCpuSet(const autopin_cpuset &cpus);
+
+	/*!
+	 * \brief Converts a string to a set of cores
+	 *
+	 * \param[in] str A list of cores and ranges, e. g. "0-3,8"
+	 *
+	 * \exception Exception The string is not a valid list of cores or contains cores
+	 * 	which cannot be represented in a cpu_set_t (CPU_SETSIZE or more)
+	 *
+	 * \return The set of cores
+	 */
+	static autopin_cpuset readCpuSet(QString str);
+
+	/*!
+	 * \brief Converts a pinning to a string
+	 *
+	 * \param[in] pinning The pinning
+	 *
+	 * \return The sets of cores of all tasks separated by colons, e. g. "0:1:4-7"
+	 */
+	static QString showPinning(const autopin_pinning &pinning);
+
+	/*!
+	 * \brief Sets the topology used for storing pinnings independently of the core numbers
+	 *
+	 * The topology has to be set before init() is called, otherwise pinnings are only
+	 * stored with absolute core numbers.
+	 *
+	 * \param[in] topology The topology of the system
+	 */
+	void setTopology(const OSServices::autopin_topology &topology);
+
+	/*!
+	 * \brief Converts a pinning to a string relative to the topology
+	 *
+	 * Every core is described by the index of its socket, the index of its physical core
+	 * within the socket and the index of the hardware thread within the core, e.g. "s0c2t1".
+	 * All indices count from 0 in the order of the ids (resp. core numbers), so the same
+	 * placement has the same description on systems with a different numbering.
+	 *
+	 * \param[in] pinning The pinning
+	 *
+	 * \return The cores of all tasks separated by commas and colons, e.g. "s0c0t0:s1c0t0,s1c1t0".
+	 * 	If the topology is unknown or doesn't contain one of the cores the result is empty.
+	 */
+	QString showPlacement(const autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Resolves a string created by showPlacement() against the topology
+	 *
+	 * \param[in] str The placement
+	 *
+	 * \exception Exception The string is not valid or the topology doesn't contain one of
+	 * 	the described cores
+	 *
+	 * \return The pinning
+	 */
+	autopin_pinning readPlacement(QString str) const;
+
+	/*!
+	 * \brief Describes every core of a topology as in showPlacement()
+	 *
+	 * \param[in] topology The topology of the system
+	 *
+	 * \return The description of every core by its number
+	 */
+	static std::map<int, QString> placementNames(const OSServices::autopin_topology &topology);
+
+	/*!
+	 * \brief Stores the result of a pinning which doesn't fit the topology of this system
+	 *
+	 * Such a pinning cannot be applied, but its placement still tells something about the
+	 * performance of similar pinnings (see PerformanceModel).
+	 *
+	 * \param[in] phase     The phase of the observed process
+	 * \param[in] placement The pinning as returned by showPlacement()
+	 * \param[in] value     The performance value of the pinning
+	 */
+	void addUnplacedResult(int phase, const QString &placement, double value);
+
+	/*!
+	 * \brief Returns the results stored by addUnplacedResult()
+	 *
+	 * \return The placements and performance values for every phase
+	 */
+	const std::map<int, std::list<placement_result>> &getUnplacedResults() const;
+
 	const QString &getStrategy() const;
 
 	const Configuration::configopts &getStrategyOptions() const;
@@ -179,6 +399,16 @@ class PinningHistory {
 	void addPerformanceMonitor(monitor_config mon);
 
   protected:
+	/*!
+	 * \brief Compares two values with regard to the objective
+	 *
+	 * \param[in] a The first value
+	 * \param[in] b The second value
+	 *
+	 * \return True if a is better than b
+	 */
+	bool better(double a, double b) const;
+
 	/*!
 	 * \brief Data type for storing pinnings with regard to the process phase and the monitor measurements
 	 */
@@ -189,6 +419,21 @@ class PinningHistory {
 	 */
 	typedef std::map<int, pinning_result> best_pinning_map;
 
+	/*!
+	 * \brief Data type for storing the measurement statistics of pinnings with regard to the process phase
+	 */
+	typedef std::map<int, std::map<autopin_pinning, pinning_stats>> pinning_stats_map;
+
+	/*!
+	 * \brief Data type for storing the additional measurements of pinnings with regard to the process phase
+	 */
+	typedef std::map<int, std::map<autopin_pinning, pinning_metrics>> pinning_metrics_map;
+
+	/*!
+	 * \brief Data type for storing the tasks of pinnings with regard to the process phase
+	 */
+	typedef std::map<int, std::map<autopin_pinning, QStringList>> pinning_tasks_map;
+
 	/*!
 	 * Variables for storing a pointer to the current configuration instance
 	 */
@@ -209,11 +454,41 @@ class PinningHistory {
 	 */
 	best_pinning_map bestpinmap;
 
+	/*!
+	 * Measurement statistics for each phase
+	 */
+	pinning_stats_map statsmap;
+
+	/*!
+	 * Additional measurements for each phase
+	 */
+	pinning_metrics_map metricsmap;
+
+	/*!
+	 * Tasks of the pinnings for each phase
+	 */
+	pinning_tasks_map tasksmap;
+
 	/*!
 	 * Saved if the pinning history has been modified since loading
 	 */
 	bool history_modified;
 
+	/*!
+	 * Maps the cores of the system to their description relative to the topology
+	 */
+	std::map<int, QString> placement_names;
+
+	/*!
+	 * Maps descriptions relative to the topology to the cores of the system
+	 */
+	std::map<QString, int> placement_cpus;
+
+	/*!
+	 * Results of pinnings which don't fit the topology of the system for each phase
+	 */
+	std::map<int, std::list<placement_result>> unplaced;
+
 	// Data structures for storing environment information
   protected:
 	/*!
@@ -256,6 +531,11 @@ class PinningHistory {
 	 */
 	QString strategy;
 
+	/*!
+	 * Whether bigger (MAX) or smaller (MIN) values are better
+	 */
+	PerformanceMonitor::montype objective = PerformanceMonitor::MAX;
+
 	/*!
 	 * Configuration options of the control strategy
 	 */
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/PinningHistory.h> // for PinningHistory, etc
+#include <qlist.h>						// for QList
+
+namespace AutopinPlus {
+
+/*!
+ * \brief The set of all pinnings of a fixed number of threads to distinct processors.
+ *
+ * This class is used by search based control strategies to create random pinnings and to explore the neighbourhood
+ * of a pinning.
+ */
+class PinningSpace {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] cpus    The processors which may be used in a pinning
+	 * \param[in] threads The number of threads in a pinning
+	 */
+	PinningSpace(QList<int> cpus = QList<int>(), int threads = 0);
+
+	/*!
+	 * \brief Returns the processors which may be used in a pinning.
+	 *
+	 * \return The list of processors.
+	 */
+	const QList<int> &getCpus() const;
+
+	/*!
+	 * \brief Returns the number of threads in a pinning.
+	 *
+	 * \return The number of threads.
+	 */
+	int getThreads() const;
+
+	/*!
+	 * \brief Creates a random pinning.
+	 *
+	 * The random number generator has to be seeded with qsrand() beforehand.
+	 *
+	 * \return The new pinning.
+	 */
+	PinningHistory::autopin_pinning randomPinning() const;
+
+	/*!
+	 * \brief Creates a random neighbour of a pinning.
+	 *
+	 * A neighbour is created by swapping the processors of two threads or by moving one thread to a processor which
+	 * is not used by the pinning.
+	 *
+	 * \param[in] pinning The pinning to start from.
+	 *
+	 * \return The new pinning.
+	 */
+	PinningHistory::autopin_pinning neighbour(const PinningHistory::autopin_pinning &pinning) const;
+
+  private:
+	/*!
+	 * \brief The processors which may be used in a pinning.
+	 */
+	QList<int> cpus;
+
+	/*!
+	 * \brief The number of threads in a pinning.
+	 */
+	int threads;
+};
+
+} // namespace AutopinPlus
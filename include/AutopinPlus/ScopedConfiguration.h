@@ -0,0 +1,77 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h> // for AutopinContext
+#include <AutopinPlus/Configuration.h>  // for Configuration, etc
+#include <QString>						// for QString
+#include <QStringList>					// for QStringList
+
+namespace AutopinPlus {
+
+/*!
+ * \brief A view on another configuration which prefers options of a scope.
+ *
+ * Every option "name" is looked up as "<scope>.name" in the global configuration first. If this option doesn't exist,
+ * the option "name" itself is used, unless it is one of the local options. This is used to configure several
+ * applications from a single configuration.
+ */
+class ScopedConfiguration : public Configuration {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] global  The configuration which contains all options
+	 * \param[in] scope   The prefix of the options in this scope
+	 * \param[in] local   The options which are only read from the scope
+	 * \param[in] context Refernce to the context of the object calling the constructor
+	 */
+	ScopedConfiguration(Configuration *global, QString scope, QStringList local, const AutopinContext &context);
+
+	/*!
+	 * \brief Returns the prefix of the options in this scope.
+	 *
+	 * \return The prefix without the trailing dot.
+	 */
+	QString getScope();
+
+	// Overridden from base class
+	void init() override;
+	Configuration::configopts getConfigOpts() override;
+	QStringList getConfigOptionList(QString opt) override;
+
+  private:
+	/*!
+	 * \brief The configuration which contains all options.
+	 */
+	Configuration *global;
+
+	/*!
+	 * \brief The prefix of the options in this scope.
+	 */
+	QString scope;
+
+	/*!
+	 * \brief The options which are only read from the scope.
+	 */
+	QStringList local;
+};
+
+} // namespace AutopinPlus
@@ -0,0 +1,128 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h> // for AutopinContext
+#include <AutopinPlus/OSServices.h>		// for OSServices, etc
+#include <AutopinPlus/ProcessTree.h>	// for ProcessTree, etc
+#include <map>							// for map
+#include <QList>						// for QList
+#include <QString>						// for QString
+#include <set>							// for set
+
+namespace AutopinPlus {
+
+/*!
+ * \brief Restricts the os services to a share of the cpus.
+ *
+ * If several applications are observed, every application gets its own instance of this class. The control strategy
+ * of the application sees the cpus of the share as the cpus 0 to n-1, in the same order as they are passed to
+ * setShare(). Larger cpu numbers wrap around. All other services are forwarded to the os services of the system,
+ * which also emit the signals of the observed processes.
+ */
+class SharedOSServices : public OSServices {
+	Q_OBJECT
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] base    The os services of the system
+	 * \param[in] context Refernce to the context of the object calling the constructor
+	 */
+	SharedOSServices(OSServices *base, const AutopinContext &context);
+
+	/*!
+	 * \brief Changes the cpus of the share.
+	 *
+	 * The new cpus are used by the next calls of setAffinity() and applyShare().
+	 *
+	 * \param[in] cpus The cpus of the share
+	 */
+	void setShare(const QList<int> &cpus);
+
+	/*!
+	 * \brief Returns the cpus of the share.
+	 *
+	 * \return The cpus in the order of their virtual numbers.
+	 */
+	const QList<int> &getShare() const;
+
+	/*!
+	 * \brief Applies the share to the tasks of the application.
+	 *
+	 * The affinities which have been set by the control strategy are applied again to the current cpus of the share.
+	 * All other tasks are allowed to run on all cpus of the share.
+	 *
+	 * \param[in] tasks The tasks of the application
+	 */
+	void applyShare(const ProcessTree::autopin_tid_list &tasks);
+
+	// Overridden from base class
+	void init() override;
+	QString getHostname() override;
+	QString getCommDefaultAddr() override;
+	int createProcess(QString cmd, bool wait) override;
+	void setAffinity(int tid, const std::set<int> &cpus) override;
+	void attachToProcess(ObservedProcess *observed_process) override;
+	void detachFromProcess() override;
+	void initCommChannel(ObservedProcess *proc) override;
+	void deinitCommChannel() override;
+	void connectCommChannel(int timeout) override;
+	void sendMsg(int event_id, int arg, double val) override;
+	ProcessTree::autopin_tid_list getPid(QString proc) override;
+	QString getCmd(int pid) override;
+	ProcessTree::autopin_tid_list getProcessThreads(int pid) override;
+	ProcessTree::autopin_tid_list getChildProcesses(int pid) override;
+	int getTaskSortId(int tid) override;
+	autopin_topology getTopology() override;
+	autopin_memory_nodes getMemoryNodes(int tid) override;
+	void migrateMemory(int tid, const QList<int> &from, int to) override;
+	autopin_task_info getTaskInfo(int tid) override;
+	int getTaskCreator(int tid) override;
+	bool isRunning(int pid) override;
+	autopin_cpu_states getCpuStates() override;
+
+  private:
+	/*!
+	 * \brief Maps virtual cpu numbers to the cpus of the share.
+	 *
+	 * \param[in] cpus The virtual cpu numbers
+	 *
+	 * \return The cpus of the system
+	 */
+	std::set<int> mapCpus(const std::set<int> &cpus);
+
+	/*!
+	 * \brief The os services of the system.
+	 */
+	OSServices *base;
+
+	/*!
+	 * \brief The cpus of the share.
+	 */
+	QList<int> share;
+
+	/*!
+	 * \brief The affinities set by the control strategy in virtual cpu numbers.
+	 */
+	std::map<int, std::set<int>> affinities;
+};
+
+} // namespace AutopinPlus
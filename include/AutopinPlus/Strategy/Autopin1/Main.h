@@ -28,12 +28,14 @@
 
 #pragma once
 
+#include <AutopinPlus/Clock.h>
 #include <AutopinPlus/ControlStrategy.h>
 #include <deque>
-#include <QElapsedTimer>
+#include <map>
 #include <QStringList>
 #include <QTimer>
 #include <set>
+#include <utility>
 
 namespace AutopinPlus {
 namespace Strategy {
@@ -80,21 +82,67 @@ class Main : public ControlStrategy {
 	 */
 	void slot_stopPinning();
 
+	/*!
+	 * \brief Samples the performance monitor during the measure time
+	 *
+	 * Ends the measurement early if the results show that the current pinning is
+	 * clearly worse than the best one or if the result is already precise enough.
+	 */
+	void slot_sampleMonitor();
+
+	/*!
+	 * \brief Samples the performance monitor during the warmup time
+	 *
+	 * Ends the warmup early if the performance of the pinned tasks has settled.
+	 */
+	void slot_sampleWarmup();
+
+	/*!
+	 * \brief Samples the frequencies of the cpus of the pinned tasks during the measure time
+	 */
+	void slot_sampleFrequency();
+
+	/*!
+	 * \brief Samples the performance of the best pinning after the strategy has finished
+	 *
+	 * Starts a new round of tuning if the performance has been worse than the result of
+	 * the best pinning for drift_window consecutive samples.
+	 */
+	void slot_sampleDrift();
+
+	/*!
+	 * \brief Pins the tasks created during the measurement which have been running for role_delay
+	 */
+	void slot_pinCreatedTask();
+
 	void slot_TaskCreated(int tid) override;
 	void slot_TaskTerminated(int tid) override;
 	void slot_PhaseChanged(int newphase) override;
 
-  private:
+  protected:
 	/*!
 	 * \brief Data structure for storing the parameters of the currently pinned tasks.
 	 */
 	typedef struct {
 		int tid;
+		PinningHistory::autopin_cpuset cpus;
 		qint64 start;
 		qint64 stop;
 		double result;
+		double coverage;
+		bool inherited;
+		int entry;
 	} pinned_task;
 
+	/*!
+	 * \brief Data structure for storing a task which has been created but not classified yet
+	 */
+	typedef struct {
+		int tid;
+		int index;
+		qint64 time;
+	} created_task;
+
 	/*!
 	 * \brief List of pinned tasks
 	 */
@@ -111,6 +159,17 @@ class Main : public ControlStrategy {
 	 */
 	void applyPinning(PinningHistory::autopin_pinning pinning);
 
+	/*!
+	 * \brief Pins a task created after the current pinning has been applied
+	 *
+	 * The task is assigned to an entry of the current pinning according to its role
+	 * (see selectEntry()).
+	 *
+	 * \param[in] tid	The tid of the task
+	 * \param[in] index	The position of the task in tasks
+	 */
+	void pinCreatedTask(int tid, int index);
+
 	/*!
 	 * \brief Determines if all pinned tasks are still running
 	 *
@@ -121,6 +180,145 @@ class Main : public ControlStrategy {
 	 */
 	void checkPinnedTasks();
 
+	/*!
+	 * \brief Reads the options shared by all strategies based on autopin1
+	 *
+	 * Selects the performance monitor and reads the timing and thread selection options
+	 * from the configuration. All options are prefixed with the name of the strategy.
+	 */
+	void readOptions();
+
+	/*!
+	 * \brief Selects the pinning which will be tested next
+	 *
+	 * This method is called after the result of the current pinning has been
+	 * stored. The standard implementation simply walks through the schedule.
+	 * Subclasses can override it to append new pinnings to the list or to jump
+	 * to a different entry.
+	 *
+	 * \param[in] result The performance value of the pinning which has just been tested
+	 *
+	 * \return True if current_pinning refers to the next pinning which shall be tested,
+	 * 	false if the search is finished.
+	 */
+	virtual bool nextPinning(double result);
+
+	/*!
+	 * \brief Applies the best pinning after nextPinning() has returned false
+	 *
+	 * The default implementation also saves the pinning history.
+	 */
+	virtual void finish();
+
+	/*!
+	 * \brief Prepares a new round of tuning after the performance has drifted
+	 *
+	 * The default implementation starts again with the first pinning. Subclasses which
+	 * keep additional state for the search can reset it here.
+	 */
+	virtual void restart();
+
+	/*!
+	 * \brief Starts watching the performance of the applied pinning
+	 */
+	void startDriftDetection();
+
+	/*!
+	 * \brief Called after the performance monitor has been started for all pinned tasks
+	 *
+	 * The standard implementation does nothing. Subclasses can override it to start
+	 * additional monitors for the measurement.
+	 */
+	virtual void startMeasurement();
+
+	/*!
+	 * \brief Computes the result of the current pinning
+	 *
+	 * This method is called at the end of a measurement. The standard implementation
+	 * returns the average performance of the pinned tasks unchanged. Subclasses can
+	 * override it to combine it with other measurements. The result is compared
+	 * according to monitor_type.
+	 *
+	 * \param[in] performance The average performance of the pinned tasks per millisecond
+	 *
+	 * \return The result of the current pinning
+	 */
+	virtual double evaluatePinning(double performance);
+
+	/*!
+	 * \brief Determines whether bigger or smaller results of evaluatePinning() are better
+	 *
+	 * The standard implementation returns the type of the selected performance monitor.
+	 * The type is stored in monitor_type.
+	 *
+	 * \return The type of the results of the strategy
+	 */
+	virtual PerformanceMonitor::montype objectiveType();
+
+	/*!
+	 * \brief Computes the z-value of a two-sided confidence interval of the normal distribution
+	 *
+	 * \param[in] confidence The confidence level, e.g. 0.95
+	 *
+	 * \return The z-value, e.g. 1.96
+	 */
+	static double zValue(double confidence);
+
+	/*!
+	 * \brief Stops the performance monitor for all tasks monitored during the warmup time
+	 */
+	void stopWarmupMonitoring();
+
+	/*!
+	 * \brief Computes the average performance of some tasks since the last call
+	 *
+	 * The monitor values and times are stored in last_samples. If the values of the
+	 * monitor are not cumulative, the average of the current values is returned instead.
+	 *
+	 * \param[in] tids	The tasks which will be sampled
+	 * \param[in] now	The current time in milliseconds
+	 * \param[out] rate	The average performance of the tasks per millisecond
+	 *
+	 * \return False if none of the tasks had been sampled before
+	 */
+	bool readRate(const std::set<int> &tids, qint64 now, double &rate);
+
+	/*!
+	 * \brief Computes the fraction of the memory of the pinned tasks which is local to their cores
+	 *
+	 * Memory on any NUMA node of the cores a task is pinned to counts as local.
+	 *
+	 * \return The average fraction over all pinned tasks, 1 if no information is available
+	 */
+	double memoryLocality();
+
+	/*!
+	 * \brief Moves memory of the pinned tasks away from NUMA nodes which none of them runs on
+	 *
+	 * The memory is moved to the node on which most of the pinned tasks run.
+	 */
+	void migrateMemory();
+
+	/*!
+	 * \brief Returns all cpus used by the pinned tasks
+	 *
+	 * \return The set of cpus
+	 */
+	PinningHistory::autopin_cpuset pinnedCpus();
+
+	/*!
+	 * \brief Adjusts the result of a pinning for the frequencies and the throttling of its cpus
+	 *
+	 * If enabled, the result is normalized to the highest maximum frequency of all cpus
+	 * and made worse in proportion to the fraction of the cpus which have been throttled
+	 * or slow during the measurement.
+	 *
+	 * \param[in] performance The average rate of the tasks as measured by the performance monitor
+	 *
+	 * \return The adjusted result
+	 */
+	double adjustForFrequency(double performance);
+
 	/*!
 	 * Stores the pinnings
 	 */
@@ -161,6 +359,42 @@ class Main : public ControlStrategy {
 	 */
 	QTimer warmup_timer;
 
+	/*!
+	 * Interval between two samples of the performance monitor during the
+	 * warmup time in milliseconds. A value of 0 disables adaptive warmup.
+	 */
+	int warmup_interval;
+
+	/*!
+	 * Timer for sampling the performance monitor during the warmup time
+	 */
+	QTimer warmup_sample_timer;
+
+	/*!
+	 * Number of consecutive samples which have to agree for ending the warmup
+	 */
+	int warmup_window;
+
+	/*!
+	 * Maximum relative deviation of the samples in the window from their mean
+	 */
+	double warmup_tolerance;
+
+	/*!
+	 * Store the time when the warmup started
+	 */
+	Clock warmup_start;
+
+	/*!
+	 * Tasks which are monitored during the warmup time
+	 */
+	std::set<int> warmup_tasks;
+
+	/*!
+	 * Performance values of the most recent samples during the warmup time
+	 */
+	std::deque<double> warmup_rates;
+
 	/*!
 	 * Measure time
 	 */
@@ -182,6 +416,147 @@ class Main : public ControlStrategy {
 	 */
 	std::set<int> skip;
 
+	/*!
+	 * Interval between two samples of the performance monitor in
+	 * milliseconds. A value of 0 disables early termination.
+	 */
+	int sample_interval;
+
+	/*!
+	 * Timer for sampling the performance monitor
+	 */
+	QTimer sample_timer;
+
+	/*!
+	 * Minimum number of samples before a measurement is ended early
+	 */
+	int min_samples;
+
+	/*!
+	 * Confidence level used for early termination
+	 */
+	double confidence;
+
+	/*!
+	 * Relative half-width of the confidence interval at which a result
+	 * is considered precise enough
+	 */
+	double precision;
+
+	/*!
+	 * Performance values of the current pinning in each sample interval
+	 */
+	std::deque<double> samples;
+
+	/*!
+	 * Monitor values and times (in ms) of the pinned tasks at the last sample
+	 */
+	std::map<int, std::pair<double, qint64>> last_samples;
+
+	/*!
+	 * Weight of the remote memory accesses in the result of a pinning.
+	 * A value of 0 disables the memory locality feedback.
+	 */
+	double numa_weight;
+
+	/*!
+	 * Stores if memory is moved to the NUMA nodes of the pinned tasks
+	 */
+	bool numa_migrate;
+
+	/*!
+	 * NUMA node of every cpu
+	 */
+	std::map<int, int> cpu_nodes;
+
+	/*!
+	 * Interval between two samples of the cpu frequencies in milliseconds.
+	 * A value of 0 samples them only at the start and at the end of a measurement.
+	 */
+	int freq_interval;
+
+	/*!
+	 * Stores if results are normalized to the same frequency
+	 */
+	bool freq_normalize;
+
+	/*!
+	 * Fraction of its maximum frequency below which a cpu is considered slow.
+	 * A value of 0 disables the detection of slow cpus.
+	 */
+	double slow_threshold;
+
+	/*!
+	 * Weight of throttled and slow cpus in the result of a pinning. A
+	 * value of 0 disables the penalty.
+	 */
+	double throttle_weight;
+
+	/*!
+	 * Highest maximum frequency of all cpus in MHz
+	 */
+	double reference_freq;
+
+	/*!
+	 * Interval between two samples of the performance after the strategy has
+	 * finished in seconds. A value of 0 disables drift detection.
+	 */
+	int drift_interval;
+
+	/*!
+	 * Relative deviation from the result of the best pinning at which a sample
+	 * is considered worse
+	 */
+	double drift_threshold;
+
+	/*!
+	 * Number of consecutive worse samples after which the strategy starts tuning again
+	 */
+	int drift_window;
+
+	/*!
+	 * Minimum share of the measurement during which the counters of every task must have been running. Results
+	 * of multiplexed measurements below this share are not stored in the pinning history.
+	 */
+	double min_coverage;
+
+	/*!
+	 * Number of consecutive worse samples so far
+	 */
+	int drift_count;
+
+	/*!
+	 * Timer for sampling the performance after the strategy has finished
+	 */
+	QTimer drift_timer;
+
+	/*!
+	 * Average performance of the pinned tasks per millisecond of the best pinning, before
+	 * any adjustments of the result. A value of 0 means that the rate is not known.
+	 */
+	double best_rate;
+
+	/*!
+	 * Average performance of the pinned tasks per millisecond of the last measured pinning,
+	 * before any adjustments of the result
+	 */
+	double last_rate;
+
+	/*!
+	 * Timer for sampling the cpu frequencies
+	 */
+	QTimer freq_timer;
+
+	/*!
+	 * Sums of the sampled frequencies and the number of samples for every cpu
+	 */
+	std::map<int, std::pair<double, int>> freq_samples;
+
+	/*!
+	 * State of the cpus at the start of the measurement
+	 */
+	OSServices::autopin_cpu_states start_states;
+
 	/*!
 	 * Interval for phase notifications
 	 */
@@ -195,7 +570,7 @@ class Main : public ControlStrategy {
 	/*!
 	 * Store the time when the last pinning started
 	 */
-	QElapsedTimer measure_start;
+	Clock measure_start;
 
 	/*!
 	 * The performance monitor used by the strategy
@@ -212,6 +587,16 @@ class Main : public ControlStrategy {
 	 */
 	autopin_pinned_tasklist pinned_tasks;
 
+	/*!
+	 * Identities of the tasks to which the entries of the current pinning have been applied
+	 */
+	QStringList pinned_ids;
+
+	/*!
+	 * Tasks created during the measurement which have not been classified yet
+	 */
+	std::deque<created_task> created_tasks;
+
 	/*!
 	 * Stores if notifications about execution phases and
 	 * the creation/termination of tasks are currently enabled.
@@ -0,0 +1,153 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			// for AutopinContext
+#include <AutopinPlus/Configuration.h>			// for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>		// for ObservedProcess
+#include <AutopinPlus/OSServices.h>				// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		// for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			// for PinningHistory, etc
+#include <AutopinPlus/Strategy/Autopin1/Main.h> // for Main
+#include <qobjectdefs.h>						// for Q_OBJECT
+#include <qstring.h>							// for QString
+#include <vector>								// for vector
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bandit {
+
+/*!
+ * \brief A control strategy which treats the pinnings of the schedule as the arms of a multi-armed bandit.
+ *
+ * Instead of deciding after a single measurement per pinning, this strategy keeps measuring the pinnings, mostly the
+ * one which currently performs best, but every now and then also the others. The next pinning is either chosen by the
+ * upper confidence bound (UCB1) rule or by Thompson sampling. The mean, the number of measurements and the variance
+ * of every pinning are stored in the pinning history and used as prior knowledge when the history is loaded again.
+ * The warmup and measurement cycle is inherited from the autopin1 strategy.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  protected:
+	/*!
+	 * \brief Adds a result to the statistics of a pinning and stores them in the pinning history
+	 *
+	 * \param[in] pinning	The pinning which has been measured
+	 * \param[in] value	The performance value of the pinning
+	 * \return True if the pinning history feature is enabled and false otherwise.
+	 */
+	bool addPinningToHistory(PinningHistory::autopin_pinning pinning, double value) override;
+
+	// Overridden from base class
+	bool nextPinning(double result) override;
+
+	// Overridden from base class
+	void restart() override;
+
+  private:
+	/*!
+	 * \brief Statistics about the measurements of a single pinning
+	 */
+	struct arm {
+		//! The number of measurements
+		int samples = 0;
+		//! The mean of all measurements
+		double mean = 0;
+		//! The sum of the squared differences from the mean
+		double m2 = 0;
+		//! The number of measurements in this run, which have a known rate
+		int rate_samples = 0;
+		//! The mean rate of the monitor before any adjustments, see Autopin1::Main::best_rate
+		double rate = 0;
+	};
+
+	/*!
+	 * \brief Returns the mean of a pinning, negated if smaller values are better.
+	 *
+	 * \param[in] index The index of the pinning
+	 *
+	 * \return The score of the pinning, bigger is always better.
+	 */
+	double score(int index);
+
+	/*!
+	 * \brief Returns the pooled standard deviation of all measurements.
+	 *
+	 * \return The standard deviation, or a tenth of the biggest absolute mean if it cannot be estimated yet.
+	 */
+	double deviation();
+
+	/*!
+	 * \brief Returns a sample from the standard normal distribution.
+	 *
+	 * \return The sample.
+	 */
+	static double gaussian();
+
+	/*!
+	 * \brief The statistics of all pinnings, in the same order as the schedule.
+	 */
+	std::vector<arm> arms;
+
+	/*!
+	 * \brief The policy used for selecting the next pinning, either "ucb" or "thompson".
+	 */
+	QString policy = "ucb";
+
+	/*!
+	 * \brief The weight of the exploration term of the UCB1 rule.
+	 */
+	double exploration = 1.0;
+
+	/*!
+	 * \brief The maximum number of measurements, 0 means that the strategy never stops.
+	 */
+	int rounds = 0;
+
+	/*!
+	 * \brief The number of measurements done so far.
+	 */
+	int measurements = 0;
+};
+
+} // namespace Bandit
+} // namespace Strategy
+} // namespace AutopinPlus
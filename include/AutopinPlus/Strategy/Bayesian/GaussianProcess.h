@@ -0,0 +1,158 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/PinningHistory.h> // for PinningHistory, etc
+#include <utility>						// for pair
+#include <vector>						// for vector
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bayesian {
+
+/*!
+ * \brief A Gaussian process regression model over pinnings.
+ *
+ * The model is used as the surrogate of the Bayesian strategy. Two pinnings are considered similar if they place
+ * many threads on the same cores, so the covariance of two pinnings decays exponentially with the share of threads
+ * which are placed differently (i.e. with their normalized Hamming distance). Bigger observed values are considered
+ * "better".
+ */
+class GaussianProcess {
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] length_scale The length scale of the kernel. Smaller values make the model assume that the
+	 *                         performance changes quickly when threads are moved.
+	 * \param[in] noise        The variance of the measurement noise relative to the variance of the observations.
+	 */
+	GaussianProcess(double length_scale = 0.5, double noise = 0.1);
+
+	/*!
+	 * \brief Adds an observation to the model.
+	 *
+	 * \param[in] pinning The pinning which has been measured.
+	 * \param[in] value   The measured value. Bigger values are considered "better".
+	 */
+	void addObservation(const PinningHistory::autopin_pinning &pinning, double value);
+
+	/*!
+	 * \brief Checks if a pinning has already been observed.
+	 *
+	 * \param[in] pinning The pinning to look for.
+	 *
+	 * \return True if the pinning has already been passed to addObservation().
+	 */
+	bool contains(const PinningHistory::autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Predicts the value of a pinning.
+	 *
+	 * \param[in] pinning The pinning for which the value shall be predicted.
+	 *
+	 * \return A pair containing the posterior mean and standard deviation in the units of the observations.
+	 */
+	std::pair<double, double> predict(const PinningHistory::autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Calculates the expected improvement of a pinning over the best observation.
+	 *
+	 * \param[in] pinning The pinning to be evaluated.
+	 *
+	 * \return The expected improvement in the units of the observations.
+	 */
+	double expectedImprovement(const PinningHistory::autopin_pinning &pinning) const;
+
+	/*!
+	 * \brief Returns the best observation.
+	 *
+	 * \return The pinning with the biggest observed value and that value. If there are no observations, the pinning
+	 *         will be empty.
+	 */
+	PinningHistory::pinning_result getBest() const;
+
+	/*!
+	 * \brief Returns the number of observations.
+	 *
+	 * \return The number of observations added to the model.
+	 */
+	int size() const;
+
+  private:
+	/*!
+	 * \brief The covariance function of the model.
+	 *
+	 * \param[in] a The first pinning.
+	 * \param[in] b The second pinning.
+	 *
+	 * \return The prior correlation between the values of the two pinnings.
+	 */
+	double kernel(const PinningHistory::autopin_pinning &a, const PinningHistory::autopin_pinning &b) const;
+
+	/*!
+	 * \brief Recomputes the Cholesky factor and the weights after a new observation has been added.
+	 */
+	void fit();
+
+	/*!
+	 * The length scale of the kernel.
+	 */
+	double length_scale;
+
+	/*!
+	 * The relative variance of the measurement noise.
+	 */
+	double noise;
+
+	/*!
+	 * The observed pinnings.
+	 */
+	std::vector<PinningHistory::autopin_pinning> inputs;
+
+	/*!
+	 * The observed values.
+	 */
+	std::vector<double> outputs;
+
+	/*!
+	 * The mean of the observed values used for normalization.
+	 */
+	double mean = 0;
+
+	/*!
+	 * The standard deviation of the observed values used for normalization.
+	 */
+	double deviation = 1;
+
+	/*!
+	 * The lower triangular Cholesky factor of the covariance matrix of the observations (row-major).
+	 */
+	std::vector<double> cholesky;
+
+	/*!
+	 * The weights of the observations, i.e. the inverse covariance matrix times the normalized observations.
+	 */
+	std::vector<double> alpha;
+}; // class GaussianProcess
+
+} // namespace Bayesian
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>						 // for AutopinContext
+#include <AutopinPlus/Configuration.h>						 // for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>					 // for ObservedProcess
+#include <AutopinPlus/OSServices.h>							 // for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>					 // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>						 // for PinningHistory, etc
+#include <AutopinPlus/PinningSpace.h>						 // for PinningSpace
+#include <AutopinPlus/Strategy/Autopin1/Main.h>				 // for Main
+#include <AutopinPlus/Strategy/Bayesian/GaussianProcess.h> // for GaussianProcess
+#include <qobjectdefs.h>									 // for Q_OBJECT
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bayesian {
+
+/*!
+ * \brief A control strategy which searches the pinning space using Bayesian optimization.
+ *
+ * Instead of walking through a fixed schedule, this strategy fits a Gaussian process to the results measured so far
+ * and always tests the pinning with the highest expected improvement next. The warmup and measurement cycle is
+ * inherited from the autopin1 strategy.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  protected:
+	// Overridden from base class
+	bool nextPinning(double result) override;
+
+	// Overridden from base class
+	void restart() override;
+
+  private:
+	/*!
+	 * \brief Selects the unmeasured candidate with the highest expected improvement.
+	 *
+	 * \param[out] result The selected pinning.
+	 *
+	 * \return False if no unmeasured candidate could be found.
+	 */
+	bool suggestPinning(PinningHistory::autopin_pinning &result);
+
+	/*!
+	 * \brief The surrogate model fitted to the results measured so far.
+	 */
+	GaussianProcess model;
+
+	/*!
+	 * \brief The pinnings which may be tested.
+	 */
+	PinningSpace space;
+
+	/*!
+	 * \brief The number of pinnings in the initial design, the model appends its suggestions after them.
+	 */
+	size_t design = 0;
+
+	/*!
+	 * \brief The maximum number of pinnings which will be measured.
+	 */
+	int budget = 20;
+
+	/*!
+	 * \brief The number of random pinnings measured before the model is used, unless a schedule has been configured.
+	 */
+	int init_samples = 3;
+
+	/*!
+	 * \brief The number of candidate pinnings which are evaluated by the model when selecting the next pinning.
+	 */
+	int candidates = 1000;
+
+	/*!
+	 * \brief The length scale of the model.
+	 */
+	double length_scale = 0.5;
+
+	/*!
+	 * \brief The relative noise of the model.
+	 */
+	double noise = 0.1;
+};
+
+} // namespace Bayesian
+} // namespace Strategy
+} // namespace AutopinPlus
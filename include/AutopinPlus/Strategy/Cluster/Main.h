@@ -0,0 +1,137 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			   // for AutopinContext
+#include <AutopinPlus/Configuration.h>			   // for Configuration, etc
+#include <AutopinPlus/ControlStrategy.h>		   // for ControlStrategy
+#include <AutopinPlus/Monitor/MemShare/Main.h>	 // for Main, Main::affinity_graph
+#include <AutopinPlus/ObservedProcess.h>		   // for ObservedProcess
+#include <AutopinPlus/OSServices.h>				   // for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		   // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			   // for PinningHistory
+#include <functional>							   // for function
+#include <qlist.h>								   // for QList
+#include <qobjectdefs.h>						   // for slots, Q_OBJECT
+#include <vector>								   // for vector
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Cluster {
+
+/*!
+ * \brief A control strategy which places threads sharing data on processors sharing caches.
+ *
+ * After the init time, the memory accesses of all threads are sampled with a memshare performance monitor for the
+ * configured profile time. The resulting affinity graph is then partitioned onto the last level caches of the system,
+ * and the threads of every cache onto its cores, so that heavily communicating threads end up sharing as many caches
+ * as possible.
+ */
+class Main : public ControlStrategy {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  public slots:
+	// Overridden from base class
+	void slot_autopinReady() override;
+
+	/*!
+	 * \brief Starts sampling the memory accesses of all threads
+	 */
+	void slot_startProfiling();
+
+	/*!
+	 * \brief Stops sampling and pins the threads according to the affinity graph
+	 */
+	void slot_stopProfiling();
+
+  private:
+	/*!
+	 * \brief Computes a pinning for the current tasks from an affinity graph.
+	 *
+	 * \param[in] graph The affinity graph of the tasks.
+	 *
+	 * \return The processor for every task, in the order of the tasks.
+	 */
+	PinningHistory::autopin_pinning computePinning(const Monitor::MemShare::Main::affinity_graph &graph);
+
+	/*!
+	 * \brief Greedily partitions items into groups of limited size.
+	 *
+	 * The items are placed in order of decreasing total weight, each into the group with free capacity to whose
+	 * members it has the biggest total weight. Ties are broken in favour of the group with the most free capacity.
+	 *
+	 * \param[in] items      The items to be partitioned.
+	 * \param[in] capacities The maximum number of items in every group.
+	 * \param[in] weight     The weight between two items.
+	 *
+	 * \return The group of every item.
+	 */
+	static std::vector<int> partition(const std::vector<int> &items, std::vector<int> capacities,
+									  const std::function<double(int, int)> &weight);
+
+	/*!
+	 * \brief The monitor used for sampling the memory accesses.
+	 */
+	Monitor::MemShare::Main *monitor = nullptr;
+
+	/*!
+	 * \brief The processors which may be used.
+	 */
+	QList<int> cpus;
+
+	/*!
+	 * \brief The time in seconds before the profiling starts.
+	 */
+	int init_time = 15;
+
+	/*!
+	 * \brief The time in seconds during which the memory accesses are sampled.
+	 */
+	int profile_time = 10;
+
+	/*!
+	 * \brief Whether threads may share a core if there are enough cores for all of them.
+	 */
+	bool smt = true;
+};
+
+} // namespace Cluster
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -0,0 +1,178 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			// for AutopinContext
+#include <AutopinPlus/Configuration.h>			// for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>		// for ObservedProcess
+#include <AutopinPlus/OSServices.h>				// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		// for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			// for PinningHistory, etc
+#include <AutopinPlus/PinningSpace.h>			// for PinningSpace
+#include <AutopinPlus/Strategy/Autopin1/Main.h> // for Main
+#include <map>									// for map
+#include <qobjectdefs.h>						// for Q_OBJECT
+#include <vector>								// for vector
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Genetic {
+
+/*!
+ * \brief A control strategy which evolves a population of pinnings.
+ *
+ * Every generation, new pinnings are bred from the population by crossover (every socket is inherited from one of
+ * the two parents) and mutation (two threads swapped or one thread moved to an unused processor). After the new
+ * pinnings have been measured, the best pinnings of the population and the new pinnings form the next population.
+ * The population is marked in the pinning history, so that the search continues where it left off when the same
+ * program is run again with the same history. The warmup and measurement cycle is inherited from the autopin1
+ * strategy.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  protected:
+	// Overridden from base class
+	bool nextPinning(double result) override;
+
+	// Overridden from base class
+	void restart() override;
+
+  private:
+	/*!
+	 * \brief Fills the list of pinnings with new pinnings bred from the population.
+	 *
+	 * Pinnings which have already been measured are not bred again. If no new pinning can be found, the best pinning
+	 * of the population is measured again.
+	 */
+	void breed();
+
+	/*!
+	 * \brief Selects a member of the population by a tournament between two random members.
+	 *
+	 * \return The better of the two members.
+	 */
+	const PinningHistory::autopin_pinning &select() const;
+
+	/*!
+	 * \brief Combines two pinnings.
+	 *
+	 * Every thread takes its processors from the first parent if they are located on one of a random subset of the
+	 * sockets and from the second parent otherwise. Threads which would share a processor with another thread are
+	 * moved to an unused processor.
+	 *
+	 * \param[in] a The first parent
+	 * \param[in] b The second parent
+	 *
+	 * \return The new pinning.
+	 */
+	PinningHistory::autopin_pinning crossover(const PinningHistory::autopin_pinning &a,
+											  const PinningHistory::autopin_pinning &b) const;
+
+	/*!
+	 * \brief Replaces the population by the best pinnings of the population and the measured pinnings.
+	 *
+	 * The membership of every pinning is stored in the pinning history.
+	 */
+	void survive();
+
+	/*!
+	 * \brief Converts a result of the performance monitor to a score where bigger is better.
+	 *
+	 * \param[in] result The result
+	 *
+	 * \return The score.
+	 */
+	double toScore(double result) const;
+
+	/*!
+	 * \brief The pinnings which may be tested.
+	 */
+	PinningSpace space;
+
+	/*!
+	 * \brief The socket of every processor, empty if the topology is not known.
+	 */
+	std::map<int, int> sockets;
+
+	/*!
+	 * \brief The current population.
+	 */
+	std::vector<PinningHistory::autopin_pinning> population;
+
+	/*!
+	 * \brief The scores of all measured pinnings.
+	 */
+	std::map<PinningHistory::autopin_pinning, double> scores;
+
+	/*!
+	 * \brief The number of pinnings in the population.
+	 */
+	int population_size = 8;
+
+	/*!
+	 * \brief The number of new pinnings in every generation.
+	 */
+	int offspring = 4;
+
+	/*!
+	 * \brief The probability that a new pinning is mutated.
+	 */
+	double mutation = 0.2;
+
+	/*!
+	 * \brief The number of generations in this run, 0 means that the search never stops.
+	 */
+	int generations = 2;
+
+	/*!
+	 * \brief The number of the current generation, counted over all runs.
+	 */
+	int generation = 0;
+
+	/*!
+	 * \brief The number of generations completed in this run.
+	 */
+	int completed = 0;
+};
+
+} // namespace Genetic
+} // namespace Strategy
+} // namespace AutopinPlus
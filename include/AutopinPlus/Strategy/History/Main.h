@@ -95,11 +95,15 @@ class Main : public ControlStrategy {
 	 *
 	 * The pinning provided in the argument is applied
 	 * by setting the affinity for the corresponding tasks.
+	 * Tasks whose identity is stored for an entry of the
+	 * pinning are pinned according to this entry.
 	 *
 	 * \param [in] pinning The pinning which shall be applied.
+	 * \param [in] ids The identities of the tasks for the entries
+	 * 	of the pinning. May be empty.
 	 *
 	 */
-	void applyPinning(PinningHistory::autopin_pinning pinning);
+	void applyPinning(PinningHistory::autopin_pinning pinning, const QStringList &ids);
 
 	/*!
 	 * \brief Determines if all pinned tasks are still running
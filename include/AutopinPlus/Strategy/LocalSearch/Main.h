@@ -0,0 +1,119 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			// for AutopinContext
+#include <AutopinPlus/Configuration.h>			// for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>		// for ObservedProcess
+#include <AutopinPlus/OSServices.h>				// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		// for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			// for PinningHistory, etc
+#include <AutopinPlus/PinningSpace.h>			// for PinningSpace
+#include <AutopinPlus/Strategy/Autopin1/Main.h> // for Main
+#include <qobjectdefs.h>						// for Q_OBJECT
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace LocalSearch {
+
+/*!
+ * \brief A control strategy which keeps improving the pinning while the observed process is running.
+ *
+ * Starting from the best pinning in the history, the first pinning of the schedule or a random pinning, this strategy
+ * repeatedly measures a neighbour of the current pinning (two threads swapped or one thread moved to an unused
+ * processor) and keeps it only if it performs better. The current pinning is measured again at regular intervals so
+ * that changes in the behaviour of the observed process are taken into account. The warmup and measurement cycle is
+ * inherited from the autopin1 strategy.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  protected:
+	// Overridden from base class
+	bool nextPinning(double result) override;
+
+	// Overridden from base class
+	void restart() override;
+
+  private:
+	/*!
+	 * \brief The pinnings which may be tested.
+	 */
+	PinningSpace space;
+
+	/*!
+	 * \brief The best pinning found so far.
+	 */
+	PinningHistory::autopin_pinning incumbent;
+
+	/*!
+	 * \brief The most recent result of the best pinning, negated if smaller values are better.
+	 */
+	double incumbent_score = 0;
+
+	/*!
+	 * \brief The relative improvement which is necessary for accepting a move.
+	 */
+	double threshold = 0;
+
+	/*!
+	 * \brief The number of moves after which the best pinning is measured again, 0 disables remeasuring.
+	 */
+	int remeasure = 10;
+
+	/*!
+	 * \brief The number of moves since the best pinning has been measured the last time.
+	 */
+	int moves = 0;
+
+	/*!
+	 * \brief The maximum number of measurements, 0 means that the search never stops.
+	 */
+	int iterations = 0;
+
+	/*!
+	 * \brief The number of measurements done so far.
+	 */
+	int measurements = 0;
+};
+
+} // namespace LocalSearch
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -92,6 +92,11 @@ class Main : public ControlStrategy {
 	 */
 	int interval = 100;
 
+	/*!
+	 * \brief Stores if the monitors have been started for the initial tasks of the process.
+	 */
+	bool started = false;
+
 	/*!
 	 * \brief Mutex which prevents two threads from updating the monitors at the same time.
 	 */
@@ -0,0 +1,157 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			// for AutopinContext
+#include <AutopinPlus/Configuration.h>			// for Configuration, etc
+#include <AutopinPlus/ObservedProcess.h>		// for ObservedProcess
+#include <AutopinPlus/OSServices.h>				// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		// for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			// for PinningHistory
+#include <AutopinPlus/Strategy/Autopin1/Main.h> // for Main
+#include <map>									// for map
+#include <qobjectdefs.h>						// for Q_OBJECT
+#include <qstring.h>							// for QString
+#include <utility>								// for pair
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Pareto {
+
+/*!
+ * \brief A control strategy which trades performance against energy.
+ *
+ * Every pinning of the schedule is measured with a performance monitor and an energy monitor at the same time. From
+ * both values the delay (time per unit of work) and the energy per unit of work are derived, which are combined into
+ * a single objective: the energy-delay product, the energy-delay-squared product or a weighted sum relative to the
+ * first pinning. The pinning with the smallest objective is applied at the end. The delay, the energy and whether a
+ * pinning is on the Pareto front of all measured pinnings are stored in the pinning history. The warmup and
+ * measurement cycle is inherited from the autopin1 strategy.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+	// Overridden from base class
+	Configuration::configopts getConfigOpts() override;
+
+  public slots:
+	void slot_PhaseChanged(int newphase) override;
+
+  protected:
+	// Overridden from base class
+	void startMeasurement() override;
+
+	// Overridden from base class
+	double evaluatePinning(double performance) override;
+
+	// Overridden from base class
+	PerformanceMonitor::montype objectiveType() override;
+
+	// Overridden from base class
+	void finish() override;
+
+	// Overridden from base class
+	void restart() override;
+
+  private:
+	/*!
+	 * \brief Finds a performance monitor by its name.
+	 *
+	 * \param[in] name The name of the monitor.
+	 *
+	 * \return The monitor, or nullptr if there is no such monitor.
+	 */
+	PerformanceMonitor *findMonitor(const QString &name);
+
+	/*!
+	 * \brief Determines whether a pinning is dominated by another measured pinning.
+	 *
+	 * \param[in] index The index of the pinning in the schedule.
+	 *
+	 * \return True if another pinning is at least as good in delay and energy and better in one of them.
+	 */
+	bool dominated(int index);
+
+	/*!
+	 * \brief Stores the delay, the energy and the Pareto front membership of all measured pinnings in the history.
+	 */
+	void storePoints();
+
+	/*!
+	 * \brief Discards the running measurement of the energy monitor.
+	 */
+	void clearEnergyMonitor();
+
+	/*!
+	 * \brief The monitor measuring the energy consumption.
+	 */
+	PerformanceMonitor *energy_monitor = nullptr;
+
+	/*!
+	 * \brief The type of the performance monitor, needed for converting its values to a delay.
+	 */
+	PerformanceMonitor::montype performance_type = PerformanceMonitor::UNKNOWN;
+
+	/*!
+	 * \brief The task for which the energy monitor has been started.
+	 */
+	int energy_tid = -1;
+
+	/*!
+	 * \brief The objective, either "edp", "ed2p" or "weighted".
+	 */
+	QString objective = "edp";
+
+	/*!
+	 * \brief The weight of the delay in the weighted objective, the energy has the weight 1 - weight.
+	 */
+	double weight = 0.5;
+
+	/*!
+	 * \brief The delay and the energy per unit of work of the first measured pinning.
+	 */
+	std::pair<double, double> reference = std::make_pair(0.0, 0.0);
+
+	/*!
+	 * \brief The delay and the energy per unit of work of every measured pinning, by index in the schedule.
+	 */
+	std::map<int, std::pair<double, double>> points;
+};
+
+} // namespace Pareto
+} // namespace Strategy
+} // namespace AutopinPlus
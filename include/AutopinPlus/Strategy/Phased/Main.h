@@ -0,0 +1,110 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <AutopinPlus/AutopinContext.h>			// for AutopinContext
+#include <AutopinPlus/Configuration.h>			// for Configuration
+#include <AutopinPlus/ObservedProcess.h>		// for ObservedProcess
+#include <AutopinPlus/OSServices.h>				// for OSServices
+#include <AutopinPlus/PerformanceMonitor.h>		// for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>			// for PinningHistory
+#include <AutopinPlus/Strategy/Autopin1/Main.h> // for Main
+#include <map>									// for map
+#include <qobjectdefs.h>						// for Q_OBJECT, slots
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Phased {
+
+/*!
+ * \brief A control strategy which tunes every execution phase of the observed process separately.
+ *
+ * Every phase announced via the communication channel walks through the schedule on its own. When the phase changes,
+ * the progress of the old phase is kept and the new phase continues where it left off. Once all pinnings have been
+ * tested for a phase, its best pinning is applied immediately whenever the phase is entered again. Phases for which
+ * the pinning history already contains results for all pinnings of the schedule are not tuned again.
+ */
+class Main : public Autopin1::Main {
+	Q_OBJECT
+
+  public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param[in] config    Pointer to the instance of the Configuration class to use
+	 * \param[in] proc      Pointer to the instance of the ObservedProcess class to use
+	 * \param[in] service   Pointer to the instance of the OSServices class to use
+	 * \param[in] monitors  Reference to the list of performance monitors to use
+	 * \param[in] history   Pointer to the instance of the PinningHistory class to use
+	 * \param[in] context   Reference to the instance of the AutopinContext class to use
+	 */
+	Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		 const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context);
+
+	// Overridden from base class
+	void init() override;
+
+  public slots:
+	// Overridden from base class
+	void slot_PhaseChanged(int newphase) override;
+
+	/*!
+	 * \brief Continues tuning the current phase or applies its best pinning
+	 */
+	void slot_enterPhase();
+
+  protected:
+	// Overridden from base class
+	bool nextPinning(double result) override;
+
+	// Overridden from base class
+	void finish() override;
+
+  private:
+	/*!
+	 * \brief The tuning progress of a single phase
+	 */
+	struct phase_state {
+		//! The index of the next pinning which will be tested
+		int next = 0;
+		//! The index of the best pinning, -1 if no pinning has been tested yet
+		int best = -1;
+		//! The performance value of the best pinning
+		double best_performance = 0;
+	};
+
+	/*!
+	 * \brief Returns the state of a phase, initializing it from the pinning history if necessary.
+	 *
+	 * \param[in] phase The phase
+	 *
+	 * \return Reference to the state of the phase
+	 */
+	phase_state &getPhaseState(int phase);
+
+	/*!
+	 * \brief The tuning progress of all phases seen so far.
+	 */
+	std::map<int, phase_state> phases;
+};
+
+} // namespace Phased
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -0,0 +1,459 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Arbiter.h>
+
+#include <AutopinPlus/Error.h> // for REPORTV, CHECK_ERRORV
+#include <algorithm>		   // for max, sort
+#include <cmath>			   // for fabs
+#include <map>				   // for map
+#include <QStringList>		   // for QStringList
+
+namespace AutopinPlus {
+
+Arbiter::Arbiter(Configuration *config, OSServices *service, const AutopinContext &context)
+	: config(config), service(service), context(context) {
+	connect(&timer, SIGNAL(timeout()), this, SLOT(slot_rebalance()));
+}
+
+void Arbiter::addApplication(QString name, Configuration *config, SharedOSServices *share) {
+	application app;
+	app.name = name;
+	app.config = config;
+	app.share = share;
+	app.proc = nullptr;
+	app.monitor = nullptr;
+	app.weight = 1;
+	app.min_cores = 1;
+	app.reference = 0;
+	app.best = 0;
+	app.performance = 0;
+	app.active = true;
+	applications.push_back(app);
+}
+
+void Arbiter::init() {
+	context.enableIndentation();
+	context.info("> Initializing the arbiter");
+
+	if (config->configOptionExists("Arbiter.objective") > 0) {
+		QString objective_str = config->getConfigOption("Arbiter.objective");
+		if (objective_str == "throughput")
+			objective = THROUGHPUT;
+		else if (objective_str == "slowdown")
+			objective = SLOWDOWN;
+		else if (objective_str == "none")
+			objective = NONE;
+		else
+			REPORTV(Error::BAD_CONFIG, "option_format", "Invalid objective: " + objective_str);
+	}
+
+	if (config->configOptionExists("Arbiter.interval") > 0)
+		interval = config->getConfigOptionInt("Arbiter.interval");
+
+	if (config->configOptionExists("Arbiter.threshold") > 0)
+		threshold = config->getConfigOptionDouble("Arbiter.threshold");
+
+	if (interval <= 0) REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid interval: " + QString::number(interval));
+	if (threshold < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid threshold: " + QString::number(threshold));
+
+	for (auto &app : applications) {
+		if (app.config->configOptionExists("weight") > 0) app.weight = app.config->getConfigOptionDouble("weight");
+		if (app.config->configOptionExists("min_cores") > 0)
+			app.min_cores = app.config->getConfigOptionInt("min_cores");
+		if (app.config->configOptionExists("reference") > 0)
+			app.reference = app.config->getConfigOptionDouble("reference");
+
+		if (app.weight <= 0)
+			REPORTV(Error::BAD_CONFIG, "invalid_value",
+					"Invalid weight for application " + app.name + ": " + QString::number(app.weight));
+		if (app.min_cores < 1)
+			REPORTV(Error::BAD_CONFIG, "invalid_value",
+					"Invalid minimum number of cores for application " + app.name + ": " +
+						QString::number(app.min_cores));
+		if (app.reference < 0)
+			REPORTV(Error::BAD_CONFIG, "invalid_value",
+					"Invalid reference for application " + app.name + ": " + QString::number(app.reference));
+	}
+
+	// Group the cpus by physical core, neighbouring cores share a socket
+	OSServices::autopin_topology topology;
+	CHECK_ERRORV(topology = service->getTopology());
+
+	std::map<std::pair<int, int>, QList<int>> core_map;
+	for (const auto &cpu : topology) core_map[std::make_pair(cpu.socket, cpu.core)].push_back(cpu.cpu);
+	for (const auto &core : core_map) cores.push_back(core.second);
+
+	// Split the cores according to the weights, but give every application at least its minimal number of cores
+	double total_weight = 0;
+	int total_cores = 0;
+	for (const auto &app : applications) {
+		total_weight += app.weight;
+		total_cores += app.min_cores;
+	}
+
+	if (total_cores > cores.size()) {
+		context.report(Error::BAD_CONFIG, "inconsistent",
+					   "The applications need " + QString::number(total_cores) + " cores, but there are only " +
+						   QString::number(cores.size()));
+		return;
+	}
+
+	QList<double> targets;
+	QList<int> counts;
+	int assigned = 0;
+	for (const auto &app : applications) {
+		targets.push_back(cores.size() * app.weight / total_weight);
+		counts.push_back(std::max(app.min_cores, (int)targets.back()));
+		assigned += counts.back();
+	}
+
+	while (assigned != cores.size()) {
+		int best = -1;
+		for (int i = 0; i < applications.size(); i++) {
+			if (assigned > cores.size()) {
+				if (counts[i] <= applications[i].min_cores) continue;
+				if (best == -1 || counts[i] - targets[i] > counts[best] - targets[best]) best = i;
+			} else {
+				if (best == -1 || targets[i] - counts[i] > targets[best] - counts[best]) best = i;
+			}
+		}
+
+		counts[best] += (assigned > cores.size()) ? -1 : 1;
+		assigned += (assigned > cores.size()) ? -1 : 1;
+	}
+
+	int next_core = 0;
+	for (int i = 0; i < applications.size(); i++) {
+		for (int j = 0; j < counts[i]; j++) applications[i].cores.push_back(next_core++);
+		applyShare(applications[i]);
+
+		QStringList cpus;
+		for (int cpu : applications[i].share->getShare()) cpus.push_back(QString::number(cpu));
+		context.info("  :: Application " + applications[i].name + ": " + QString::number(counts[i]) +
+					 " cores (cpus " + cpus.join(",") + ")");
+	}
+
+	switch (objective) {
+	case THROUGHPUT:
+		context.info("  :: Maximizing the weighted throughput every " + QString::number(interval) + " s");
+		break;
+	case SLOWDOWN:
+		context.info("  :: Minimizing the weighted slowdown every " + QString::number(interval) + " s");
+		break;
+	case NONE:
+		context.info("  :: Shares are not rebalanced");
+		break;
+	}
+
+	context.disableIndentation();
+}
+
+void Arbiter::observe(QString name, ObservedProcess *proc, PerformanceMonitor *monitor) {
+	application *app = findApplication(name);
+	if (app == nullptr) return;
+
+	app->proc = proc;
+	app->monitor = monitor;
+
+	if (objective == NONE) return;
+
+	switch (monitor->getValType()) {
+	case PerformanceMonitor::montype::MAX:
+		break;
+	case PerformanceMonitor::montype::MIN:
+		// Smaller rates are better, so the performance is the inverse rate
+		if (app->reference > 0) app->reference = 1 / app->reference;
+		break;
+	default:
+		REPORTV(Error::UNSUPPORTED, "critical",
+				"The arbiter cannot use the performance monitor " + monitor->getName() + " of unknown type");
+	}
+}
+
+void Arbiter::removeApplication(QString name) {
+	application *app = findApplication(name);
+	if (app == nullptr || !app->active) return;
+
+	context.enableIndentation();
+	context.info("> Application " + name + " has terminated");
+
+	app->active = false;
+	if (app->monitor != nullptr) app->monitor->clear();
+
+	// The performance of the remaining applications has to be measured again
+	pending_move = std::make_pair(-1, -1);
+	rejected_moves.clear();
+
+	// Give the cores to the applications with the fewest cores per weight
+	QList<int> receivers;
+	while (!app->cores.empty()) {
+		int best = -1;
+		for (int i = 0; i < applications.size(); i++) {
+			if (!applications[i].active) continue;
+			if (best == -1 ||
+				applications[i].cores.size() / applications[i].weight <
+					applications[best].cores.size() / applications[best].weight)
+				best = i;
+		}
+
+		if (best == -1) break;
+
+		applications[best].cores.push_back(app->cores.takeLast());
+		if (!receivers.contains(best)) receivers.push_back(best);
+	}
+
+	for (int i : receivers) applyShare(applications[i]);
+
+	if (receivers.empty())
+		timer.stop();
+	else
+		context.info("  :: New shares: " + sharesString());
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Arbiter::getConfigOpts() {
+	Configuration::configopts result;
+
+	QStringList objectives;
+	objectives << "throughput"
+			   << "slowdown"
+			   << "none";
+
+	result.push_back(Configuration::configopt("Arbiter.objective", QStringList(objectives[objective])));
+	result.push_back(Configuration::configopt("Arbiter.interval", QStringList(QString::number(interval))));
+	result.push_back(Configuration::configopt("Arbiter.threshold", QStringList(QString::number(threshold))));
+
+	for (const auto &app : applications) {
+		result.push_back(Configuration::configopt(app.name + ".weight", QStringList(QString::number(app.weight))));
+		result.push_back(
+			Configuration::configopt(app.name + ".min_cores", QStringList(QString::number(app.min_cores))));
+	}
+
+	return result;
+}
+
+void Arbiter::slot_autopinReady() {
+	CHECK_ERRORV(startMeasurement());
+	timer.start(interval * 1000);
+}
+
+void Arbiter::slot_rebalance() {
+	// Only the termination of traced processes is reported, the others are removed by the slot connected to the signal
+	bool active = false;
+	for (int i = 0; i < applications.size(); i++) {
+		const application &app = applications[i];
+		if (app.active && app.proc != nullptr && !app.proc->getTrace() && !service->isRunning(app.proc->getPid()))
+			emit sig_ProcessTerminated(app.proc->getPid());
+		if (applications[i].active) active = true;
+	}
+	if (!active) return;
+
+	context.enableIndentation();
+	context.info("> Rebalancing the applications");
+
+	CHECK_ERRORV(stopMeasurement());
+
+	if (objective != NONE) {
+		QList<double> performance;
+		for (const auto &app : applications) performance.push_back(app.performance);
+
+		if (pending_move.first != -1) {
+			// Keep the last move only if it has improved the objective
+			double before = evaluate(pending_performance), after = evaluate(performance);
+			QString from = applications[pending_move.first].name, to = applications[pending_move.second].name;
+
+			if (after - before < threshold * std::fabs(before)) {
+				context.info("  :: Moving a core from " + from + " to " + to + " didn't improve the objective (" +
+							 QString::number(before) + " -> " + QString::number(after) + "), reverting");
+				moveCore(pending_move.second, pending_move.first);
+				rejected_moves.insert(pending_move);
+			} else {
+				context.info("  :: Moving a core from " + from + " to " + to + " improved the objective (" +
+							 QString::number(before) + " -> " + QString::number(after) + ")");
+				rejected_moves.clear();
+			}
+
+			pending_move = std::make_pair(-1, -1);
+		} else {
+			// Try to move a core from the application with the best to the one with the worst normalized performance
+			QList<std::pair<double, int>> ranking;
+			for (int i = 0; i < applications.size(); i++) {
+				const application &app = applications[i];
+				if (!app.active) continue;
+				double reference = (app.reference > 0) ? app.reference : app.best;
+				double normalized = (reference > 0) ? app.performance / reference : 1;
+				ranking.push_back(std::make_pair(normalized / app.weight, i));
+			}
+			std::sort(ranking.begin(), ranking.end());
+
+			std::pair<int, int> move(-1, -1);
+			for (int d = ranking.size() - 1; d >= 0 && move.first == -1; d--) {
+				int from = ranking[d].second;
+				if (applications[from].cores.size() <= applications[from].min_cores) continue;
+
+				for (int r = 0; r < ranking.size(); r++) {
+					int to = ranking[r].second;
+					if (to == from || rejected_moves.count(std::make_pair(from, to)) > 0) continue;
+					move = std::make_pair(from, to);
+					break;
+				}
+			}
+
+			if (move.first != -1) {
+				context.info("  :: Moving a core from " + applications[move.first].name + " to " +
+							 applications[move.second].name);
+				pending_performance = performance;
+				pending_move = move;
+				moveCore(move.first, move.second);
+			} else {
+				// All moves have been tried, start over in the next interval
+				rejected_moves.clear();
+			}
+		}
+
+		context.info("  :: Shares: " + sharesString());
+	}
+
+	CHECK_ERRORV(startMeasurement());
+
+	context.disableIndentation();
+}
+
+Arbiter::application *Arbiter::findApplication(const QString &name) {
+	for (auto &app : applications)
+		if (app.name == name) return &app;
+
+	return nullptr;
+}
+
+void Arbiter::applyShare(application &app) {
+	// Number the cpus like Linux does: first one cpu of every core, then the next one
+	QList<int> cpus;
+	for (int level = 0;; level++) {
+		bool found = false;
+		for (int core : app.cores) {
+			if (level >= cores[core].size()) continue;
+			cpus.push_back(cores[core][level]);
+			found = true;
+		}
+		if (!found) break;
+	}
+
+	app.share->setShare(cpus);
+
+	if (app.proc != nullptr) {
+		ProcessTree::autopin_tid_list tasks;
+		CHECK_ERRORV(tasks = app.proc->getProcessTree().getAllTasks());
+		app.share->applyShare(tasks);
+	}
+}
+
+void Arbiter::startMeasurement() {
+	for (auto &app : applications) {
+		if (!app.active || app.proc == nullptr) continue;
+
+		CHECK_ERRORV(app.tasks = app.proc->getProcessTree().getAllTasks());
+
+		// Restrict tasks which have been created since the last interval
+		app.share->applyShare(app.tasks);
+
+		if (objective != NONE) CHECK_ERRORV(app.monitor->start(app.tasks));
+	}
+
+	measure_start.start();
+}
+
+void Arbiter::stopMeasurement() {
+	if (objective == NONE) return;
+
+	double seconds = measure_start.elapsed() / 1000.0;
+	if (seconds <= 0) return;
+
+	for (auto &app : applications) {
+		if (!app.active || app.proc == nullptr) continue;
+
+		ProcessTree::autopin_tid_list tasks;
+		CHECK_ERRORV(tasks = app.proc->getProcessTree().getAllTasks());
+
+		double value = 0;
+		for (int tid : app.tasks) {
+			if (tasks.count(tid) == 0) {
+				app.monitor->clear(tid);
+				continue;
+			}
+
+			double task_value = 0;
+			CHECK_ERRORV(task_value = app.monitor->stop(tid));
+			value += task_value;
+		}
+
+		double rate = value / seconds;
+		if (app.monitor->getValType() == PerformanceMonitor::montype::MIN)
+			app.performance = (rate > 0) ? 1 / rate : 0;
+		else
+			app.performance = rate;
+
+		app.best = std::max(app.best, app.performance);
+
+		context.info("  :: Performance of " + app.name + ": " + QString::number(app.performance) + " (" +
+					 QString::number(app.cores.size()) + " cores)");
+	}
+}
+
+double Arbiter::evaluate(const QList<double> &performance) {
+	double result = 0;
+
+	for (int i = 0; i < applications.size(); i++) {
+		const application &app = applications[i];
+		if (!app.active) continue;
+
+		double reference = (app.reference > 0) ? app.reference : app.best;
+		if (reference <= 0) continue;
+
+		// Applications which haven't made any progress count as slowed down by three orders of magnitude
+		double normalized = std::max(performance[i] / reference, 0.001);
+
+		if (objective == THROUGHPUT)
+			result += app.weight * normalized;
+		else
+			result -= app.weight / normalized;
+	}
+
+	return result;
+}
+
+void Arbiter::moveCore(int from, int to) {
+	applications[to].cores.push_back(applications[from].cores.takeLast());
+	applyShare(applications[from]);
+	applyShare(applications[to]);
+}
+
+QString Arbiter::sharesString() {
+	QStringList result;
+
+	for (const auto &app : applications)
+		if (app.active) result.push_back(app.name + ": " + QString::number(app.cores.size()));
+
+	return result.join(", ");
+}
+
+} // namespace AutopinPlus
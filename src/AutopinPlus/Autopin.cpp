@@ -29,13 +29,25 @@
 #include <AutopinPlus/Autopin.h>
 #include <AutopinPlus/Logger/External/Main.h>
 #include <AutopinPlus/Monitor/ClustSafe/Main.h>
+#include <AutopinPlus/Monitor/Expression/Main.h>
 #include <AutopinPlus/Monitor/GPerf/Main.h>
+#include <AutopinPlus/Monitor/MemShare/Main.h>
 #include <AutopinPlus/Monitor/Perf/Main.h>
 #include <AutopinPlus/Monitor/Random/Main.h>
+#include <AutopinPlus/Monitor/Sampling/Main.h>
 #include <AutopinPlus/OS/Linux/OSServicesLinux.h>
+#include <AutopinPlus/ScopedConfiguration.h>
+#include <AutopinPlus/SharedOSServices.h>
 #include <AutopinPlus/Strategy/Autopin1/Main.h>
+#include <AutopinPlus/Strategy/Bandit/Main.h>
+#include <AutopinPlus/Strategy/Bayesian/Main.h>
+#include <AutopinPlus/Strategy/Cluster/Main.h>
+#include <AutopinPlus/Strategy/Genetic/Main.h>
 #include <AutopinPlus/Strategy/History/Main.h>
+#include <AutopinPlus/Strategy/LocalSearch/Main.h>
 #include <AutopinPlus/Strategy/Noop/Main.h>
+#include <AutopinPlus/Strategy/Pareto/Main.h>
+#include <AutopinPlus/Strategy/Phased/Main.h>
 #include <AutopinPlus/XMLPinningHistory.h>
 #include <QFileInfo>
 #include <QString>
@@ -51,18 +63,26 @@
 namespace AutopinPlus {
 
 Autopin::Autopin(int &argc, char **argv)
-	: QCoreApplication(argc, argv), outchan(nullptr), err(nullptr), config(nullptr), service(nullptr), proc(nullptr),
-	  strategy(nullptr), history(nullptr) {}
+	: QCoreApplication(argc, argv), outchan(nullptr), err(nullptr), config(nullptr), service(nullptr),
+	  arbiter(nullptr) {}
 
 Autopin::~Autopin() {
-	delete strategy;
+	delete arbiter;
+	for (auto &elem : arbiter_monitors) delete elem;
 
-	for (auto logger : loggers) delete logger;
-	for (auto &elem : monitors) delete elem;
+	for (auto &app : applications) {
+		delete app.strategy;
+
+		for (auto logger : app.loggers) delete logger;
+		for (auto &elem : app.monitors) delete elem;
+
+		delete app.proc;
+		delete app.history;
+		if (app.service != service) delete app.service;
+		if (app.config != config) delete app.config;
+	}
 
-	delete proc;
 	delete service;
-	delete history;
 	delete config;
 	delete err;
 	delete outchan;
@@ -109,41 +129,74 @@ void Autopin::slot_autopinSetup() {
 	CHECK_ERRORV(createOSServices());
 	CHECK_ERRORV(service->init());
 
-	context.info("  > Initializing performance monitors");
-	// Setup and initialize performance monitors
-	CHECK_ERRORV(createPerformanceMonitors());
-	for (auto &elem : monitors) CHECK_ERRORV((elem)->init());
-
-	// Setup and initialize observed process
-	proc = new ObservedProcess(config, service, context);
-	CHECK_ERRORV(proc->init());
-
-	// Setup pinning history
-	CHECK_ERRORV(createPinningHistory());
-
-	// Setup and initialize pinning strategy
-	CHECK_ERRORV(createControlStrategy());
-	CHECK_ERRORV(strategy->init());
+	// Setup the components of all observed applications
+	QStringList names = config->getConfigOptionList("Applications");
+
+	if (names.empty()) {
+		application app = {"", config, service, nullptr, {}, nullptr, {}, nullptr};
+		applications.push_back(app);
+	} else {
+		// Options which identify an application are never shared between applications
+		QStringList local;
+		local << "Exec"
+			  << "Attach"
+			  << "Trace"
+			  << "CommChan"
+			  << "PinningHistory.load"
+			  << "PinningHistory.save";
+
+		arbiter = new Arbiter(config, service, context);
+
+		for (const auto &name : names) {
+			if (names.count(name) > 1)
+				REPORTV(Error::BAD_CONFIG, "inconsistent", "The application " + name + " is specified more than once");
+
+			SharedOSServices *share = new SharedOSServices(service, context);
+			application app = {name, new ScopedConfiguration(config, name, local, context), share, nullptr, {},
+							   nullptr, {}, nullptr};
+			applications.push_back(app);
+			arbiter->addApplication(name, app.config, share);
+		}
 
-	// Setup and initialize data loggers
-	context.info("  > Initializing data loggers");
-	CHECK_ERRORV(createDataLoggers());
-	for (auto logger : loggers) {
-		CHECK_ERRORV(logger->init());
+		// The shares have to be known before the control strategies are initialized
+		CHECK_ERRORV(arbiter->init());
 	}
 
-	// Setup global Qt connections
-	createComponentConnections();
+	for (auto &app : applications) CHECK_ERRORV(createApplication(app));
 
-	// Read environment information for the pinning history
-	if (history != nullptr) setPinningHistoryEnv();
+	if (arbiter != nullptr) {
+		// Only one application can be traced and only one can use the communication channel
+		int traced = 0, comm = 0;
+		for (const auto &app : applications) {
+			if (app.proc->getTrace()) traced++;
+			if (app.proc->getCommChanAddr() != "") comm++;
+		}
+		if (traced > 1) REPORTV(Error::BAD_CONFIG, "inconsistent", "Only one application can be traced");
+		if (comm > 1)
+			REPORTV(Error::BAD_CONFIG, "inconsistent", "Only one application can use the communication channel");
+
+		// The arbiter measures the applications with its own performance monitors
+		context.info("  > Initializing the performance monitors of the arbiter");
+		for (const auto &app : applications) {
+			QString id = app.config->getConfigOption("Arbiter.monitor");
+			if (id == "") id = app.config->getConfigOption("PerformanceMonitors");
+
+			PerformanceMonitor::monitor_list monitors;
+			CHECK_ERRORV(createPerformanceMonitor(app.config, id, monitors));
+			if (monitors.empty()) return;
+			CHECK_ERRORV(monitors.front()->init());
+			arbiter_monitors.push_back(monitors.front());
+			CHECK_ERRORV(arbiter->observe(app.name, app.proc, monitors.front()));
+		}
 
-	// Initialize the pinning history
-	if (history != nullptr) history->init();
+		connect(service, SIGNAL(sig_TaskTerminated(int)), this, SLOT(slot_TaskTerminated(int)));
+		connect(arbiter, SIGNAL(sig_ProcessTerminated(int)), this, SLOT(slot_TaskTerminated(int)));
+		connect(this, SIGNAL(sig_autopinReady()), arbiter, SLOT(slot_autopinReady()));
+	}
 
 	context.biginfo("\nConnecting to the observed process ...");
-	// Starting observed process
-	CHECK_ERRORV(proc->start());
+	// Starting observed processes
+	for (auto &app : applications) CHECK_ERRORV(app.proc->start());
 
 	context.biginfo("\nStarting control strategy ...");
 
@@ -152,67 +205,161 @@ void Autopin::slot_autopinSetup() {
 
 void Autopin::slot_autopinCleanup() {
 	context.biginfo("\nCleaning up ...");
-	if (proc != nullptr) proc->deinit();
-	if (history != nullptr) history->deinit();
+	for (auto &app : applications) {
+		if (app.proc != nullptr) app.proc->deinit();
+		if (app.history != nullptr) app.history->deinit();
+	}
 	context.biginfo("\nExiting ...");
 }
 
+void Autopin::slot_TaskTerminated(int tid) {
+	bool terminated = false;
+
+	for (auto &app : applications) {
+		if (app.strategy == nullptr || app.proc->getPid() != tid) continue;
+
+		// Stop tuning the application and give its cores to the others
+		CHECK_ERRORV(arbiter->removeApplication(app.name));
+		app.strategy->deleteLater();
+		app.strategy = nullptr;
+		terminated = true;
+	}
+
+	int running = 0;
+	for (auto &app : applications) {
+		if (app.strategy == nullptr) continue;
+
+		// Only the traced application is notified about its tasks
+		if (!terminated && app.proc->getTrace()) app.proc->slot_TaskTerminated(tid);
+
+		running++;
+	}
+
+	if (running == 0) {
+		context.biginfo("\nAll applications have terminated");
+		quit();
+	}
+}
+
+void Autopin::createApplication(application &app) {
+	if (app.name != "") context.info("  > Setting up application " + app.name);
+
+	context.info("  > Initializing performance monitors");
+	// Setup and initialize performance monitors
+	CHECK_ERRORV(createPerformanceMonitors(app.config, app.monitors));
+	for (auto &elem : app.monitors) CHECK_ERRORV((elem)->init());
+
+	// Setup and initialize observed process
+	app.proc = new ObservedProcess(app.config, app.service, context);
+	CHECK_ERRORV(app.proc->init());
+
+	// Setup and initialize pinning history, the control strategy may use the stored results
+	CHECK_ERRORV(createPinningHistory(app));
+	if (app.history != nullptr) {
+		OSServices::autopin_topology topology;
+		CHECK_ERRORV(topology = app.service->getTopology());
+		app.history->setTopology(topology);
+		CHECK_ERRORV(app.history->init());
+	}
+
+	// Setup and initialize pinning strategy
+	CHECK_ERRORV(createControlStrategy(app));
+	CHECK_ERRORV(app.strategy->init());
+
+	// Setup and initialize data loggers
+	context.info("  > Initializing data loggers");
+	CHECK_ERRORV(createDataLoggers(app));
+	for (auto logger : app.loggers) {
+		CHECK_ERRORV(logger->init());
+	}
+
+	// Setup Qt connections
+	createComponentConnections(app);
+
+	// Read environment information for the pinning history
+	if (app.history != nullptr) setPinningHistoryEnv(app);
+}
+
 void Autopin::createOSServices() { service = new OS::Linux::OSServicesLinux(context); }
 
-void Autopin::createPerformanceMonitors() {
+void Autopin::createPerformanceMonitors(Configuration *config, PerformanceMonitor::monitor_list &monitors) {
 	QStringList config_monitors = config->getConfigOptionList("PerformanceMonitors");
 	QStringList existing_ids;
 
 	if (config_monitors.empty()) REPORTV(Error::BAD_CONFIG, "option_missing", "No performance monitor configured");
 
 	for (int i = 0; i < config_monitors.size(); i++) {
-		QString current_monitor = config_monitors[i], current_type;
+		QString current_monitor = config_monitors[i];
 
 		if (existing_ids.contains(current_monitor))
 			REPORTV(Error::BAD_CONFIG, "inconsistent",
 					"The identifier " + current_monitor + " is already assigned to another monitor");
 
-		int numtypes = config->configOptionExists(current_monitor + ".type");
+		CHECK_ERRORV(createPerformanceMonitor(config, current_monitor, monitors));
+	}
+}
+
+void Autopin::createPerformanceMonitor(Configuration *config, QString id, PerformanceMonitor::monitor_list &monitors) {
+	QString current_monitor = id, current_type;
 
-		if (numtypes <= 0) {
-			REPORTV(Error::BAD_CONFIG, "option_missing",
-					"Type for monitor \"" + current_monitor + "\" is not specified");
-		} else if (numtypes > 1) {
-			REPORTV(Error::BAD_CONFIG, "inconsistent",
-					"Specified " + QString::number(numtypes) + " types for monitor " + current_monitor);
-		}
+	int numtypes = config->configOptionExists(current_monitor + ".type");
 
-		current_type = config->getConfigOption(current_monitor + ".type");
+	if (numtypes <= 0) {
+		REPORTV(Error::BAD_CONFIG, "option_missing", "Type for monitor \"" + current_monitor + "\" is not specified");
+	} else if (numtypes > 1) {
+		REPORTV(Error::BAD_CONFIG, "inconsistent",
+				"Specified " + QString::number(numtypes) + " types for monitor " + current_monitor);
+	}
 
-		if (current_type == "clustsafe") {
-			PerformanceMonitor *new_mon = new Monitor::ClustSafe::Main(current_monitor, config, context);
-			monitors.push_back(new_mon);
-			continue;
-		}
+	current_type = config->getConfigOption(current_monitor + ".type");
 
-		if (current_type == "gperf") {
-			PerformanceMonitor *new_mon = new Monitor::GPerf::Main(current_monitor, config, context);
-			monitors.push_back(new_mon);
-			continue;
-		}
+	if (current_type == "clustsafe") {
+		PerformanceMonitor *new_mon = new Monitor::ClustSafe::Main(current_monitor, config, context);
+		monitors.push_back(new_mon);
+		return;
+	}
 
-		if (current_type == "perf") {
-			PerformanceMonitor *new_mon = new Monitor::Perf::Main(current_monitor, config, context);
-			monitors.push_back(new_mon);
-			continue;
-		}
+	if (current_type == "expression") {
+		PerformanceMonitor *new_mon = new Monitor::Expression::Main(current_monitor, config, monitors, context);
+		monitors.push_back(new_mon);
+		return;
+	}
 
-		if (current_type == "random") {
-			PerformanceMonitor *new_mon = new Monitor::Random::Main(current_monitor, config, context);
-			monitors.push_back(new_mon);
-			continue;
-		}
+	if (current_type == "gperf") {
+		PerformanceMonitor *new_mon = new Monitor::GPerf::Main(current_monitor, config, monitors, context);
+		monitors.push_back(new_mon);
+		return;
+	}
+
+	if (current_type == "memshare") {
+		PerformanceMonitor *new_mon = new Monitor::MemShare::Main(current_monitor, config, context);
+		monitors.push_back(new_mon);
+		return;
+	}
+
+	if (current_type == "perf") {
+		PerformanceMonitor *new_mon = new Monitor::Perf::Main(current_monitor, config, context);
+		monitors.push_back(new_mon);
+		return;
+	}
+
+	if (current_type == "random") {
+		PerformanceMonitor *new_mon = new Monitor::Random::Main(current_monitor, config, context);
+		monitors.push_back(new_mon);
+		return;
+	}
 
-		REPORTV(Error::UNSUPPORTED, "critical", "Performance monitor type \"" + current_type + "\" is not supported");
+	if (current_type == "sampling") {
+		PerformanceMonitor *new_mon = new Monitor::Sampling::Main(current_monitor, config, context);
+		monitors.push_back(new_mon);
+		return;
 	}
+
+	REPORTV(Error::UNSUPPORTED, "critical", "Performance monitor type \"" + current_type + "\" is not supported");
 }
 
-void Autopin::createPinningHistory() {
+void Autopin::createPinningHistory(application &app) {
+	Configuration *config = app.config;
 	int optcount_read = config->configOptionExists("PinningHistory.load");
 	int optcount_write = config->configOptionExists("PinningHistory.save");
 
@@ -233,7 +380,7 @@ void Autopin::createPinningHistory() {
 	QFileInfo history_info(history_config);
 
 	if (history_info.suffix() == "xml") {
-		history = new XMLPinningHistory(config, context);
+		app.history = new XMLPinningHistory(config, context);
 		return;
 	}
 
@@ -241,7 +388,8 @@ void Autopin::createPinningHistory() {
 			"File type \"." + history_info.suffix() + "\" is not supported by any pinning history");
 }
 
-void Autopin::createControlStrategy() {
+void Autopin::createControlStrategy(application &app) {
+	Configuration *config = app.config;
 	int optcount = config->configOptionExists("ControlStrategy");
 
 	if (optcount <= 0) REPORTV(Error::BAD_CONFIG, "option_missing", "No control strategy configured");
@@ -251,27 +399,63 @@ void Autopin::createControlStrategy() {
 	QString strategy_config = config->getConfigOption("ControlStrategy");
 
 	if (strategy_config == "autopin1") {
-		strategy = new Strategy::Autopin1::Main(config, proc, service, monitors, history, context);
+		app.strategy = new Strategy::Autopin1::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "bandit") {
+		app.strategy = new Strategy::Bandit::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "bayesian") {
+		app.strategy = new Strategy::Bayesian::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "cluster") {
+		app.strategy = new Strategy::Cluster::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "genetic") {
+		app.strategy = new Strategy::Genetic::Main(config, app.proc, app.service, app.monitors, app.history, context);
 		return;
 	}
 
 	if (strategy_config == "history") {
-		strategy = new Strategy::History::Main(config, proc, service, monitors, history, context);
+		app.strategy = new Strategy::History::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "localsearch") {
+		app.strategy =
+			new Strategy::LocalSearch::Main(config, app.proc, app.service, app.monitors, app.history, context);
 		return;
 	}
 
 	if (strategy_config == "noop") {
-		strategy = new Strategy::Noop::Main(config, proc, service, monitors, history, context);
+		app.strategy = new Strategy::Noop::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "pareto") {
+		app.strategy = new Strategy::Pareto::Main(config, app.proc, app.service, app.monitors, app.history, context);
+		return;
+	}
+
+	if (strategy_config == "phased") {
+		app.strategy = new Strategy::Phased::Main(config, app.proc, app.service, app.monitors, app.history, context);
 		return;
 	}
 
 	REPORTV(Error::UNSUPPORTED, "", "Control strategy \"" + strategy_config + "\" is not supported");
 }
 
-void Autopin::createDataLoggers() {
-	for (auto logger : config->getConfigOptionList("DataLoggers")) {
+void Autopin::createDataLoggers(application &app) {
+	for (auto logger : app.config->getConfigOptionList("DataLoggers")) {
 		if (logger == "external") {
-			loggers.append(new Logger::External::Main(config, monitors, context));
+			app.loggers.append(new Logger::External::Main(app.config, app.monitors, context));
 		} else {
 			REPORTV(Error::UNSUPPORTED, "critical", "Data logger \"" + logger + "\" is not supported");
 			return;
@@ -279,13 +463,20 @@ void Autopin::createDataLoggers() {
 	}
 }
 
-void Autopin::setPinningHistoryEnv() {
+void Autopin::setPinningHistoryEnv(const application &app) {
+	PinningHistory *history = app.history;
+	ObservedProcess *proc = app.proc;
+
 	history->setHostname(OS::Linux::OSServicesLinux::getHostname_static());
-	history->setConfiguration(config->getName(), config->getConfigOpts());
+
+	Configuration::configopts opts = app.config->getConfigOpts();
+	if (arbiter != nullptr) opts.splice(opts.end(), arbiter->getConfigOpts());
+	history->setConfiguration(app.config->getName(), opts);
+
 	QString comm = (proc->getCommChanAddr() == "") ? "Inactive" : "Active";
 	QString trace = (proc->getTrace()) ? "Active" : "Inactive";
 	history->setObservedProcess(proc->getCmd(), trace, comm, QString::number(proc->getCommTimeout()));
-	for (auto &elem : monitors) {
+	for (auto &elem : app.monitors) {
 		PinningHistory::monitor_config mconf;
 		mconf.name = (elem)->getName();
 		mconf.type = (elem)->getType();
@@ -293,14 +484,21 @@ void Autopin::setPinningHistoryEnv() {
 
 		history->addPerformanceMonitor(mconf);
 	}
-	history->setControlStrategy(strategy->getName(), strategy->getConfigOpts());
+	history->setControlStrategy(app.strategy->getName(), app.strategy->getConfigOpts());
 }
 
-void Autopin::createComponentConnections() {
-	// Connections between the OSServices and the ObservedProcess
-	connect(service, SIGNAL(sig_TaskCreated(int)), proc, SLOT(slot_TaskCreated(int)));
-	connect(service, SIGNAL(sig_TaskTerminated(int)), proc, SLOT(slot_TaskTerminated(int)));
-	connect(service, SIGNAL(sig_CommChannel(autopin_msg)), proc, SLOT(slot_CommChannel(autopin_msg)));
+void Autopin::createComponentConnections(const application &app) {
+	ObservedProcess *proc = app.proc;
+	ControlStrategy *strategy = app.strategy;
+
+	// Connections between the OSServices and the ObservedProcess. If several applications are observed, only the
+	// traced application and the one using the communication channel are notified, terminated tasks are dispatched
+	// by slot_TaskTerminated().
+	if (arbiter == nullptr || proc->getTrace())
+		connect(service, SIGNAL(sig_TaskCreated(int)), proc, SLOT(slot_TaskCreated(int)));
+	if (arbiter == nullptr) connect(service, SIGNAL(sig_TaskTerminated(int)), proc, SLOT(slot_TaskTerminated(int)));
+	if (arbiter == nullptr || proc->getCommChanAddr() != "")
+		connect(service, SIGNAL(sig_CommChannel(autopin_msg)), proc, SLOT(slot_CommChannel(autopin_msg)));
 
 	// Connections between the ObservedProcess and the ControlStrategy
 	connect(proc, SIGNAL(sig_TaskCreated(int)), strategy, SLOT(slot_TaskCreated(int)));
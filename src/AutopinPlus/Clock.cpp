@@ -0,0 +1,47 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Clock.h>
+
+#include <qelapsedtimer.h> // for QElapsedTimer
+
+namespace AutopinPlus {
+
+Clock::time_source Clock::source;
+
+qint64 Clock::now() {
+	if (source) return source();
+
+	static QElapsedTimer monotonic;
+	if (!monotonic.isValid()) monotonic.start();
+
+	return monotonic.elapsed();
+}
+
+void Clock::setSource(time_source source) { Clock::source = source; }
+
+void Clock::start() { start_time = now(); }
+
+void Clock::invalidate() { start_time = -1; }
+
+bool Clock::isValid() const { return start_time != -1; }
+
+qint64 Clock::elapsed() const { return now() - start_time; }
+
+} // namespace AutopinPlus
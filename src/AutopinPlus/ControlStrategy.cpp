@@ -28,10 +28,19 @@
 
 #include <AutopinPlus/ControlStrategy.h>
 
+#include <AutopinPlus/Exception.h>
+#include <AutopinPlus/PerformanceModel.h>
+#include <AutopinPlus/Tools.h>
 #include <algorithm>
+#include <map>
 #include <QChar>
+#include <QRegExp>
 #include <QString>
 #include <QStringList>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace AutopinPlus {
 
@@ -39,7 +48,7 @@ ControlStrategy::ControlStrategy(Configuration *config, ObservedProcess *proc, O
 								 PerformanceMonitor::monitor_list monitors, PinningHistory *history,
 								 const AutopinContext &context)
 	: config(config), proc(proc), service(service), monitors(std::move(monitors)), history(history), context(context),
-	  name("ControlStrategy") {}
+	  name("ControlStrategy"), role_delay(100) {}
 
 QString ControlStrategy::getName() { return name; }
 
@@ -60,7 +69,158 @@ bool ControlStrategy::addPinningToHistory(PinningHistory::autopin_pinning pinnin
 	return true;
 }
 
-PinningHistory::pinning_list ControlStrategy::readPinnings(QString opt) {
+void ControlStrategy::readRoles(const option_reader &option) {
+	role_rules.clear();
+	role_opts.clear();
+
+	QStringList roles = option("roles");
+	if (!roles.empty()) role_opts.push_back(Configuration::configopt("roles", roles));
+
+	for (const auto &role : roles) {
+		role_rule rule;
+		rule.role = role;
+		rule.min_share = 0;
+		rule.max_share = -1;
+
+		QString prefix = "role." + role + ".";
+		QStringList value;
+
+		// Names may contain spaces which separate the values of an option
+		if (!(value = option(prefix + "comm")).empty()) {
+			rule.comm = QRegExp(value.join(" "));
+			if (!rule.comm.isValid())
+				REPORTV(Error::BAD_CONFIG, "option_format", "Invalid task name for role " + role + ": " + value.join(" "));
+			role_opts.push_back(Configuration::configopt(prefix + "comm", value));
+		}
+
+		if (!(value = option(prefix + "process")).empty()) {
+			rule.process = QRegExp(value.join(" "));
+			if (!rule.process.isValid())
+				REPORTV(Error::BAD_CONFIG, "option_format",
+						"Invalid process name for role " + role + ": " + value.join(" "));
+			role_opts.push_back(Configuration::configopt(prefix + "process", value));
+		}
+
+		bool ok = true;
+		if (!(value = option(prefix + "min_share")).empty()) {
+			rule.min_share = value.first().toDouble(&ok);
+			if (!ok) REPORTV(Error::BAD_CONFIG, "option_format", "Invalid cpu share for role " + role + ": " + value.first());
+			role_opts.push_back(Configuration::configopt(prefix + "min_share", value));
+		}
+
+		if (!(value = option(prefix + "max_share")).empty()) {
+			rule.max_share = value.first().toDouble(&ok);
+			if (!ok) REPORTV(Error::BAD_CONFIG, "option_format", "Invalid cpu share for role " + role + ": " + value.first());
+			role_opts.push_back(Configuration::configopt(prefix + "max_share", value));
+		}
+
+		role_rules.push_back(rule);
+	}
+
+	pin_roles = option("pin_roles");
+	if (pin_roles.empty()) {
+		for (const auto &role : roles) {
+			if (role != "ignore" && !pin_roles.contains(role)) pin_roles.push_back(role);
+		}
+		if (!pin_roles.contains("default")) pin_roles.push_back("default");
+	} else
+		role_opts.push_back(Configuration::configopt("pin_roles", pin_roles));
+
+	QStringList value = option("role_delay");
+	role_delay = 100;
+	if (!value.empty()) {
+		bool ok = true;
+		role_delay = value.first().toInt(&ok);
+		if (!ok || role_delay < 0)
+			REPORTV(Error::BAD_CONFIG, "option_format", "Invalid delay for classifying new tasks: " + value.first());
+		role_opts.push_back(Configuration::configopt("role_delay", value));
+	}
+
+	if (!role_rules.empty()) {
+		for (const auto &rule : role_rules) {
+			QStringList criteria;
+			if (!rule.comm.isEmpty()) criteria.push_back("name " + rule.comm.pattern());
+			if (!rule.process.isEmpty()) criteria.push_back("process " + rule.process.pattern());
+			if (rule.min_share > 0) criteria.push_back("cpu share >= " + QString::number(rule.min_share));
+			if (rule.max_share >= 0) criteria.push_back("cpu share <= " + QString::number(rule.max_share));
+			if (criteria.empty()) criteria.push_back("all tasks");
+
+			context.info("  :: Role " + rule.role + ": " + criteria.join(", "));
+		}
+		context.info("  :: Pinned roles: " + pin_roles.join(" "));
+		context.info("  :: New tasks are classified after " + QString::number(role_delay) + " ms");
+	}
+}
+
+Configuration::configopts ControlStrategy::getRoleOpts() { return role_opts; }
+
+QString ControlStrategy::getTaskRole(int tid) {
+	if (role_rules.empty()) return "default";
+
+	OSServices::autopin_task_info info;
+	CHECK_ERROR(info = service->getTaskInfo(tid), "default");
+
+	for (const auto &rule : role_rules) {
+		if (!rule.comm.isEmpty() && !rule.comm.exactMatch(info.name)) continue;
+		if (!rule.process.isEmpty() && !rule.process.exactMatch(info.process)) continue;
+		if (info.cpu_share < rule.min_share) continue;
+		if (rule.max_share >= 0 && info.cpu_share > rule.max_share) continue;
+
+		return rule.role;
+	}
+
+	return "default";
+}
+
+bool ControlStrategy::selectTask(int tid, int index, const std::set<int> &ignored, QString &role) {
+	if (ignored.find(index) != ignored.end()) {
+		context.info("  :: Not pinning task " + QString::number(tid) + " (skipped)");
+		return false;
+	}
+
+	role = getTaskRole(tid);
+	if (!pin_roles.contains(role)) {
+		context.info("  :: Not pinning task " + QString::number(tid) + " (role " + role + ")");
+		return false;
+	}
+
+	return true;
+}
+
+ControlStrategy::autopin_tasklist ControlStrategy::selectTasks(const std::set<int> &ignored, QStringList &roles) {
+	autopin_tasklist result;
+	std::map<QString, autopin_tasklist> by_role;
+
+	for (unsigned int j = 0; j < tasks.size(); j++) {
+		QString role;
+		if (selectTask(tasks[j], j, ignored, role)) by_role[role].push_back(tasks[j]);
+	}
+
+	roles.clear();
+	for (const auto &role : pin_roles) {
+		result.insert(result.end(), by_role[role].begin(), by_role[role].end());
+		for (unsigned int j = 0; j < by_role[role].size(); j++) roles.push_back(role);
+	}
+
+	return result;
+}
+
+int ControlStrategy::selectEntry(const QString &role, const std::set<int> &used) {
+	for (int i = 0; i < entry_roles.size(); i++) {
+		if (entry_roles[i] == role && used.find(i) == used.end()) return i;
+	}
+
+	for (int i = 0; i < entry_roles.size(); i++) {
+		if (entry_roles[i].isEmpty() && used.find(i) == used.end()) {
+			entry_roles[i] = role;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+PinningHistory::pinning_list ControlStrategy::readPinnings(QString opt, PerformanceMonitor::montype type) {
 	PinningHistory::pinning_list result;
 	QStringList pinnings;
 
@@ -70,14 +230,47 @@ PinningHistory::pinning_list ControlStrategy::readPinnings(QString opt) {
 	pinnings = config->getConfigOptionList(opt);
 
 	for (int i = 0; i < pinnings.size(); i++) {
+		if (pinnings[i].startsWith("auto:")) {
+			bool ok;
+			int threads = pinnings[i].mid(5).toInt(&ok);
+			if (!ok || threads <= 0)
+				REPORT(Error::BAD_CONFIG, "option_format", pinnings[i] + " is not a valid pinning", result);
+
+			PinningHistory::pinning_list generated;
+			CHECK_ERROR(generated = generatePinnings(threads), result);
+
+			for (const auto &pinning : generated) {
+				if (std::find(result.begin(), result.end(), pinning) == result.end()) result.push_back(pinning);
+			}
+
+			continue;
+		}
+
+		if (pinnings[i].startsWith("model:")) {
+			bool ok;
+			int threads = pinnings[i].mid(6).toInt(&ok);
+			if (!ok || threads <= 0)
+				REPORT(Error::BAD_CONFIG, "option_format", pinnings[i] + " is not a valid pinning", result);
+
+			PinningHistory::pinning_list predicted;
+			CHECK_ERROR(predicted = predictPinnings(threads, type), result);
+
+			for (const auto &pinning : predicted) {
+				if (std::find(result.begin(), result.end(), pinning) == result.end()) result.push_back(pinning);
+			}
+
+			continue;
+		}
+
 		QStringList pinning = pinnings[i].split(':', QString::SkipEmptyParts, Qt::CaseSensitive);
 		PinningHistory::autopin_pinning new_pinning;
 
 		for (int j = 0; j < pinning.size(); j++) {
-			bool ok;
-			int cpu = pinning[j].toInt(&ok);
-			if (ok && cpu >= 0)
-				new_pinning.push_back(cpu);
+			PinningHistory::autopin_cpuset cpus;
+			CHECK_ERROR(cpus = readCpuSet(pinning[j]), result);
+
+			if (!cpus.empty())
+				new_pinning.push_back(cpus);
 			else
 				REPORT(Error::BAD_CONFIG, "option_format", pinnings[i] + " is not a valid pinning", result);
 		}
@@ -88,6 +281,242 @@ PinningHistory::pinning_list ControlStrategy::readPinnings(QString opt) {
 	return result;
 }
 
+PinningHistory::autopin_cpuset ControlStrategy::readCpuSet(QString entry) {
+	PinningHistory::autopin_cpuset result;
+	QRegExp named("(socket|node|llc)([0-9]+)");
+
+	if (!named.exactMatch(entry)) {
+		try {
+			result = PinningHistory::readCpuSet(entry);
+		} catch (Exception e) {
+			return PinningHistory::autopin_cpuset();
+		}
+
+		// Cores which are not online cannot be used for pinning
+		OSServices::autopin_topology topology;
+		CHECK_ERROR(topology = service->getTopology(), PinningHistory::autopin_cpuset());
+
+		if (topology.empty()) return result;
+
+		std::set<int> online;
+		for (const auto &cpu : topology) online.insert(cpu.cpu);
+
+		for (int cpu : result) {
+			if (online.count(cpu) == 0) return PinningHistory::autopin_cpuset();
+		}
+
+		return result;
+	}
+
+	OSServices::autopin_topology topology;
+	CHECK_ERROR(topology = service->getTopology(), result);
+
+	int id = named.cap(2).toInt();
+
+	// The ids of the last level caches are the lowest cores sharing them, so they have to be numbered first
+	std::set<int> llcs;
+	for (const auto &cpu : topology) llcs.insert(cpu.llc);
+	std::map<int, int> llc_index;
+	int index = 0;
+	for (int llc : llcs) llc_index[llc] = index++;
+
+	for (const auto &cpu : topology) {
+		if ((named.cap(1) == "socket" && cpu.socket == id) || (named.cap(1) == "node" && cpu.node == id) ||
+			(named.cap(1) == "llc" && llc_index[cpu.llc] == id))
+			result.insert(cpu.cpu);
+	}
+
+	return result;
+}
+
+PinningHistory::pinning_list ControlStrategy::generatePinnings(int threads) {
+	PinningHistory::pinning_list result;
+	OSServices::autopin_topology topology;
+
+	CHECK_ERROR(topology = service->getTopology(), result);
+
+	if (topology.empty())
+		REPORT(Error::UNSUPPORTED, "critical", "The topology of the system is not available", result);
+
+	if (threads > (int)topology.size())
+		REPORT(Error::BAD_CONFIG, "inconsistent", "Cannot generate pinnings for " + QString::number(threads) +
+													  " threads on a system with " + QString::number(topology.size()) +
+													  " cpus",
+			   result);
+
+	// Sort the cpus such that neighbouring cpus share as many resources as possible
+	std::sort(topology.begin(), topology.end(), [](const OSServices::autopin_cpu &a, const OSServices::autopin_cpu &b) {
+		return std::tie(a.socket, a.node, a.llc, a.core, a.cpu) < std::tie(b.socket, b.node, b.llc, b.core, b.cpu);
+	});
+
+	// For every cpu determine its position in the sorted list, the index of the hardware thread
+	// within its core and the index of its core within the socket, the cache and the NUMA node.
+	typedef std::pair<int, int> core_id;
+	std::map<core_id, int> core_threads, core_socket, core_llc, core_node;
+	std::map<int, int> socket_cores, llc_cores, node_cores;
+	std::map<int, std::vector<int>> rank;
+
+	for (int i = 0; i < (int)topology.size(); i++) {
+		const auto &cpu = topology[i];
+		core_id core(cpu.socket, cpu.core);
+
+		if (core_threads.count(core) == 0) {
+			core_socket[core] = socket_cores[cpu.socket]++;
+			core_llc[core] = llc_cores[cpu.llc]++;
+			core_node[core] = node_cores[cpu.node]++;
+		}
+
+		rank[cpu.cpu] = {i, core_threads[core]++, core_socket[core], core_llc[core], core_node[core]};
+	}
+
+	// Each placement is defined by the order in which the cpus are used
+	std::vector<std::pair<QString, std::vector<int>>> placements = {
+		{"compact", {1, 0}}, {"smt", {0}}, {"scatter", {1, 2, 0}}, {"llc", {1, 3, 0}}, {"numa", {1, 4, 0}}};
+
+	for (const auto &placement : placements) {
+		const std::vector<int> &keys = placement.second;
+		OSServices::autopin_topology order = topology;
+
+		std::sort(order.begin(), order.end(), [&](const OSServices::autopin_cpu &a, const OSServices::autopin_cpu &b) {
+			for (int key : keys) {
+				if (rank[a.cpu][key] != rank[b.cpu][key]) return rank[a.cpu][key] < rank[b.cpu][key];
+			}
+			return false;
+		});
+
+		PinningHistory::autopin_pinning pinning;
+		for (int i = 0; i < threads; i++) pinning.push_back({order[i].cpu});
+
+		if (std::find(result.begin(), result.end(), pinning) != result.end()) continue;
+
+		context.debug("Generated " + placement.first + " pinning for " + QString::number(threads) +
+					  " threads: " + PinningHistory::showPinning(pinning));
+
+		result.push_back(pinning);
+	}
+
+	return result;
+}
+
+PinningHistory::pinning_list ControlStrategy::predictPinnings(int threads, PerformanceMonitor::montype type) {
+	PinningHistory::pinning_list result;
+	int seeds = 3, candidates = 1000;
+	double regularization = 1;
+
+	if (history == nullptr)
+		REPORT(Error::BAD_CONFIG, "inconsistent", "Predicting pinnings requires a pinning history", result);
+
+	try {
+		if (config->configOptionExists(name + ".model_seeds") > 0)
+			seeds = Tools::readInt(config->getConfigOption(name + ".model_seeds"));
+
+		if (config->configOptionExists(name + ".model_candidates") > 0)
+			candidates = Tools::readInt(config->getConfigOption(name + ".model_candidates"));
+
+		if (config->configOptionExists(name + ".model_regularization") > 0)
+			regularization = Tools::readDouble(config->getConfigOption(name + ".model_regularization"));
+	} catch (Exception e) {
+		REPORT(Error::BAD_CONFIG, "option_format", name + ": " + QString(e.what()), result);
+	}
+
+	if (seeds < 1 || candidates < 0 || regularization < 0)
+		REPORT(Error::BAD_CONFIG, "option_format", name + ": Invalid value for 'model_seeds', 'model_candidates' or "
+														  "'model_regularization'",
+			   result);
+
+	OSServices::autopin_topology topology;
+	CHECK_ERROR(topology = service->getTopology(), result);
+
+	if (topology.empty())
+		REPORT(Error::UNSUPPORTED, "critical", "The topology of the system is not available", result);
+
+	// Values of strategies without a preference are treated like those of strategies preferring bigger values
+	if (type != PerformanceMonitor::montype::MIN) type = PerformanceMonitor::montype::MAX;
+
+	PerformanceModel model(topology, regularization);
+	int samples = model.train(*history, type);
+
+	if (samples == 0) {
+		context.info("  :: The pinning history contains no results, no pinnings have been predicted");
+		return result;
+	}
+
+	context.info("  :: Trained the performance model on " + QString::number(samples) + " results");
+
+	// Rank the generated placements and random pinnings of all cpus
+	PinningHistory::pinning_list pool;
+	CHECK_ERROR(pool = generatePinnings(threads), result);
+
+	QList<int> cpus;
+	for (const auto &cpu : topology) cpus.append(cpu.cpu);
+	PinningSpace space(cpus, threads);
+	for (int i = 0; i < candidates; i++) pool.push_back(space.randomPinning());
+
+	std::vector<std::pair<double, PinningHistory::autopin_pinning>> ranked;
+	for (const auto &pinning : pool) ranked.push_back(std::make_pair(model.predict(pinning), pinning));
+
+	std::stable_sort(ranked.begin(), ranked.end(),
+					 [](const std::pair<double, PinningHistory::autopin_pinning> &a,
+						const std::pair<double, PinningHistory::autopin_pinning> &b) { return a.first > b.first; });
+
+	for (const auto &elem : ranked) {
+		if ((int)result.size() >= seeds) break;
+		if (std::find(result.begin(), result.end(), elem.second) != result.end()) continue;
+
+		context.info("  :: Predicted pinning " + PinningHistory::showPinning(elem.second) + " (relative performance " +
+					 QString::number(elem.first) + ")");
+
+		result.push_back(elem.second);
+	}
+
+	return result;
+}
+
+PinningSpace ControlStrategy::readPinningSpace(const PinningHistory::pinning_list &pinnings) {
+	PinningSpace result;
+	QList<int> cpus;
+	int threads = 0;
+
+	try {
+		if (config->configOptionExists(name + ".cpus") > 0)
+			cpus = Tools::readInts(config->getConfigOptionList(name + ".cpus"));
+
+		if (config->configOptionExists(name + ".threads") > 0)
+			threads = Tools::readInt(config->getConfigOption(name + ".threads"));
+	} catch (Exception e) {
+		REPORT(Error::BAD_CONFIG, "option_format", name + ": " + QString(e.what()), result);
+	}
+
+	for (const auto &pinning : pinnings) {
+		if (config->configOptionExists(name + ".cpus") <= 0) {
+			for (const auto &set : pinning) {
+				for (auto cpu : set) {
+					if (!cpus.contains(cpu)) cpus.append(cpu);
+				}
+			}
+		}
+
+		if (config->configOptionExists(name + ".threads") <= 0) threads = std::max(threads, (int)pinning.size());
+	}
+
+	if (cpus.isEmpty()) {
+		OSServices::autopin_topology topology;
+		CHECK_ERROR(topology = service->getTopology(), result);
+		for (const auto &cpu : topology) cpus.append(cpu.cpu);
+	}
+
+	if (threads <= 0)
+		REPORT(Error::BAD_CONFIG, "option_missing",
+			   name + ": The number of threads has to be set with the option " + name + ".threads", result);
+
+	if (threads > cpus.size())
+		REPORT(Error::BAD_CONFIG, "inconsistent", name + ": Cannot pin " + QString::number(threads) + " threads to " +
+													  QString::number(cpus.size()) + " processors",
+			   result);
+
+	return PinningSpace(cpus, threads);
+}
+
 void ControlStrategy::refreshTasks() {
 	ProcessTree ptree;
 
@@ -104,6 +533,46 @@ void ControlStrategy::refreshTasks() {
 	}
 
 	std::sort(tasks.begin(), tasks.end(), sort);
+
+	// Forget terminated tasks so that their numbers can be reused
+	std::map<int, QString> running_ids;
+	for (const auto &tid : tasks) {
+		auto it = task_ids.find(tid);
+		if (it != task_ids.end()) running_ids.insert(*it);
+	}
+	task_ids.swap(running_ids);
+
+	for (const auto &tid : tasks) CHECK_ERRORV(getTaskId(tid));
+}
+
+QString ControlStrategy::getTaskId(int tid) {
+	auto it = task_ids.find(tid);
+	if (it != task_ids.end()) return it->second;
+
+	OSServices::autopin_task_info info;
+	int creator;
+	CHECK_ERROR(info = service->getTaskInfo(tid), "");
+	CHECK_ERROR(creator = service->getTaskCreator(tid), "");
+
+	// Fall back to the main task if the creator is not known
+	if (task_ids.find(creator) == task_ids.end()) creator = info.pid;
+
+	QString prefix;
+	if (creator != tid && task_ids.find(creator) != task_ids.end()) prefix = task_ids[creator] + "/";
+
+	QString name = info.name;
+	name.replace("%", "%25").replace("/", "%2F").replace("#", "%23").replace(":", "%3A");
+
+	std::set<QString> used;
+	for (const auto &elem : task_ids) used.insert(elem.second);
+
+	int n = 0;
+	while (used.count(prefix + name + "#" + QString::number(n)) > 0) n++;
+
+	QString result = prefix + name + "#" + QString::number(n);
+	task_ids[tid] = result;
+
+	return result;
 }
 
 } // namespace AutopinPlus
@@ -87,6 +87,12 @@ autopin_estate Error::report(Error::autopin_errors error, QString opt) {
 			break;
 		else if (opt == "file_open")
 			setError();
+		else if (opt == "topology")
+			setError();
+		else if (opt == "numa_maps")
+			break;
+		else if (opt == "migrate_pages")
+			break;
 
 		break;
 	case COMM:
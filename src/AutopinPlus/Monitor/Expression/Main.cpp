@@ -0,0 +1,271 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Monitor/Expression/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::MONITOR, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <algorithm>						// for find, min
+#include <qregexp.h>						// for QRegExp
+#include <qstringlist.h>					// for QStringList
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Expression {
+
+Main::Main(QString name, Configuration *config, const PerformanceMonitor::monitor_list &monitors,
+		   const AutopinContext &context)
+	: PerformanceMonitor(name, config, context), monitors(monitors) {
+	type = "expression";
+
+	// Whether bigger values are better depends on the expression, so this has to be configured explicitly.
+	valtype = PerformanceMonitor::montype::UNKNOWN;
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("  :: Initializing " + name + " (" + type + ")");
+
+	if (config->configOptionExists(name + ".expression") <= 0) {
+		context.report(Error::BAD_CONFIG, "option_missing", name + ".init() failed: No expression configured.");
+		return;
+	}
+
+	// The expression may contain spaces, so the parts of the option have to be joined again
+	expression = config->getConfigOptionList(name + ".expression").join(" ");
+
+	try {
+		parse();
+
+		if (config->configOptionExists(name + ".valtype") > 0)
+			valtype = readMontype(config->getConfigOption(name + ".valtype"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (config->configOptionBool(name + ".cumulative"))
+		cumulative = config->getConfigOptionBool(name + ".cumulative");
+
+	context.info("     - " + name + ".expression = " + expression);
+	context.info("     - " + name + ".cumulative = " + QString(cumulative ? "true" : "false"));
+	context.info("     - " + name + ".valtype = " + showMontype(valtype));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result;
+
+	result.push_back(Configuration::configopt("expression", QStringList(expression)));
+	result.push_back(Configuration::configopt("cumulative", QStringList(cumulative ? "true" : "false")));
+
+	if (valtype != PerformanceMonitor::UNKNOWN) {
+		result.push_back(Configuration::configopt("valtype", QStringList(showMontype(valtype))));
+	}
+
+	return result;
+}
+
+void Main::start(int tid) {
+	// Start all monitors back to back, so they measure the same window
+	for (auto monitor : operands) CHECK_ERRORV(monitor->start(tid));
+
+	tasks.insert(tid);
+}
+
+double Main::value(int tid) {
+	if (tasks.find(tid) == tasks.end()) {
+		context.report(Error::MONITOR, "value",
+					   name + ".value(" + QString::number(tid) + ") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	std::map<PerformanceMonitor *, double> values;
+	for (auto monitor : operands) CHECK_ERROR(values[monitor] = monitor->value(tid), 0);
+
+	return evaluate([&](PerformanceMonitor *monitor) { return values[monitor]; });
+}
+
+double Main::stop(int tid) {
+	if (tasks.find(tid) == tasks.end()) {
+		context.report(Error::MONITOR, "stop",
+					   name + ".stop(" + QString::number(tid) + ") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	std::map<PerformanceMonitor *, double> values;
+	for (auto monitor : operands) CHECK_ERROR(values[monitor] = monitor->stop(tid), 0);
+
+	tasks.erase(tid);
+
+	return evaluate([&](PerformanceMonitor *monitor) { return values[monitor]; });
+}
+
+void Main::clear(int tid) {
+	for (auto monitor : operands) monitor->clear(tid);
+
+	tasks.erase(tid);
+}
+
+ProcessTree::autopin_tid_list Main::getMonitoredTasks() { return tasks; }
+
+double Main::getCoverage(int tid) {
+	// The expression is only as reliable as its least covered operand
+	double result = 1;
+	for (auto monitor : operands) result = std::min(result, monitor->getCoverage(tid));
+
+	return result;
+}
+
+bool Main::isProcessWide() {
+	// Tasks created during a measurement are only covered if all operands inherit their counters
+	for (auto monitor : operands) {
+		if (!monitor->isProcessWide()) return false;
+	}
+
+	return !operands.empty();
+}
+
+bool Main::isCumulative() { return cumulative; }
+
+void Main::parse() {
+	position = 0;
+	program.clear();
+	operands.clear();
+
+	parseSum();
+
+	if (!peek().isEmpty()) throw Exception("Unexpected \"" + peek() + "\" in expression \"" + expression + "\".");
+}
+
+void Main::parseSum() {
+	parseProduct();
+
+	while (peek() == "+" || peek() == "-") {
+		char op = next()[0].toLatin1();
+		parseProduct();
+		program.push_back({op, 0, nullptr});
+	}
+}
+
+void Main::parseProduct() {
+	parseFactor();
+
+	while (peek() == "*" || peek() == "/") {
+		char op = next()[0].toLatin1();
+		parseFactor();
+		program.push_back({op, 0, nullptr});
+	}
+}
+
+void Main::parseFactor() {
+	QString token = next();
+
+	if (token.isEmpty()) throw Exception("Unexpected end of expression \"" + expression + "\".");
+
+	if (token == "(") {
+		parseSum();
+		if (next() != ")") throw Exception("Missing \")\" in expression \"" + expression + "\".");
+	} else if (token == "-") {
+		parseFactor();
+		program.push_back({'n', 0, nullptr});
+	} else if (token[0].isDigit() || token[0] == '.') {
+		bool ok;
+		double constant = token.toDouble(&ok);
+		if (!ok) throw Exception("Invalid number \"" + token + "\" in expression \"" + expression + "\".");
+		program.push_back({'c', constant, nullptr});
+	} else if (token[0].isLetter() || token[0] == '_') {
+		PerformanceMonitor *monitor = nullptr;
+		for (auto candidate : monitors) {
+			if (candidate->getName() == token) monitor = candidate;
+		}
+
+		if (monitor == nullptr) throw Exception("Unknown performance monitor \"" + token + "\".");
+		if (monitor->getType() == type)
+			throw Exception("Performance monitor \"" + token + "\" is an expression itself.");
+
+		if (std::find(operands.begin(), operands.end(), monitor) == operands.end()) operands.push_back(monitor);
+		program.push_back({'m', 0, monitor});
+	} else {
+		throw Exception("Unexpected \"" + token + "\" in expression \"" + expression + "\".");
+	}
+}
+
+QString Main::peek() {
+	// Names of monitors may contain dashes and dots, so subtractions have to be separated by spaces
+	QRegExp token("\\s*([A-Za-z_][A-Za-z0-9_.-]*|[0-9.]+([eE][+-]?[0-9]+)?|\\S)");
+
+	if (token.indexIn(expression, position) != position) {
+		next_position = position;
+		return "";
+	}
+
+	next_position = position + token.matchedLength();
+	return token.cap(1);
+}
+
+QString Main::next() {
+	QString result = peek();
+	position = next_position;
+	return result;
+}
+
+double Main::evaluate(const std::function<double(PerformanceMonitor *)> &read) {
+	std::vector<double> stack;
+
+	for (const auto &elem : program) {
+		if (elem.kind == 'c') {
+			stack.push_back(elem.constant);
+		} else if (elem.kind == 'm') {
+			stack.push_back(read(elem.monitor));
+		} else if (elem.kind == 'n') {
+			stack.back() = -stack.back();
+		} else {
+			double b = stack.back();
+			stack.pop_back();
+			double &a = stack.back();
+
+			switch (elem.kind) {
+			case '+':
+				a += b;
+				break;
+			case '-':
+				a -= b;
+				break;
+			case '*':
+				a *= b;
+				break;
+			case '/':
+				a = (b != 0) ? a / b : 0;
+				break;
+			}
+		}
+	}
+
+	return stack.back();
+}
+
+} // namespace Expression
+} // namespace Monitor
+} // namespace AutopinPlus
@@ -44,13 +44,15 @@
 #include <sys/ioctl.h>		   // for ioctl
 #include <unistd.h>			   // for close, read, syscall, etc
 #include <utility>			   // for pair
+#include <vector>			   // for vector
 
 namespace AutopinPlus {
 namespace Monitor {
 namespace GPerf {
 
-Main::Main(QString name, Configuration *config, const AutopinContext &context)
-	: PerformanceMonitor(name, config, context) {
+Main::Main(QString name, Configuration *config, const PerformanceMonitor::monitor_list &monitors,
+		   const AutopinContext &context)
+	: PerformanceMonitor(name, config, context), monitors(monitors) {
 	// Set the "type" field of the base class to the name of our monitor.
 	type = "gperf";
 
@@ -92,6 +94,10 @@ void Main::init() {
 		return;
 	}
 
+	// The kernel multiplexes the counters if more events are requested than the PMU provides. The times the counters
+	// were enabled and running are always read, so the values can be extrapolated to the whole measurement.
+	sensor.attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
 	// Read and parse the "valtype" option
 	if (config->configOptionExists(name + ".valtype") > 0) {
 		try {
@@ -104,6 +110,43 @@ void Main::init() {
 		}
 	}
 
+	// Read the "inherit" option
+	if (config->configOptionBool(name + ".inherit")) {
+		inherit = config->getConfigOptionBool(name + ".inherit");
+		sensor.attr.inherit = inherit ? 1 : 0;
+		context.info("     - " + name + ".inherit = " + QString(inherit ? "true" : "false"));
+	}
+
+	// Read the "group" option and join the group of the given monitor
+	if (config->configOptionExists(name + ".group") > 0) {
+		group = config->getConfigOption(name + ".group");
+
+		Main *candidate = nullptr;
+		for (auto monitor : monitors) {
+			if (monitor->getName() == group) candidate = dynamic_cast<Main *>(monitor);
+		}
+
+		// The kernel can't read inherited counters with PERF_FORMAT_GROUP
+		if (inherit || (candidate != nullptr && config->configOptionBool(group + ".inherit") &&
+						config->getConfigOptionBool(group + ".inherit"))) {
+			context.report(Error::BAD_CONFIG, "inconsistent",
+						   name + ".init() failed: Inherited counters can't be part of a group.");
+			return;
+		}
+
+		if (candidate == nullptr || candidate == this || config->configOptionExists(group + ".group") > 0) {
+			context.report(Error::BAD_CONFIG, "inconsistent", name + ".init() failed: \"" + group +
+																  "\" is not a gperf monitor leading a group.");
+			return;
+		}
+
+		leader = candidate;
+		leader->leader = leader;
+		leader->members.append(this);
+
+		context.info("     - " + name + ".group = " + group);
+	}
+
 	context.disableIndentation();
 }
 
@@ -120,10 +163,20 @@ Configuration::configopts Main::getConfigOpts() {
 		result.push_back(Configuration::configopt("valtype", QStringList(showMontype(valtype))));
 	}
 
+	if (!group.isEmpty()) result.push_back(Configuration::configopt("group", QStringList(group)));
+
+	if (inherit) result.push_back(Configuration::configopt("inherit", QStringList("true")));
+
 	return result;
 }
 
 void Main::start(int thread) {
+	// The counters of a group are managed by its leader
+	if (leader != nullptr) {
+		leader->groupStart(this, thread);
+		return;
+	}
+
 	// If we already have a monitor for that thread, disable, reset, and re-enable it.
 	if (threads.contains(thread)) {
 		// First disable all monitors for that thread.
@@ -156,8 +209,7 @@ void Main::start(int thread) {
 	} else {
 		// Create a new monitor on all the processors specified either by the user or by the sensor itself. If none are
 		// specified, monitor all processors.
-		for (auto processor :
-			 !processors.isEmpty() ? processors : !sensor.processors.isEmpty() ? sensor.processors : QList<int>{-1}) {
+		for (auto processor : counterProcessors()) {
 			int fd;
 
 			/*
@@ -195,16 +247,12 @@ void Main::start(int thread) {
 			 * processors to monitor, either supplied by user or automatically
 			 * determined.
 			 *
-			 * The fourth argument (group_fd) is always set to -1, which tells the
-			 * kernel to create a new group for every counter because grouping
-			 * counters together (so that they start and stop at the same time and
-			 * therefore actually monitor the same time interval) does not seem to
-			 * work reliably, especially with counters which also don't support
-			 * thread-specific monitoring. However, since all the counters are first
-			 * created in a disabled state and then enabled in one batch, this
-			 * shouldn't matter too much, unless the measurement time is really
-			 * small or you start comparing or dividing the indivual results, which
-			 * you shouldn't do anyway (adding them is fine though).
+			 * The fourth argument (group_fd) is set to -1 here, which tells the
+			 * kernel to create a new group for every counter. Counters which have
+			 * to cover exactly the same interval (e.g. for computing ratios) can be
+			 * grouped explicitly with the "group" option, see groupStart(). This
+			 * requires all counters of the group to support thread-specific
+			 * monitoring.
 			 *
 			 * The fifth argument (flags) is always 0 because we don't need any of
 			 * the available flags.
@@ -239,6 +287,8 @@ void Main::start(int thread) {
 }
 
 double Main::value(int thread) {
+	if (leader != nullptr) return leader->groupValue(this, thread);
+
 	// Check if we are actually monitoring that thread. If not, error out.
 	if (!threads.contains(thread)) {
 		context.report(Error::MONITOR, "value",
@@ -247,17 +297,18 @@ double Main::value(int thread) {
 	}
 
 	double result = 0;
+	uint64_t enabled = 0, running = 0;
 
 	// Summarize the values of all counters which we have created for that thread. This
 	// makes sense, because we might have a counter which only counts on one processor core
 	// or socket, in which case the start() function has created one counter for every such
 	// unit.
 	for (auto fd : threads[thread]) {
-		uint64_t raw;
+		// All counters return unsigned 64-bit integer values. Due to the read format set in
+		// init() every value is followed by the times the counter was enabled and running.
+		uint64_t raw[3];
 
-		// All counters return unsigned 64-bit integer values, which can be read one
-		// value at a time.
-		if (read(fd, &raw, sizeof(raw)) == -1) {
+		if (read(fd, raw, sizeof(raw)) < (ssize_t)sizeof(raw)) {
 			context.report(Error::MONITOR, "value",
 						   name + ".value(" + QString::number(thread) + ") failed: Could not read from monitor.");
 			return 0;
@@ -265,10 +316,16 @@ double Main::value(int thread) {
 
 		// Some counters return values which need to be scaled before they can be used
 		// meaningfully. If this isn't the case, "sensor.scale" will be 1.0, so we can
-		// safely multiply here.
-		result += raw * sensor.scale;
+		// safely multiply here. If the counter has been multiplexed, the value is
+		// extrapolated to the whole time it was enabled.
+		if (raw[2] > 0) result += raw[0] * sensor.scale * raw[1] / raw[2];
+
+		enabled += raw[1];
+		running += raw[2];
 	}
 
+	coverage[thread] = (enabled > 0) ? (double)running / enabled : 1;
+
 	return result;
 }
 
@@ -293,6 +350,11 @@ double Main::stop(int thread) {
 }
 
 void Main::clear(int thread) {
+	if (leader != nullptr) {
+		leader->groupClear(this, thread);
+		return;
+	}
+
 	// Check if we are actually monitoring that thread. If not, just silently ignore it.
 	if (threads.contains(thread)) {
 		// Close all the counters which have been created for that thread.
@@ -317,6 +379,13 @@ ProcessTree::autopin_tid_list Main::getMonitoredTasks() {
 		result.insert(thread);
 	}
 
+	// The threads monitored by a group are stored by its leader
+	if (leader != nullptr) {
+		for (auto thread : leader->groups.keys()) {
+			if (leader->groups[thread].active.count(this) > 0) result.insert(thread);
+		}
+	}
+
 	return result;
 }
 
@@ -325,6 +394,14 @@ QString Main::getUnit() {
 	return sensor.unit;
 }
 
+bool Main::isProcessWide() { return inherit; }
+
+double Main::getCoverage(int thread) {
+	// All counters of a group are scheduled together, so they share the coverage stored by the leader.
+	if (leader != nullptr) return leader->coverage.value(thread, 1);
+	return coverage.value(thread, 1);
+}
+
 Sensor Main::readSensor(const QString &input) {
 	Sensor result;
 
@@ -917,6 +994,156 @@ int Main::perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int
 	return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
 }
 
+void Main::groupStart(Main *monitor, int thread) {
+	// If the group is already monitoring the thread, reset all of its counters together.
+	if (groups.contains(thread)) {
+		group_state &state = groups[thread];
+
+		for (const auto &fds : state.fds) {
+			if (ioctl(fds.first(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP) == -1 ||
+				ioctl(fds.first(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) == -1 ||
+				ioctl(fds.first(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1) {
+				context.report(Error::MONITOR, "reset", monitor->name + ".start(" + QString::number(thread) +
+															") failed: Could not reset group.");
+				return;
+			}
+		}
+
+		state.values.clear();
+		state.unread.clear();
+		state.active.insert(monitor);
+		return;
+	}
+
+	// Otherwise open one group per processor. Only the leader is created in a disabled state, the other counters
+	// are enabled and disabled together with it.
+	QList<Main *> order = members;
+	order.prepend(this);
+
+	group_state state;
+
+	for (auto processor : counterProcessors()) {
+		QList<int> fds;
+
+		for (auto member : order) {
+			perf_event_attr attr = member->sensor.attr;
+			attr.read_format |= PERF_FORMAT_GROUP;
+			attr.disabled = fds.isEmpty() ? 1 : 0;
+
+			int fd = perf_event_open(&attr, thread, processor, fds.isEmpty() ? -1 : fds.first(), 0);
+			if (fd < 0) {
+				context.report(Error::MONITOR, "create", member->name + ".start(" + QString::number(thread) +
+															 ") failed: Could not add monitor to group (" +
+															 QString(strerror(errno)) + ").");
+				state.fds.append(fds);
+				groupClose(state.fds);
+				return;
+			}
+
+			fds.append(fd);
+		}
+
+		state.fds.append(fds);
+	}
+
+	for (const auto &fds : state.fds) {
+		if (ioctl(fds.first(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1) {
+			context.report(Error::MONITOR, "start",
+						   monitor->name + ".start(" + QString::number(thread) + ") failed: Could not enable group.");
+			groupClose(state.fds);
+			return;
+		}
+	}
+
+	state.active.insert(monitor);
+	groups[thread] = state;
+}
+
+double Main::groupValue(Main *monitor, int thread) {
+	if (!groups.contains(thread) || groups[thread].active.count(monitor) == 0) {
+		context.report(Error::MONITOR, "value", monitor->name + ".value(" + QString::number(thread) +
+													") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	group_state &state = groups[thread];
+
+	// Only read the group again once the monitor has used the value of the last read
+	if (state.values.isEmpty() || state.unread.count(monitor) == 0) {
+		if (!groupRead(state)) {
+			context.report(Error::MONITOR, "value", monitor->name + ".value(" + QString::number(thread) +
+														") failed: Could not read from group.");
+			return 0;
+		}
+
+		state.unread = state.active;
+		coverage[thread] = state.coverage;
+	}
+
+	state.unread.erase(monitor);
+
+	return state.values[(monitor == this) ? 0 : members.indexOf(monitor) + 1];
+}
+
+void Main::groupClear(Main *monitor, int thread) {
+	if (!groups.contains(thread)) return;
+
+	group_state &state = groups[thread];
+	state.active.erase(monitor);
+	state.unread.erase(monitor);
+
+	if (!state.active.empty()) return;
+
+	groupClose(state.fds);
+	groups.remove(thread);
+}
+
+bool Main::groupRead(group_state &state) {
+	QList<Main *> order = members;
+	order.prepend(this);
+
+	QList<double> values;
+	for (int i = 0; i < order.size(); i++) values.append(0);
+
+	// With PERF_FORMAT_GROUP, the leader returns the number of counters, the times the group was enabled and running
+	// and the values of all counters
+	std::vector<uint64_t> buffer(3 + order.size());
+	uint64_t enabled = 0, running = 0;
+
+	for (const auto &fds : state.fds) {
+		ssize_t size = read(fds.first(), buffer.data(), buffer.size() * sizeof(uint64_t));
+		if (size < (ssize_t)(buffer.size() * sizeof(uint64_t)) || buffer[0] != (uint64_t)order.size()) return false;
+
+		// A multiplexed group is extrapolated to the whole time it was enabled
+		if (buffer[2] > 0) {
+			for (int i = 0; i < order.size(); i++)
+				values[i] += buffer[3 + i] * order[i]->sensor.scale * buffer[1] / buffer[2];
+		}
+
+		enabled += buffer[1];
+		running += buffer[2];
+	}
+
+	state.coverage = (enabled > 0) ? (double)running / enabled : 1;
+	state.values = values;
+
+	return true;
+}
+
+void Main::groupClose(const QList<QList<int>> &fds) {
+	for (const auto &group_fds : fds) {
+		for (int i = group_fds.size() - 1; i >= 0; i--) close(group_fds[i]);
+	}
+}
+
+QList<int> Main::counterProcessors() {
+	// Monitor the processors specified either by the user or by the sensor itself. If none are specified, monitor
+	// all processors.
+	if (!processors.isEmpty()) return processors;
+	if (!sensor.processors.isEmpty()) return sensor.processors;
+	return QList<int>{-1};
+}
+
 } // namespace GPerf
 } // namespace Monitor
 } // namespace AutopinPlus
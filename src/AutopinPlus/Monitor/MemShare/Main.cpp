@@ -0,0 +1,479 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Monitor/MemShare/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::MONITOR, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <algorithm>						// for max, min
+#include <errno.h>							// for errno
+#include <poll.h>							// for poll, pollfd
+#include <qmutex.h>							// for QMutexLocker
+#include <qstringlist.h>					// for QStringList
+#include <set>								// for set
+#include <string.h>							// for memcpy, memset, strerror
+#include <syscall.h>						// for __NR_perf_event_open
+#include <sys/ioctl.h>						// for ioctl
+#include <sys/mman.h>						// for mmap, munmap
+#include <unistd.h>							// for close, syscall, sysconf
+#include <vector>							// for vector
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace MemShare {
+
+Main::Main(QString name, Configuration *config, const AutopinContext &context)
+	: PerformanceMonitor(name, config, context), reader(*this) {
+	type = "memshare";
+
+	// The number of shared accesses says nothing about the performance, so this has to be configured explicitly.
+	valtype = PerformanceMonitor::montype::UNKNOWN;
+
+	// By default, sample loads with a latency of at least 3 cycles (MEM_TRANS_RETIRED.LOAD_LATENCY on Intel
+	// processors since Nehalem).
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_RAW;
+	attr.config = 0x1cd;
+	attr.config1 = 3;
+	attr.precise_ip = 2;
+	attr.sample_period = 1000;
+	attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_ADDR | PERF_SAMPLE_DATA_SRC;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+}
+
+Main::~Main() {
+	if (reader.isRunning()) reader.deinit();
+
+	for (auto thread : samplers.keys()) closeSampler(thread);
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("  :: Initializing " + name + " (" + type + ")");
+
+	try {
+		if (config->configOptionExists(name + ".event_type") > 0)
+			attr.type = Tools::readULong(config->getConfigOption(name + ".event_type"));
+
+		if (config->configOptionExists(name + ".event_config") > 0)
+			attr.config = Tools::readULong(config->getConfigOption(name + ".event_config"));
+
+		if (config->configOptionExists(name + ".event_config1") > 0)
+			attr.config1 = Tools::readULong(config->getConfigOption(name + ".event_config1"));
+
+		if (config->configOptionExists(name + ".precise_ip") > 0)
+			attr.precise_ip = Tools::readInt(config->getConfigOption(name + ".precise_ip"));
+
+		if (config->configOptionExists(name + ".sample_period") > 0)
+			attr.sample_period = Tools::readULong(config->getConfigOption(name + ".sample_period"));
+
+		if (config->configOptionExists(name + ".pages") > 0)
+			pages = Tools::readInt(config->getConfigOption(name + ".pages"));
+
+		if (config->configOptionExists(name + ".line_size") > 0)
+			line_size = Tools::readInt(config->getConfigOption(name + ".line_size"));
+
+		if (config->configOptionExists(name + ".interval") > 0)
+			interval = Tools::readInt(config->getConfigOption(name + ".interval"));
+
+		if (config->configOptionExists(name + ".max_lines") > 0)
+			max_lines = Tools::readInt(config->getConfigOption(name + ".max_lines"));
+
+		if (config->configOptionExists(name + ".hitm_weight") > 0)
+			hitm_weight = Tools::readDouble(config->getConfigOption(name + ".hitm_weight"));
+
+		if (config->configOptionExists(name + ".valtype") > 0)
+			valtype = readMontype(config->getConfigOption(name + ".valtype"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	// The kernel requires the size of the ring buffer to be a power of two
+	if (pages <= 0 || (pages & (pages - 1)) != 0 || line_size <= 0 || (line_size & (line_size - 1)) != 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: 'pages' and 'line_size' have to be powers of two.");
+		return;
+	}
+
+	if (attr.sample_period == 0 || attr.precise_ip > 3 || interval <= 0 || hitm_weight < 0 || max_lines < 2) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: Invalid value for 'sample_period', "
+																  "'precise_ip', 'interval', 'hitm_weight' or "
+																  "'max_lines'.");
+		return;
+	}
+
+	page_size = sysconf(_SC_PAGESIZE);
+
+	// Wake up the reader when a ring buffer is half full, in addition to the regular interval
+	attr.watermark = 1;
+	attr.wakeup_watermark = pages * page_size / 2;
+
+	context.info("     - " + name + ".event_type = " + QString::number(attr.type));
+	context.info("     - " + name + ".event_config = 0x" + QString::number(attr.config, 16));
+	context.info("     - " + name + ".event_config1 = 0x" + QString::number(attr.config1, 16));
+	context.info("     - " + name + ".precise_ip = " + QString::number(attr.precise_ip));
+	context.info("     - " + name + ".sample_period = " + QString::number(attr.sample_period));
+	context.info("     - " + name + ".pages = " + QString::number(pages));
+	context.info("     - " + name + ".line_size = " + QString::number(line_size));
+	context.info("     - " + name + ".interval = " + QString::number(interval));
+	context.info("     - " + name + ".max_lines = " + QString::number(max_lines));
+	context.info("     - " + name + ".hitm_weight = " + QString::number(hitm_weight));
+	context.info("     - " + name + ".valtype = " + showMontype(valtype));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result;
+
+	result.push_back(Configuration::configopt("event_type", QStringList(QString::number(attr.type))));
+	result.push_back(Configuration::configopt("event_config", QStringList("0x" + QString::number(attr.config, 16))));
+	result.push_back(Configuration::configopt("event_config1", QStringList("0x" + QString::number(attr.config1, 16))));
+	result.push_back(Configuration::configopt("precise_ip", QStringList(QString::number(attr.precise_ip))));
+	result.push_back(Configuration::configopt("sample_period", QStringList(QString::number(attr.sample_period))));
+	result.push_back(Configuration::configopt("pages", QStringList(QString::number(pages))));
+	result.push_back(Configuration::configopt("line_size", QStringList(QString::number(line_size))));
+	result.push_back(Configuration::configopt("interval", QStringList(QString::number(interval))));
+	result.push_back(Configuration::configopt("max_lines", QStringList(QString::number(max_lines))));
+	result.push_back(Configuration::configopt("hitm_weight", QStringList(QString::number(hitm_weight))));
+
+	if (valtype != PerformanceMonitor::UNKNOWN) {
+		result.push_back(Configuration::configopt("valtype", QStringList(showMontype(valtype))));
+	}
+
+	return result;
+}
+
+void Main::start(int thread) {
+	QMutexLocker locker(&mutex);
+
+	// Restart the sampling for threads which are already being monitored
+	closeSampler(thread);
+
+	// A new measurement starts, forget the samples of the last one.
+	if (samplers.isEmpty()) {
+		lines.clear();
+		lost = 0;
+	}
+
+	sampler s;
+
+	if ((s.fd = perf_event_open(&attr, thread, -1, -1, 0)) < 0) {
+		context.report(Error::MONITOR, "create", name + ".start(" + QString::number(thread) +
+													 ") failed: Could not create monitor (" +
+													 QString(strerror(errno)) + ").");
+		return;
+	}
+
+	// The ring buffer consists of one header page followed by the data pages
+	s.buffer = mmap(nullptr, (pages + 1) * page_size, PROT_READ | PROT_WRITE, MAP_SHARED, s.fd, 0);
+	if (s.buffer == MAP_FAILED) {
+		close(s.fd);
+		context.report(Error::MONITOR, "create", name + ".start(" + QString::number(thread) +
+													 ") failed: Could not map the ring buffer (" +
+													 QString(strerror(errno)) + ").");
+		return;
+	}
+
+	samplers[thread] = s;
+
+	if (ioctl(s.fd, PERF_EVENT_IOC_ENABLE) == -1) {
+		context.report(Error::MONITOR, "start",
+					   name + ".start(" + QString::number(thread) + ") failed: Could not enable monitor.");
+		return;
+	}
+
+	if (!reader.isRunning()) reader.start();
+}
+
+double Main::value(int thread) {
+	QMutexLocker locker(&mutex);
+
+	if (!samplers.contains(thread)) {
+		context.report(Error::MONITOR, "value",
+					   name + ".value(" + QString::number(thread) + ") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	// Sharing can only be detected if the samples of all threads are up to date
+	drainAll();
+
+	if (lost > 0) context.debug(name + ": " + QString::number(lost) + " samples have been lost so far.");
+
+	double result = 0;
+
+	for (const auto &line : lines) {
+		if (line.second.size() < 2) continue;
+
+		auto it = line.second.find(thread);
+		if (it != line.second.end()) result += it->second.accesses;
+	}
+
+	return result;
+}
+
+double Main::stop(int thread) {
+	double result = value(thread);
+
+	if (context.autopinErrorState() != autopin_estate::AUTOPIN_NOERROR) {
+		context.report(Error::MONITOR, "stop", name + ".stop(" + QString::number(thread) + ") failed: value() failed.");
+		return 0;
+	}
+
+	// The samples are kept, so the affinity graph is still available after the measurement.
+	clear(thread);
+
+	return result;
+}
+
+void Main::clear(int thread) {
+	QMutexLocker locker(&mutex);
+
+	closeSampler(thread);
+}
+
+void Main::closeSampler(int thread) {
+	if (!samplers.contains(thread)) return;
+
+	sampler s = samplers.take(thread);
+
+	munmap(s.buffer, (pages + 1) * page_size);
+
+	if (close(s.fd) == -1) {
+		context.report(Error::MONITOR, "stop", name + ".clear(" + QString::number(thread) +
+												   ") failed: Could not close a file descriptor (" +
+												   QString(strerror(errno)) + ").");
+	}
+}
+
+ProcessTree::autopin_tid_list Main::getMonitoredTasks() {
+	QMutexLocker locker(&mutex);
+
+	ProcessTree::autopin_tid_list result;
+
+	for (auto thread : samplers.keys()) {
+		result.insert(thread);
+	}
+
+	return result;
+}
+
+QString Main::getUnit() { return "samples"; }
+
+Main::affinity_graph Main::getAffinityGraph() {
+	QMutexLocker locker(&mutex);
+
+	affinity_graph result;
+
+	drainAll();
+
+	// The affinities are only representative if few samples are missing
+	if (lost > 0) {
+		context.info("  :: " + name + ": " + QString::number(lost) +
+					 " samples have been lost because the ring buffers were full, consider increasing 'pages' or "
+					 "'sample_period'.");
+	}
+
+	for (const auto &line : lines) {
+		for (auto a = line.second.begin(); a != line.second.end(); a++) {
+			auto b = a;
+			for (b++; b != line.second.end(); b++) {
+				double weight = std::min(a->second.accesses, b->second.accesses) +
+								hitm_weight * std::min(a->second.hitm + b->second.hitm,
+													   std::min(a->second.accesses, b->second.accesses));
+
+				// The threads in the map are sorted, so a->first is always the smaller id
+				result[std::make_pair(a->first, b->first)] += weight;
+			}
+		}
+	}
+
+	return result;
+}
+
+void Main::drain(int thread) {
+	sampler &s = samplers[thread];
+
+	auto header = static_cast<perf_event_mmap_page *>(s.buffer);
+	auto data = static_cast<char *>(s.buffer) + page_size;
+	uint64_t size = pages * page_size;
+
+	uint64_t head = header->data_head;
+	// Make sure the data is read after data_head, see perf_event_open(2)
+	__sync_synchronize();
+	uint64_t tail = header->data_tail;
+
+	std::vector<char> record;
+
+	// Layout of a sample with PERF_SAMPLE_TID, PERF_SAMPLE_ADDR and PERF_SAMPLE_DATA_SRC
+	struct sample {
+		perf_event_header header;
+		uint32_t pid, tid;
+		uint64_t addr;
+		uint64_t data_src;
+	};
+
+	while (tail < head) {
+		perf_event_header event;
+
+		// Records may wrap around the end of the buffer, so copy them byte by byte if necessary
+		for (uint64_t i = 0; i < sizeof(event); i++) reinterpret_cast<char *>(&event)[i] = data[(tail + i) % size];
+
+		// A record which doesn't fit into the buffer can only be garbage, so the position of the next record is
+		// unknown. Skip all data which has been written so far, otherwise the buffer would never be read again.
+		if (event.size < sizeof(event) || event.size > size || event.size > head - tail) {
+			lost += std::max<uint64_t>(1, (head - tail) / sizeof(sample));
+			tail = head;
+			break;
+		}
+
+		record.resize(event.size);
+		for (uint64_t i = 0; i < event.size; i++) record[i] = data[(tail + i) % size];
+
+		tail += event.size;
+
+		// Layout of a lost record
+		struct lost_samples {
+			perf_event_header header;
+			uint64_t id;
+			uint64_t lost;
+		};
+
+		if (event.type == PERF_RECORD_LOST && event.size >= sizeof(lost_samples)) {
+			lost_samples current;
+			memcpy(&current, record.data(), sizeof(current));
+			lost += current.lost;
+			continue;
+		}
+
+		if (event.type != PERF_RECORD_SAMPLE || event.size < sizeof(sample)) continue;
+
+		sample current;
+		memcpy(&current, record.data(), sizeof(current));
+
+		// Some events do not provide data addresses
+		if (current.addr == 0) continue;
+
+		perf_mem_data_src source;
+		source.val = current.data_src;
+
+		line_samples &counts = lines[current.addr / line_size][thread];
+		counts.accesses++;
+		if (source.mem_snoop & PERF_MEM_SNOOP_HITM) counts.hitm++;
+
+		if (lines.size() > (size_t)max_lines) age();
+	}
+
+	// Tell the kernel that the space can be reused
+	__sync_synchronize();
+	header->data_tail = tail;
+}
+
+void Main::age() {
+	// Halve the counts until enough lines have no samples left, lines which are used a lot stay the longest
+	while (lines.size() > (size_t)max_lines / 2) {
+		for (auto line = lines.begin(); line != lines.end();) {
+			for (auto it = line->second.begin(); it != line->second.end();) {
+				it->second.accesses /= 2;
+				it->second.hitm /= 2;
+
+				if (it->second.accesses == 0)
+					it = line->second.erase(it);
+				else
+					it++;
+			}
+
+			if (line->second.empty())
+				line = lines.erase(line);
+			else
+				line++;
+		}
+	}
+}
+
+void Main::drainAll() {
+	for (auto thread : samplers.keys()) drain(thread);
+}
+
+Main::Reader::Reader(Main &monitor) : monitor(monitor) {}
+
+void Main::Reader::deinit() {
+	exreq = true;
+	wait();
+}
+
+void Main::Reader::run() {
+	// Events of terminated threads are always readable, so they are only drained once per interval
+	std::set<int> hungup;
+
+	while (!exreq) {
+		// Threads are started and stopped while the reader is running, so the events are collected every round
+		std::vector<pollfd> fds;
+		std::vector<int> threads;
+		{
+			QMutexLocker locker(&monitor.mutex);
+
+			for (auto thread : monitor.samplers.keys()) {
+				if (hungup.count(thread) > 0) continue;
+
+				pollfd entry;
+				entry.fd = monitor.samplers[thread].fd;
+				entry.events = POLLIN;
+				entry.revents = 0;
+				fds.push_back(entry);
+				threads.push_back(thread);
+			}
+		}
+
+		// Wait until a ring buffer is half full, but drain all of them at least once per interval
+		poll(fds.data(), fds.size(), monitor.interval);
+
+		for (size_t i = 0; i < fds.size(); i++) {
+			if (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) hungup.insert(threads[i]);
+		}
+
+		QMutexLocker locker(&monitor.mutex);
+		monitor.drainAll();
+
+		// Forget the threads which are not monitored any more, their ids may be reused
+		for (auto it = hungup.begin(); it != hungup.end();) {
+			if (!monitor.samplers.contains(*it))
+				it = hungup.erase(it);
+			else
+				it++;
+		}
+	}
+}
+
+int Main::perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+	return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+} // namespace MemShare
+} // namespace Monitor
+} // namespace AutopinPlus
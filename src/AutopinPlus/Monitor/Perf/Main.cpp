@@ -39,7 +39,7 @@ namespace Monitor {
 namespace Perf {
 
 Main::Main(QString name, Configuration *config, const AutopinContext &context)
-	: PerformanceMonitor(name, config, context) {
+	: PerformanceMonitor(name, config, context), inherit(false) {
 	valtype = PerformanceMonitor::MAX;
 	type = "perf";
 }
@@ -78,6 +78,10 @@ void Main::init() {
 	} else
 		REPORTV(Error::BAD_CONFIG, "option_missing", "No event type specified for performance monitor " + name);
 
+	// Count the tasks created by a monitored task as well
+	if (config->configOptionBool(name + ".inherit")) inherit = config->getConfigOptionBool(name + ".inherit");
+	if (inherit) context.info("     - Counters are inherited by new tasks");
+
 	context.disableIndentation();
 }
 
@@ -86,6 +90,7 @@ Configuration::configopts Main::getConfigOpts() {
 
 	result.push_back(
 		Configuration::configopt("event_type", QStringList(config->getConfigOption(name + ".event_type"))));
+	result.push_back(Configuration::configopt("inherit", QStringList(inherit ? "true" : "false")));
 
 	return result;
 }
@@ -128,13 +133,18 @@ void Main::start(int tid) {
 double Main::value(int tid) {
 	if (perfds.find(tid) == perfds.end()) return 0;
 
-	__u64 val;
+	// The value is followed by the times the counter was enabled and running
+	__u64 val[3];
 	int fd = perfds[tid];
 
-	if (read(fd, &val, sizeof(__u64)) == -1)
+	if (read(fd, val, sizeof(val)) < (ssize_t)sizeof(val))
 		REPORT(Error::MONITOR, "value", "Could not read perf result for " + QString::number(tid), 0);
 
-	double result = val;
+	// Extrapolate the value if the counter has been multiplexed with other events
+	double result = 0;
+	if (val[2] > 0) result = (double)val[0] * val[1] / val[2];
+
+	coverage[tid] = (val[1] > 0) ? (double)val[2] / val[1] : 1;
 
 	return result;
 }
@@ -170,6 +180,15 @@ ProcessTree::autopin_tid_list Main::getMonitoredTasks() {
 	return result;
 }
 
+double Main::getCoverage(int tid) {
+	auto it = coverage.find(tid);
+	if (it == coverage.end()) return 1;
+
+	return it->second;
+}
+
+bool Main::isProcessWide() { return inherit; }
+
 int Main::createPerfCounter(int tid) {
 	// Structure storing the preferences for perf
 	struct perf_event_attr attr;
@@ -188,6 +207,8 @@ int Main::createPerfCounter(int tid) {
 	attr.type = PERF_TYPE_HARDWARE;
 	attr.config = event_type;
 	attr.disabled = 1;
+	attr.inherit = inherit ? 1 : 0;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
 
 	int fd = sys_perf_event_open(&attr, pid, cpu, group_fd, flags);
 
@@ -0,0 +1,112 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Monitor/Replay/Main.h>
+
+#include <AutopinPlus/Error.h>	   // for Error, Error::::MONITOR, etc
+#include <AutopinPlus/Exception.h> // for Exception
+#include <AutopinPlus/Tools.h>	   // for Tools
+#include <qstringlist.h>		   // for QStringList
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Replay {
+
+Main::Main(QString name, Configuration *config, OS::Simulator::OSServicesSimulator *service,
+		   const AutopinContext &context)
+	: PerformanceMonitor(name, config, context), service(service) {
+	type = "replay";
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("  :: Initializing " + name + " (" + type + ")");
+
+	// The recorded values determine whether bigger values are better
+	valtype = service->getValType();
+
+	try {
+		if (config->configOptionExists(name + ".noise") > 0) noise = config->getConfigOptionDouble(name + ".noise");
+		if (config->configOptionExists(name + ".seed") > 0)
+			seed = Tools::readInt(config->getConfigOption(name + ".seed"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (noise < 0) REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid noise: " + QString::number(noise));
+
+	generator.seed(seed);
+
+	context.info("     - " + name + ".noise = " + QString::number(noise));
+	context.info("     - " + name + ".seed = " + QString::number(seed));
+	context.info("     - " + name + ".valtype = " + showMontype(valtype));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result;
+
+	result.push_back(Configuration::configopt("noise", QStringList(QString::number(noise))));
+	result.push_back(Configuration::configopt("seed", QStringList(QString::number(seed))));
+	result.push_back(Configuration::configopt("valtype", QStringList(showMontype(valtype))));
+
+	return result;
+}
+
+void Main::start(int tid) { base[tid] = service->getWork(tid); }
+
+double Main::value(int tid) {
+	auto it = base.find(tid);
+
+	if (it == base.end()) {
+		context.report(Error::MONITOR, "value",
+					   name + ".value(" + QString::number(tid) + ") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	double result = service->getWork(tid) - it->second;
+
+	if (noise > 0) result *= 1 + std::normal_distribution<double>(0, noise)(generator);
+
+	return result;
+}
+
+double Main::stop(int tid) {
+	double result;
+	CHECK_ERROR(result = value(tid), 0);
+	base.erase(tid);
+	return result;
+}
+
+void Main::clear(int tid) { base.erase(tid); }
+
+ProcessTree::autopin_tid_list Main::getMonitoredTasks() {
+	ProcessTree::autopin_tid_list result;
+
+	for (const auto &entry : base) result.insert(entry.first);
+
+	return result;
+}
+
+} // namespace Replay
+} // namespace Monitor
+} // namespace AutopinPlus
@@ -0,0 +1,459 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Monitor/Sampling/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::MONITOR, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <algorithm>						// for max
+#include <errno.h>							// for errno, ENODEV
+#include <poll.h>							// for poll, pollfd
+#include <qmutex.h>							// for QMutexLocker
+#include <qstringlist.h>					// for QStringList
+#include <string.h>							// for memcpy, memset, strerror
+#include <syscall.h>						// for __NR_perf_event_open
+#include <sys/ioctl.h>						// for ioctl
+#include <sys/mman.h>						// for mmap, munmap
+#include <time.h>							// for clock_gettime, CLOCK_MONOTONIC
+#include <unistd.h>							// for close, syscall, sysconf
+#include <vector>							// for vector
+
+namespace AutopinPlus {
+namespace Monitor {
+namespace Sampling {
+
+Main::Main(QString name, Configuration *config, const AutopinContext &context)
+	: PerformanceMonitor(name, config, context), reader(*this) {
+	type = "sampling";
+
+	// By default, instructions are sampled, so more is better.
+	valtype = PerformanceMonitor::montype::MAX;
+
+	// By default, sample every millionth instruction executed in user space
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.sample_period = 1000000;
+	attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CPU;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	// Time stamps of the samples use the same clock as now()
+	attr.use_clockid = 1;
+	attr.clockid = CLOCK_MONOTONIC;
+}
+
+Main::~Main() { closeSamplers(); }
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("  :: Initializing " + name + " (" + type + ")");
+
+	try {
+		if (config->configOptionExists(name + ".event_type") > 0)
+			attr.type = Tools::readULong(config->getConfigOption(name + ".event_type"));
+
+		if (config->configOptionExists(name + ".event_config") > 0)
+			attr.config = Tools::readULong(config->getConfigOption(name + ".event_config"));
+
+		if (config->configOptionExists(name + ".sample_period") > 0)
+			attr.sample_period = Tools::readULong(config->getConfigOption(name + ".sample_period"));
+
+		if (config->configOptionExists(name + ".processors") > 0)
+			processors = Tools::readInts(config->getConfigOptionList(name + ".processors"));
+
+		if (config->configOptionExists(name + ".pages") > 0)
+			pages = Tools::readInt(config->getConfigOption(name + ".pages"));
+
+		if (config->configOptionExists(name + ".interval") > 0)
+			interval = Tools::readInt(config->getConfigOption(name + ".interval"));
+
+		if (config->configOptionExists(name + ".max_samples") > 0)
+			max_samples = Tools::readInt(config->getConfigOption(name + ".max_samples"));
+
+		if (config->configOptionExists(name + ".valtype") > 0)
+			valtype = readMontype(config->getConfigOption(name + ".valtype"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	// The kernel requires the size of the ring buffer to be a power of two
+	if (pages <= 0 || (pages & (pages - 1)) != 0) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: 'pages' has to be a power of two.");
+		return;
+	}
+
+	if (attr.sample_period == 0 || interval <= 0 || max_samples < 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Invalid value for 'sample_period', 'interval' or 'max_samples'.");
+		return;
+	}
+
+	page_size = sysconf(_SC_PAGESIZE);
+
+	// Wake up the reader when a ring buffer is half full, in addition to the regular interval
+	attr.watermark = 1;
+	attr.wakeup_watermark = pages * page_size / 2;
+
+	context.info("     - " + name + ".event_type = " + QString::number(attr.type));
+	context.info("     - " + name + ".event_config = 0x" + QString::number(attr.config, 16));
+	context.info("     - " + name + ".sample_period = " + QString::number(attr.sample_period));
+	if (!processors.isEmpty())
+		context.info("     - " + name + ".processors = " + Tools::showInts(processors).join(" "));
+	context.info("     - " + name + ".pages = " + QString::number(pages));
+	context.info("     - " + name + ".interval = " + QString::number(interval));
+	context.info("     - " + name + ".max_samples = " + QString::number(max_samples));
+	context.info("     - " + name + ".valtype = " + showMontype(valtype));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result;
+
+	result.push_back(Configuration::configopt("event_type", QStringList(QString::number(attr.type))));
+	result.push_back(Configuration::configopt("event_config", QStringList("0x" + QString::number(attr.config, 16))));
+	result.push_back(Configuration::configopt("sample_period", QStringList(QString::number(attr.sample_period))));
+
+	if (!processors.isEmpty()) {
+		result.push_back(Configuration::configopt("processors", Tools::showInts(processors)));
+	}
+
+	result.push_back(Configuration::configopt("pages", QStringList(QString::number(pages))));
+	result.push_back(Configuration::configopt("interval", QStringList(QString::number(interval))));
+	result.push_back(Configuration::configopt("max_samples", QStringList(QString::number(max_samples))));
+
+	if (valtype != PerformanceMonitor::UNKNOWN) {
+		result.push_back(Configuration::configopt("valtype", QStringList(showMontype(valtype))));
+	}
+
+	return result;
+}
+
+void Main::start(int thread) {
+	// The events are only opened once the first thread is monitored
+	if (samplers.isEmpty() && !openSamplers()) return;
+
+	QMutexLocker locker(&mutex);
+
+	// A new measurement starts, forget the samples of the last one.
+	if (!active()) {
+		drainAll();
+		threads.clear();
+
+		if (!controlSamplers(PERF_EVENT_IOC_ENABLE)) {
+			context.report(Error::MONITOR, "start",
+						   name + ".start(" + QString::number(thread) + ") failed: Could not enable monitor.");
+			return;
+		}
+	}
+
+	// Restart the sampling for threads which are already being monitored
+	thread_samples samples;
+	samples.start = now();
+	threads[thread] = samples;
+}
+
+double Main::value(int thread) {
+	QMutexLocker locker(&mutex);
+
+	auto it = threads.find(thread);
+	if (it == threads.end() || it->second.stop != 0) {
+		context.report(Error::MONITOR, "value",
+					   name + ".value(" + QString::number(thread) + ") failed: Thread is not being monitored.");
+		return 0;
+	}
+
+	// The reader might not have seen the latest samples yet
+	drainAll();
+
+	if (lost > 0) context.debug(name + ": " + QString::number(lost) + " samples have been lost so far.");
+
+	return it->second.count * attr.sample_period;
+}
+
+double Main::stop(int thread) {
+	double result = value(thread);
+
+	if (context.autopinErrorState() != autopin_estate::AUTOPIN_NOERROR) {
+		context.report(Error::MONITOR, "stop", name + ".stop(" + QString::number(thread) + ") failed: value() failed.");
+		return 0;
+	}
+
+	QMutexLocker locker(&mutex);
+
+	// The samples are kept until the next measurement is started
+	threads[thread].stop = now();
+
+	if (!active() && !controlSamplers(PERF_EVENT_IOC_DISABLE)) {
+		context.report(Error::MONITOR, "stop",
+					   name + ".stop(" + QString::number(thread) + ") failed: Could not disable monitor.");
+		return 0;
+	}
+
+	return result;
+}
+
+void Main::clear(int thread) {
+	QMutexLocker locker(&mutex);
+
+	if (threads.erase(thread) == 0) return;
+
+	if (!active()) controlSamplers(PERF_EVENT_IOC_DISABLE);
+}
+
+ProcessTree::autopin_tid_list Main::getMonitoredTasks() {
+	QMutexLocker locker(&mutex);
+
+	ProcessTree::autopin_tid_list result;
+
+	for (const auto &samples : threads) {
+		if (samples.second.stop == 0) result.insert(samples.first);
+	}
+
+	return result;
+}
+
+Main::sample_list Main::getSamples(int thread) {
+	QMutexLocker locker(&mutex);
+
+	drainAll();
+
+	auto it = threads.find(thread);
+	if (it == threads.end()) return sample_list();
+
+	return it->second.samples;
+}
+
+double Main::getRate(int thread) {
+	QMutexLocker locker(&mutex);
+
+	drainAll();
+
+	auto it = threads.find(thread);
+	if (it == threads.end()) return 0;
+
+	const thread_samples &samples = it->second;
+	uint64_t end = (samples.stop != 0) ? samples.stop : now();
+	if (end <= samples.start) return 0;
+
+	return samples.count / ((end - samples.start) / 1e9);
+}
+
+Main::Reader::Reader(Main &monitor) : monitor(monitor) {}
+
+void Main::Reader::deinit() {
+	exreq = true;
+	wait();
+}
+
+void Main::Reader::run() {
+	// The samplers don't change while the reader is running
+	std::vector<pollfd> fds;
+	for (const auto &s : monitor.samplers) {
+		pollfd entry;
+		entry.fd = s.fd;
+		entry.events = POLLIN;
+		entry.revents = 0;
+		fds.push_back(entry);
+	}
+
+	while (!exreq) {
+		// Wait until a ring buffer is half full, but drain all of them at least once per interval
+		poll(fds.data(), fds.size(), monitor.interval);
+
+		QMutexLocker locker(&monitor.mutex);
+		monitor.drainAll();
+	}
+}
+
+bool Main::openSamplers() {
+	QList<int> cpus = processors;
+	if (cpus.isEmpty()) {
+		for (int cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++) cpus.append(cpu);
+	}
+
+	for (auto cpu : cpus) {
+		sampler s;
+
+		// Monitor all threads on the processor, the samples of other threads are dropped when the buffer is drained
+		if ((s.fd = perf_event_open(&attr, -1, cpu, -1, 0)) < 0) {
+			// Offline processors can't be monitored
+			if (errno == ENODEV && processors.isEmpty()) continue;
+
+			context.report(Error::MONITOR, "create", name + ".start() failed: Could not create monitor on processor " +
+														 QString::number(cpu) + " (" + QString(strerror(errno)) +
+														 ").");
+			closeSamplers();
+			return false;
+		}
+
+		// The ring buffer consists of one header page followed by the data pages
+		s.buffer = mmap(nullptr, (pages + 1) * page_size, PROT_READ | PROT_WRITE, MAP_SHARED, s.fd, 0);
+		if (s.buffer == MAP_FAILED) {
+			::close(s.fd);
+			context.report(Error::MONITOR, "create", name + ".start() failed: Could not map the ring buffer (" +
+														 QString(strerror(errno)) + ").");
+			closeSamplers();
+			return false;
+		}
+
+		samplers.append(s);
+	}
+
+	reader.start();
+
+	return true;
+}
+
+void Main::closeSamplers() {
+	if (reader.isRunning()) reader.deinit();
+
+	for (const auto &s : samplers) {
+		munmap(s.buffer, (pages + 1) * page_size);
+		::close(s.fd);
+	}
+
+	samplers.clear();
+}
+
+bool Main::controlSamplers(unsigned long request) {
+	bool result = true;
+
+	for (const auto &s : samplers) {
+		if (ioctl(s.fd, request) == -1) result = false;
+	}
+
+	return result;
+}
+
+bool Main::active() {
+	for (const auto &samples : threads) {
+		if (samples.second.stop == 0) return true;
+	}
+
+	return false;
+}
+
+void Main::drainAll() {
+	for (const auto &s : samplers) drain(s);
+}
+
+void Main::drain(const sampler &s) {
+	auto header = static_cast<perf_event_mmap_page *>(s.buffer);
+	auto data = static_cast<char *>(s.buffer) + page_size;
+	uint64_t size = pages * page_size;
+
+	uint64_t head = header->data_head;
+	// Make sure the data is read after data_head, see perf_event_open(2)
+	__sync_synchronize();
+	uint64_t tail = header->data_tail;
+
+	std::vector<char> record;
+
+	// Layout of a sample with PERF_SAMPLE_IP, PERF_SAMPLE_TID, PERF_SAMPLE_TIME and PERF_SAMPLE_CPU
+	struct raw_sample {
+		perf_event_header header;
+		uint64_t ip;
+		uint32_t pid, tid;
+		uint64_t time;
+		uint32_t cpu, res;
+	};
+
+	while (tail < head) {
+		perf_event_header event;
+
+		// Records may wrap around the end of the buffer, so copy them byte by byte if necessary
+		for (uint64_t i = 0; i < sizeof(event); i++) reinterpret_cast<char *>(&event)[i] = data[(tail + i) % size];
+
+		// A corrupt header would stall the buffer, so drop everything up to data_head and count it as lost
+		if (event.size < sizeof(event) || event.size > size || event.size > head - tail) {
+			lost += std::max<uint64_t>(1, (head - tail) / sizeof(raw_sample));
+			tail = head;
+			break;
+		}
+
+		record.resize(event.size);
+		for (uint64_t i = 0; i < event.size; i++) record[i] = data[(tail + i) % size];
+
+		tail += event.size;
+
+		// Layout of a lost record
+		struct lost_samples {
+			perf_event_header header;
+			uint64_t id;
+			uint64_t lost;
+		};
+
+		if (event.type == PERF_RECORD_LOST && event.size >= sizeof(lost_samples)) {
+			lost_samples current;
+			memcpy(&current, record.data(), sizeof(current));
+			lost += current.lost;
+			continue;
+		}
+
+		if (event.type != PERF_RECORD_SAMPLE || event.size < sizeof(raw_sample)) continue;
+
+		raw_sample current;
+		memcpy(&current, record.data(), sizeof(current));
+
+		// Only keep the samples of monitored threads which were taken during their measurement
+		auto it = threads.find(current.tid);
+		if (it == threads.end() || it->second.stop != 0 || current.time < it->second.start) continue;
+
+		it->second.count++;
+
+		if (max_samples == 0) continue;
+
+		sample entry;
+		entry.time = current.time;
+		entry.ip = current.ip;
+		entry.cpu = current.cpu;
+
+		it->second.samples.push_back(entry);
+		if (it->second.samples.size() > (size_t)max_samples) it->second.samples.pop_front();
+	}
+
+	// Tell the kernel that the space can be reused
+	__sync_synchronize();
+	header->data_tail = tail;
+}
+
+uint64_t Main::now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int Main::perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+	return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+} // namespace Sampling
+} // namespace Monitor
+} // namespace AutopinPlus
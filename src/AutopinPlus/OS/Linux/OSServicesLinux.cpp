@@ -29,9 +29,11 @@
 #include <AutopinPlus/OS/Linux/OSServicesLinux.h>
 
 #include <AutopinPlus/ObservedProcess.h>
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <iostream>
+#include <map>
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
@@ -43,10 +45,12 @@
 #include <stdlib.h>
 #include <sys/ptrace.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <vector>
 
 /*!
  * \brief Maximum length for paths of UNIX domain sockets
@@ -481,21 +485,219 @@ int OSServicesLinux::getTaskSortId(int tid) {
 	return result;
 }
 
-void OSServicesLinux::setAffinity(int tid, int cpu) {
+void OSServicesLinux::setAffinity(int tid, const std::set<int> &cpus) {
 	cpu_set_t cores;
 	pid_t linux_tid = tid;
 	int ret = 0;
+	QStringList cpulist;
 
 	// Setup CPU mask
 	CPU_ZERO(&cores);
-	CPU_SET(cpu, &cores);
+	for (int cpu : cpus) {
+		if (cpu < 0 || cpu >= CPU_SETSIZE) {
+			context.report(Error::SYSTEM, "set_affinity",
+						   "Could not pin thread " + QString::number(tid) + " to invalid cpu " + QString::number(cpu));
+			return;
+		}
+
+		CPU_SET(cpu, &cores);
+		cpulist.append(QString::number(cpu));
+	}
 
 	// set affinity
 	ret = sched_setaffinity(linux_tid, sizeof(cores), &cores);
 
 	if (ret != 0)
 		REPORTV(Error::SYSTEM, "set_affinity",
-				"Could not pin thread " + QString::number(tid) + " to cpu " + QString::number(cpu));
+				"Could not pin thread " + QString::number(tid) + " to cpus " + cpulist.join(","));
+}
+
+OSServices::autopin_topology OSServicesLinux::getTopology() {
+	autopin_topology result;
+	std::map<int, int> nodes;
+	QDir cpudir, nodedir;
+	QRegExp cpuname("cpu([0-9]+)"), nodename("node([0-9]+)"), cachename("index([0-9]+)");
+
+	cpudir.setFilter(QDir::Dirs | QDir::NoDotAndDotDot);
+	nodedir.setFilter(QDir::Dirs | QDir::NoDotAndDotDot);
+
+	if (!cpudir.cd("/sys/devices/system/cpu"))
+		REPORT(Error::SYSTEM, "topology", "Could not access /sys/devices/system/cpu", result);
+
+	// The node directory only exists on NUMA systems
+	if (nodedir.cd("/sys/devices/system/node")) {
+		for (const auto &entry : nodedir.entryList()) {
+			if (!nodename.exactMatch(entry)) continue;
+
+			for (int cpu : parseCpuList(readSysfsEntry(nodedir.path() + "/" + entry + "/cpulist")))
+				nodes[cpu] = nodename.cap(1).toInt();
+		}
+	}
+
+	for (const auto &entry : cpudir.entryList()) {
+		if (!cpuname.exactMatch(entry)) continue;
+
+		QString path = cpudir.path() + "/" + entry;
+
+		// Offline cpus cannot be used for pinning. The "online" file doesn't exist for cpus which cannot be disabled.
+		if (readSysfsEntry(path + "/online") == "0") continue;
+
+		autopin_cpu cpu;
+		cpu.cpu = cpuname.cap(1).toInt();
+		cpu.core = readSysfsEntry(path + "/topology/core_id").toInt();
+		cpu.socket = readSysfsEntry(path + "/topology/physical_package_id").toInt();
+		cpu.node = (nodes.count(cpu.cpu) > 0) ? nodes[cpu.cpu] : 0;
+		cpu.llc = cpu.socket;
+
+		QDir cachedir;
+		cachedir.setFilter(QDir::Dirs | QDir::NoDotAndDotDot);
+
+		if (cachedir.cd(path + "/cache")) {
+			int llc_level = 0;
+
+			for (const auto &index : cachedir.entryList()) {
+				if (!cachename.exactMatch(index)) continue;
+
+				QString cachepath = cachedir.path() + "/" + index;
+				int level = readSysfsEntry(cachepath + "/level").toInt();
+				if (readSysfsEntry(cachepath + "/type") == "Instruction" || level <= llc_level) continue;
+
+				QList<int> shared = parseCpuList(readSysfsEntry(cachepath + "/shared_cpu_list"));
+				if (shared.isEmpty()) continue;
+
+				llc_level = level;
+				cpu.llc = *std::min_element(shared.begin(), shared.end());
+			}
+		}
+
+		result.push_back(cpu);
+	}
+
+	std::sort(result.begin(), result.end(),
+			  [](const autopin_cpu &a, const autopin_cpu &b) { return a.cpu < b.cpu; });
+
+	if (result.empty()) REPORT(Error::SYSTEM, "topology", "Could not determine the topology of the system", result);
+
+	return result;
+}
+
+OSServices::autopin_cpu_states OSServicesLinux::getCpuStates() {
+	autopin_cpu_states result;
+	QDir cpudir;
+	QRegExp cpuname("cpu([0-9]+)");
+
+	cpudir.setFilter(QDir::Dirs | QDir::NoDotAndDotDot);
+	if (!cpudir.cd("/sys/devices/system/cpu")) return result;
+
+	for (const auto &entry : cpudir.entryList()) {
+		if (!cpuname.exactMatch(entry)) continue;
+
+		QString path = cpudir.path() + "/" + entry;
+		if (readSysfsEntry(path + "/online") == "0") continue;
+
+		// cpufreq reports frequencies in kHz
+		autopin_cpu_state state;
+		state.frequency = readSysfsEntry(path + "/cpufreq/scaling_cur_freq").toDouble() / 1000;
+		state.max_frequency = readSysfsEntry(path + "/cpufreq/cpuinfo_max_freq").toDouble() / 1000;
+		state.throttle_count = readSysfsEntry(path + "/thermal_throttle/core_throttle_count").toULong() +
+							   readSysfsEntry(path + "/thermal_throttle/package_throttle_count").toULong();
+
+		result[cpuname.cap(1).toInt()] = state;
+	}
+
+	return result;
+}
+
+OSServices::autopin_memory_nodes OSServicesLinux::getMemoryNodes(int tid) {
+	autopin_memory_nodes result;
+	QFile file("/proc/" + QString::number(tid) + "/numa_maps");
+	QRegExp pages("N([0-9]+)=([0-9]+)"), pagesize("kernelpagesize_kB=([0-9]+)");
+
+	// The file doesn't exist on kernels without NUMA support
+	if (!file.open(QIODevice::ReadOnly)) {
+		context.report(Error::SYSTEM, "numa_maps",
+					   "Could not read the NUMA memory map of task " + QString::number(tid));
+		return result;
+	}
+
+	QTextStream stream(&file);
+	QString line;
+
+	while (!(line = stream.readLine()).isNull()) {
+		QStringList fields = line.split(' ', QString::SkipEmptyParts);
+		unsigned long size = 4;
+
+		for (const auto &field : fields) {
+			if (pagesize.exactMatch(field)) size = pagesize.cap(1).toULong();
+		}
+
+		for (const auto &field : fields) {
+			if (pages.exactMatch(field)) result[pages.cap(1).toInt()] += pages.cap(2).toULong() * size;
+		}
+	}
+
+	file.close();
+
+	return result;
+}
+
+void OSServicesLinux::migrateMemory(int tid, const QList<int> &from, int to) {
+	const int bits = 8 * sizeof(unsigned long);
+	int maxnode = to;
+
+	for (int node : from) maxnode = std::max(maxnode, node);
+
+	// The node masks have the same format as for set_mempolicy(2)
+	std::vector<unsigned long> old_nodes(maxnode / bits + 1, 0), new_nodes(maxnode / bits + 1, 0);
+
+	for (int node : from) old_nodes[node / bits] |= 1UL << (node % bits);
+	new_nodes[to / bits] |= 1UL << (to % bits);
+
+	long ret = syscall(SYS_migrate_pages, tid, old_nodes.size() * bits, old_nodes.data(), new_nodes.data());
+
+	if (ret < 0)
+		REPORTV(Error::SYSTEM, "migrate_pages",
+				"Could not move the memory of task " + QString::number(tid) + " to node " + QString::number(to));
+}
+
+OSServices::autopin_task_info OSServicesLinux::getTaskInfo(int tid) {
+	QMutexLocker locker(&mutex);
+
+	autopin_task_info result;
+	result.pid = tid;
+	result.cpu_share = 0;
+
+	QString taskdir = "/proc/" + QString::number(tid);
+	result.name = readSysfsEntry(taskdir + "/comm");
+
+	// Determine the thread group leader, i. e. the process the task belongs to
+	QString tgid;
+	for (const auto &line : readSysfsEntry(taskdir + "/status").split('\n')) {
+		if (line.startsWith("Tgid:")) tgid = line.mid(5).trimmed();
+	}
+	if (tgid != "") {
+		result.pid = tgid.toInt();
+		result.process = readSysfsEntry("/proc/" + tgid + "/comm");
+	}
+
+	// utime, stime and starttime are given in clock ticks
+	double ticks = sysconf(_SC_CLK_TCK);
+	double cputime = (getProcEntry(tid, 13, false).toDouble() + getProcEntry(tid, 14, false).toDouble()) / ticks;
+	double starttime = getProcEntry(tid, 21, false).toDouble() / ticks;
+	double uptime = readSysfsEntry("/proc/uptime").section(" ", 0, 0).toDouble();
+
+	if (uptime > starttime) result.cpu_share = cputime / (uptime - starttime);
+
+	return result;
+}
+
+int OSServicesLinux::getTaskCreator(int tid) { return tracer.getCreator(tid); }
+
+bool OSServicesLinux::isRunning(int pid) {
+	QMutexLocker locker(&mutex);
+
+	QString state = getProcEntry(pid, 2, false);
+	return state != "" && state != "Z" && state != "X";
 }
 
 ProcessTree::autopin_tid_list OSServicesLinux::getPid(QString proc) {
@@ -704,6 +906,31 @@ QStringList OSServicesLinux::getArguments(QString cmd) {
 	return result;
 }
 
+QString OSServicesLinux::readSysfsEntry(QString path) {
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly)) return "";
+
+	QString result = QString(file.readAll()).trimmed();
+	file.close();
+
+	return result;
+}
+
+QList<int> OSServicesLinux::parseCpuList(QString list) {
+	QList<int> result;
+
+	for (const auto &range : list.split(',', QString::SkipEmptyParts)) {
+		QStringList bounds = range.split('-');
+		int first = bounds[0].toInt();
+		int last = (bounds.size() > 1) ? bounds[1].toInt() : first;
+
+		for (int cpu = first; cpu <= last; cpu++) result.append(cpu);
+	}
+
+	return result;
+}
+
 ProcessTree::autopin_tid_list OSServicesLinux::convertQStringList(QStringList &qlist) {
 	ProcessTree::autopin_tid_list result;
 
@@ -30,6 +30,7 @@
 
 #include <AutopinPlus/OS/Linux/OSServicesLinux.h>
 #include <errno.h>
+#include <QMutexLocker>
 #include <signal.h>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
@@ -182,6 +183,10 @@ void TraceThread::run() {
 		if (WIFEXITED(status) || WIFSIGNALED(status)) {
 			tasks.erase(trace_pid);
 
+			creator_mutex.lock();
+			creators.erase(trace_pid);
+			creator_mutex.unlock();
+
 			emit sig_TaskTerminated(trace_pid);
 
 			if (pid == trace_pid) return;
@@ -198,6 +203,10 @@ void TraceThread::run() {
 				case (PTRACE_EVENT_FORK):
 
 				case (PTRACE_EVENT_VFORK):
+					creator_mutex.lock();
+					creators[event_msg] = trace_pid;
+					creator_mutex.unlock();
+
 					newTask(event_msg);
 					break;
 
@@ -227,6 +236,15 @@ void TraceThread::run() {
 	}
 }
 
+int TraceThread::getCreator(int tid) {
+	QMutexLocker locker(&creator_mutex);
+
+	auto it = creators.find(tid);
+	if (it == creators.end()) return -1;
+
+	return it->second;
+}
+
 void TraceThread::ptraceContinue(pid_t pid, unsigned long sig) {
 	long ret;
 	ret = ptrace(PTRACE_CONT, pid, NULL, (void *)sig);
@@ -0,0 +1,117 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/OS/Simulator/EventDispatcher.h>
+
+#include <AutopinPlus/Clock.h> // for Clock
+#include <QCoreApplication>	   // for QCoreApplication
+#include <QTimerEvent>		   // for QTimerEvent
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+EventDispatcher::EventDispatcher(QObject *parent) : QAbstractEventDispatcher(parent) {
+	Clock::setSource([this]() { return now(); });
+}
+
+EventDispatcher::~EventDispatcher() { Clock::setSource(Clock::time_source()); }
+
+qint64 EventDispatcher::now() const { return time; }
+
+void EventDispatcher::setEnd(qint64 end) { this->end = end; }
+
+bool EventDispatcher::processEvents(QEventLoop::ProcessEventsFlags flags) {
+	interrupted = false;
+	emit awake();
+
+	QCoreApplication::sendPostedEvents();
+	if (interrupted) return true;
+
+	// Find the next timer, timers which are due at the same time fire in the order of their ids
+	auto next = timers.end();
+	for (auto it = timers.begin(); it != timers.end(); ++it)
+		if (next == timers.end() || it->second.due < next->second.due) next = it;
+
+	if (next == timers.end() || (end != -1 && next->second.due > end)) {
+		// Nothing will ever happen again
+		if (flags & QEventLoop::WaitForMoreEvents) QCoreApplication::exit(0);
+		return false;
+	}
+
+	int id = next->first;
+	QObject *object = next->second.object;
+	time = next->second.due;
+	next->second.due = time + next->second.interval;
+
+	emit aboutToBlock();
+	emit awake();
+
+	// The receiver may unregister the timer, so the iterator must not be used afterwards
+	QTimerEvent event(id);
+	QCoreApplication::sendEvent(object, &event);
+
+	return true;
+}
+
+bool EventDispatcher::hasPendingEvents() { return !timers.empty(); }
+
+void EventDispatcher::registerSocketNotifier(QSocketNotifier *notifier) {}
+
+void EventDispatcher::unregisterSocketNotifier(QSocketNotifier *notifier) {}
+
+void EventDispatcher::registerTimer(int timerId, int interval, QObject *object) {
+	timers[timerId] = {interval, object, time + interval};
+}
+
+bool EventDispatcher::unregisterTimer(int timerId) { return timers.erase(timerId) > 0; }
+
+bool EventDispatcher::unregisterTimers(QObject *object) {
+	bool result = false;
+
+	for (auto it = timers.begin(); it != timers.end();) {
+		if (it->second.object == object) {
+			it = timers.erase(it);
+			result = true;
+		} else {
+			++it;
+		}
+	}
+
+	return result;
+}
+
+QList<QAbstractEventDispatcher::TimerInfo> EventDispatcher::registeredTimers(QObject *object) const {
+	QList<TimerInfo> result;
+
+	for (const auto &elem : timers)
+		if (elem.second.object == object) result.append(TimerInfo(elem.first, elem.second.interval));
+
+	return result;
+}
+
+void EventDispatcher::wakeUp() {}
+
+void EventDispatcher::interrupt() { interrupted = true; }
+
+void EventDispatcher::flush() {}
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
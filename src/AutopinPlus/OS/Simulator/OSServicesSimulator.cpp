@@ -0,0 +1,287 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/OS/Simulator/OSServicesSimulator.h>
+
+#include <AutopinPlus/Clock.h>				 // for Clock
+#include <AutopinPlus/Error.h>				 // for REPORTV, CHECK_ERRORV, etc
+#include <AutopinPlus/Exception.h>			 // for Exception
+#include <AutopinPlus/ScopedConfiguration.h> // for ScopedConfiguration
+#include <AutopinPlus/Tools.h>				 // for Tools
+#include <AutopinPlus/XMLPinningHistory.h>	 // for XMLPinningHistory
+#include <algorithm>						 // for max, min
+#include <cstdlib>							 // for abs
+#include <QStringList>						 // for QStringList
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+OSServicesSimulator::OSServicesSimulator(Configuration *config, const AutopinContext &context)
+	: OSServices(context), config(config) {}
+
+OSServicesSimulator::~OSServicesSimulator() {
+	delete trace;
+	delete trace_config;
+}
+
+void OSServicesSimulator::init() {
+	context.enableIndentation();
+	context.info("> Initializing the simulated os services");
+
+	// The trace is an ordinary pinning history, its path is read from Simulation.PinningHistory.load
+	QStringList local;
+	local << "PinningHistory.load"
+		  << "PinningHistory.save";
+	trace_config = new ScopedConfiguration(config, "Simulation", local, context);
+
+	if (trace_config->configOptionExists("PinningHistory.load") <= 0) {
+		context.report(Error::BAD_CONFIG, "option_missing", "No trace configured (Simulation.PinningHistory.load)");
+		return;
+	}
+
+	trace = new XMLPinningHistory(trace_config, context);
+	CHECK_ERRORV(trace->init());
+
+	int phase = 0;
+
+	try {
+		if (config->configOptionExists("Simulation.phase") > 0)
+			phase = Tools::readInt(config->getConfigOption("Simulation.phase"));
+		if (config->configOptionExists("Simulation.valtype") > 0)
+			valtype = PerformanceMonitor::readMontype(config->getConfigOption("Simulation.valtype"));
+		if (config->configOptionExists("Simulation.pid") > 0)
+			pid = Tools::readInt(config->getConfigOption("Simulation.pid"));
+		if (config->configOptionExists("Simulation.sockets") > 0)
+			sockets = Tools::readInt(config->getConfigOption("Simulation.sockets"));
+		if (config->configOptionExists("Simulation.threads") > 0)
+			threads = Tools::readInt(config->getConfigOption("Simulation.threads"));
+		if (config->configOptionExists("Simulation.cpus") > 0)
+			for (int cpu : Tools::readInts(config->getConfigOptionList("Simulation.cpus"))) cpus.insert(cpu);
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", "OSServicesSimulator::init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (valtype == PerformanceMonitor::montype::UNKNOWN)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid value type: UNKNOWN");
+	if (sockets < 1) REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid number of sockets: " + QString::number(sockets));
+
+	// Later measurements of the same pinning replace earlier ones
+	bool derive_threads = (threads == 0), derive_cpus = cpus.empty();
+	for (const auto &result : trace->getPinnings(phase)) {
+		recorded[result.first] = result.second;
+
+		if (derive_threads) threads = std::max(threads, (int)result.first.size());
+		if (derive_cpus)
+			for (const auto &cpuset : result.first) cpus.insert(cpuset.begin(), cpuset.end());
+	}
+
+	if (recorded.empty()) {
+		context.report(Error::BAD_CONFIG, "inconsistent",
+					   "The trace contains no pinnings for phase " + QString::number(phase));
+		return;
+	}
+
+	best = *recorded.begin();
+	for (const auto &result : recorded) {
+		if ((valtype == PerformanceMonitor::montype::MAX && result.second > best.second) ||
+			(valtype == PerformanceMonitor::montype::MIN && result.second < best.second))
+			best = result;
+	}
+
+	context.info("  :: Recorded pinnings: " + QString::number(recorded.size()) + " (phase " + QString::number(phase) +
+				 ")");
+	context.info("  :: Best recorded pinning: " + PinningHistory::showPinning(best.first) + " (" +
+				 QString::number(best.second) + ")");
+	context.info("  :: Simulated threads: " + QString::number(threads));
+	context.info("  :: Simulated cpus: " + PinningHistory::showCpuSet(cpus) + " on " + QString::number(sockets) +
+				 " socket(s)");
+
+	context.disableIndentation();
+}
+
+double OSServicesSimulator::getWork(int tid) {
+	updateWork();
+
+	auto it = work.find(tid);
+	return (it != work.end()) ? it->second : 0;
+}
+
+PinningHistory::autopin_pinning OSServicesSimulator::getPinning() {
+	PinningHistory::autopin_pinning result;
+
+	for (int i = 0; i < threads; i++) {
+		auto it = affinities.find(pid + i);
+		result.push_back((it != affinities.end()) ? it->second : cpus);
+	}
+
+	return result;
+}
+
+double OSServicesSimulator::getPerformance(const PinningHistory::autopin_pinning &pinning) {
+	auto exact = recorded.find(pinning);
+	if (exact != recorded.end()) return exact->second;
+
+	// Average the values of the recorded pinnings which differ in the fewest threads
+	int min_distance = -1, count = 0;
+	double sum = 0;
+
+	for (const auto &result : recorded) {
+		int distance = std::abs((int)result.first.size() - (int)pinning.size());
+		for (size_t i = 0; i < std::min(result.first.size(), pinning.size()); i++)
+			if (result.first[i] != pinning[i]) distance++;
+
+		if (min_distance == -1 || distance < min_distance) {
+			min_distance = distance;
+			count = 0;
+			sum = 0;
+		}
+
+		if (distance == min_distance) {
+			count++;
+			sum += result.second;
+		}
+	}
+
+	return (count > 0) ? sum / count : 0;
+}
+
+PerformanceMonitor::montype OSServicesSimulator::getValType() { return valtype; }
+
+void OSServicesSimulator::summary() {
+	updateWork();
+
+	context.enableIndentation();
+	context.info("> Simulation summary");
+	context.info("  :: Virtual time: " + QString::number(Clock::now() / 1000.0) + " s");
+	context.info("  :: Best recorded pinning: " + PinningHistory::showPinning(best.first) + " (" +
+				 QString::number(best.second) + ")");
+	context.info("  :: Final pinning: " + PinningHistory::showPinning(getPinning()) + " (" +
+				 QString::number(performance) + ")");
+
+	if (best_time != -1)
+		context.info("  :: The best recorded performance has been reached after " +
+					 QString::number(best_time / 1000.0) + " s");
+	else
+		context.info("  :: The best recorded performance has not been reached, the best was " +
+					 QString::number(best_reached));
+
+	context.disableIndentation();
+}
+
+QString OSServicesSimulator::getHostname() { return "simulator"; }
+
+QString OSServicesSimulator::getCommDefaultAddr() { return ""; }
+
+int OSServicesSimulator::createProcess(QString cmd, bool wait) {
+	running = true;
+	last_update = Clock::now();
+
+	for (int i = 0; i < threads; i++) work[pid + i] = 0;
+
+	performance = getPerformance(getPinning());
+	best_reached = performance;
+
+	return pid;
+}
+
+void OSServicesSimulator::setAffinity(int tid, const std::set<int> &cpus) {
+	for (int cpu : cpus) {
+		if (this->cpus.count(cpu) == 0) {
+			context.report(Error::SYSTEM, "set_affinity",
+						   "Could not pin thread " + QString::number(tid) + " to cpus " + PinningHistory::showCpuSet(cpus));
+			return;
+		}
+	}
+
+	// The work up to now has been done with the old pinning
+	updateWork();
+
+	affinities[tid] = cpus;
+	performance = getPerformance(getPinning());
+
+	bool better = (valtype == PerformanceMonitor::montype::MAX) ? performance > best_reached
+																 : performance < best_reached;
+	if (better) best_reached = performance;
+	if (best_time == -1 && performance == best.second) best_time = Clock::now();
+}
+
+void OSServicesSimulator::attachToProcess(ObservedProcess *observed_process) {}
+
+void OSServicesSimulator::detachFromProcess() {}
+
+void OSServicesSimulator::initCommChannel(ObservedProcess *proc) {
+	REPORTV(Error::COMM, "socket", "The simulated process cannot use the communication channel");
+}
+
+void OSServicesSimulator::deinitCommChannel() {}
+
+void OSServicesSimulator::connectCommChannel(int timeout) {}
+
+void OSServicesSimulator::sendMsg(int event_id, int arg, double val) {}
+
+ProcessTree::autopin_tid_list OSServicesSimulator::getPid(QString proc) {
+	ProcessTree::autopin_tid_list result;
+	result.insert(pid);
+	return result;
+}
+
+QString OSServicesSimulator::getCmd(int pid) { return "simulation"; }
+
+ProcessTree::autopin_tid_list OSServicesSimulator::getProcessThreads(int pid) {
+	ProcessTree::autopin_tid_list result;
+
+	if (pid != this->pid || !running) return result;
+
+	for (int i = 0; i < threads; i++) result.insert(pid + i);
+
+	return result;
+}
+
+ProcessTree::autopin_tid_list OSServicesSimulator::getChildProcesses(int pid) {
+	return ProcessTree::autopin_tid_list();
+}
+
+OSServices::autopin_topology OSServicesSimulator::getTopology() {
+	autopin_topology result;
+
+	// Every cpu is a core of its own, the cpus are split evenly between the sockets
+	int index = 0;
+	for (int cpu : cpus) {
+		int socket = index * sockets / cpus.size();
+		result.push_back({cpu, index, socket, socket, socket});
+		index++;
+	}
+
+	return result;
+}
+
+void OSServicesSimulator::updateWork() {
+	qint64 now = Clock::now();
+
+	if (running)
+		for (int i = 0; i < threads; i++) work[pid + i] += performance * (now - last_update);
+
+	last_update = now;
+}
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
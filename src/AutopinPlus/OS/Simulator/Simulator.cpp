@@ -0,0 +1,70 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/OS/Simulator/Simulator.h>
+
+#include <AutopinPlus/Error.h>						  // for REPORTV
+#include <AutopinPlus/Monitor/Replay/Main.h>		  // for Main
+#include <AutopinPlus/OS/Simulator/EventDispatcher.h> // for EventDispatcher
+#include <QAbstractEventDispatcher>					  // for QAbstractEventDispatcher
+
+namespace AutopinPlus {
+namespace OS {
+namespace Simulator {
+
+Simulator::Simulator(int &argc, char **argv) : Autopin(argc, argv) {}
+
+void Simulator::slot_simulatorSummary() {
+	if (simulator != nullptr) simulator->summary();
+}
+
+void Simulator::createOSServices() {
+	auto dispatcher = qobject_cast<EventDispatcher *>(QAbstractEventDispatcher::instance());
+
+	if (dispatcher == nullptr)
+		REPORTV(Error::UNSUPPORTED, "critical", "The simulator requires the virtual time event dispatcher");
+
+	// Simulate two hours unless configured otherwise
+	double duration = 7200;
+	if (config->configOptionExists("Simulation.duration") > 0)
+		duration = config->getConfigOptionDouble("Simulation.duration");
+
+	if (duration <= 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid simulation duration: " + QString::number(duration));
+
+	if (dispatcher != nullptr) dispatcher->setEnd(duration * 1000);
+
+	simulator = new OSServicesSimulator(config, context);
+	service = simulator;
+}
+
+void Simulator::createPerformanceMonitor(Configuration *config, QString id,
+										 PerformanceMonitor::monitor_list &monitors) {
+	if (config->configOptionExists(id + ".type") == 1 && config->getConfigOption(id + ".type") == "replay") {
+		PerformanceMonitor *new_mon = new Monitor::Replay::Main(id, config, simulator, context);
+		monitors.push_back(new_mon);
+		return;
+	}
+
+	Autopin::createPerformanceMonitor(config, id, monitors);
+}
+
+} // namespace Simulator
+} // namespace OS
+} // namespace AutopinPlus
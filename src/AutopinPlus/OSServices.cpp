@@ -38,4 +38,23 @@ const OSServices *OSServices::getCurrentService() { return current_service; }
 
 int OSServices::getTaskSortId(int tid) { return tid; }
 
+OSServices::autopin_topology OSServices::getTopology() { return autopin_topology(); }
+
+OSServices::autopin_memory_nodes OSServices::getMemoryNodes(int tid) { return autopin_memory_nodes(); }
+
+void OSServices::migrateMemory(int tid, const QList<int> &from, int to) {}
+
+OSServices::autopin_task_info OSServices::getTaskInfo(int tid) {
+	autopin_task_info result;
+	result.pid = tid;
+	result.cpu_share = 0;
+	return result;
+}
+
+int OSServices::getTaskCreator(int tid) { return -1; }
+
+bool OSServices::isRunning(int pid) { return true; }
+
+OSServices::autopin_cpu_states OSServices::getCpuStates() { return autopin_cpu_states(); }
+
 } // namespace AutopinPlus
@@ -0,0 +1,222 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/PerformanceModel.h>
+
+#include <algorithm>	 // for max
+#include <cmath>		 // for fabs
+#include <list>			 // for list
+#include <qregexp.h>	 // for QRegExp
+#include <qstringlist.h> // for QStringList
+#include <set>			 // for set
+#include <stddef.h>		 // for size_t
+#include <utility>		 // for pair, swap
+
+namespace AutopinPlus {
+
+// The number of values returned by features()
+static const size_t feature_count = 7;
+
+PerformanceModel::PerformanceModel(const OSServices::autopin_topology &topology, double regularization)
+	: regularization(regularization), weights(feature_count, 0) {
+	std::set<int> socket_ids;
+
+	names = PinningHistory::placementNames(topology);
+
+	for (const auto &cpu : topology) {
+		llcs[names[cpu.cpu]] = cpu.llc;
+		socket_ids.insert(cpu.socket);
+	}
+
+	sockets = socket_ids.size();
+}
+
+int PerformanceModel::train(const PinningHistory &history, PerformanceMonitor::montype type) {
+	// Accumulate the normal equations (X^T * X + penalty) * w = X^T * y
+	std::vector<double> a(feature_count * feature_count, 0), b(feature_count, 0);
+	int samples = 0;
+
+	const std::map<int, std::list<PinningHistory::placement_result>> &unplaced = history.getUnplacedResults();
+	std::set<int> phases = history.getPhases();
+	for (const auto &elem : unplaced) phases.insert(elem.first);
+
+	for (int phase : phases) {
+		// Describe all results by their features, whether they fit this system or not
+		std::list<std::pair<std::vector<double>, double>> results;
+		for (const auto &result : history.getPinnings(phase))
+			results.push_back(std::make_pair(features(result.first), result.second));
+
+		auto it = unplaced.find(phase);
+		if (it != unplaced.end()) {
+			for (const auto &result : it->second)
+				results.push_back(std::make_pair(features(result.first), result.second));
+		}
+
+		double mean = 0;
+		int count = 0;
+		for (const auto &result : results) {
+			if (result.second <= 0) continue;
+			mean += result.second;
+			count++;
+		}
+
+		if (count == 0) continue;
+		mean /= count;
+
+		for (const auto &result : results) {
+			if (result.second <= 0) continue;
+
+			double y = (type == PerformanceMonitor::montype::MIN) ? mean / result.second : result.second / mean;
+			const std::vector<double> &x = result.first;
+
+			for (size_t i = 0; i < feature_count; i++) {
+				for (size_t j = 0; j < feature_count; j++) a[i * feature_count + j] += x[i] * x[j];
+				b[i] += x[i] * y;
+			}
+
+			samples++;
+		}
+	}
+
+	weights.assign(feature_count, 0);
+	if (samples == 0) return 0;
+
+	// The constant feature is not penalized, so the model predicts the mean if the other features don't help
+	for (size_t i = 0; i < feature_count; i++) a[i * feature_count + i] += (i == 0) ? 1e-9 : regularization + 1e-9;
+
+	// Solve the system by Gaussian elimination with partial pivoting
+	for (size_t col = 0; col < feature_count; col++) {
+		size_t pivot = col;
+		for (size_t row = col + 1; row < feature_count; row++) {
+			if (std::fabs(a[row * feature_count + col]) > std::fabs(a[pivot * feature_count + col])) pivot = row;
+		}
+
+		if (pivot != col) {
+			for (size_t j = 0; j < feature_count; j++)
+				std::swap(a[col * feature_count + j], a[pivot * feature_count + j]);
+			std::swap(b[col], b[pivot]);
+		}
+
+		for (size_t row = col + 1; row < feature_count; row++) {
+			double factor = a[row * feature_count + col] / a[col * feature_count + col];
+			for (size_t j = col; j < feature_count; j++)
+				a[row * feature_count + j] -= factor * a[col * feature_count + j];
+			b[row] -= factor * b[col];
+		}
+	}
+
+	for (size_t i = feature_count; i-- > 0;) {
+		double sum = b[i];
+		for (size_t j = i + 1; j < feature_count; j++) sum -= a[i * feature_count + j] * weights[j];
+		weights[i] = sum / a[i * feature_count + i];
+	}
+
+	return samples;
+}
+
+double PerformanceModel::predict(const PinningHistory::autopin_pinning &pinning) const {
+	std::vector<double> x = features(pinning);
+
+	double result = 0;
+	for (size_t i = 0; i < feature_count; i++) result += weights[i] * x[i];
+
+	return result;
+}
+
+std::vector<double> PerformanceModel::features(const PinningHistory::autopin_pinning &pinning) const {
+	// Place every thread on the lowest of its cpus
+	std::vector<placed_thread> placed;
+	for (const auto &cpuset : pinning) {
+		if (cpuset.empty()) continue;
+
+		auto it = names.find(*cpuset.begin());
+		placed_thread thread;
+		if (it != names.end() && place(it->second, thread)) placed.push_back(thread);
+	}
+
+	return features(placed);
+}
+
+std::vector<double> PerformanceModel::features(const QString &placement) const {
+	// The cores of every thread are sorted by their number, so the first one is the lowest
+	std::vector<placed_thread> placed;
+	for (const auto &task : placement.split(':')) {
+		placed_thread thread;
+		if (place(task.split(',').first(), thread)) placed.push_back(thread);
+	}
+
+	return features(placed);
+}
+
+bool PerformanceModel::place(const QString &name, placed_thread &result) const {
+	QRegExp format("s(\\d+)c(\\d+)t(\\d+)");
+	if (!format.exactMatch(name)) return false;
+
+	result.name = name;
+	result.socket = format.cap(1).toInt();
+	result.core = format.cap(2).toInt();
+
+	// Cores which don't exist on this system are assumed to share a last level cache per socket, these caches are
+	// numbered below 0 so they can't be confused with the caches of this system
+	auto it = llcs.find(name);
+	result.llc = (it != llcs.end()) ? it->second : -1 - result.socket;
+
+	return true;
+}
+
+std::vector<double> PerformanceModel::features(const std::vector<placed_thread> &placed) const {
+	std::vector<double> result(feature_count, 0);
+	result[0] = 1;
+
+	if (placed.empty() || names.empty()) return result;
+
+	std::map<int, int> per_socket, per_llc;
+	std::map<std::pair<int, int>, int> per_core;
+	std::map<QString, int> per_cpu;
+	for (const auto &thread : placed) {
+		per_socket[thread.socket]++;
+		per_core[std::make_pair(thread.socket, thread.core)]++;
+		per_llc[thread.llc]++;
+		per_cpu[thread.name]++;
+	}
+
+	int max_socket = 0;
+	for (const auto &elem : per_socket) max_socket = std::max(max_socket, elem.second);
+
+	double threads = placed.size();
+	int shared_core = 0, shared_llc = 0, shared_cpu = 0;
+	for (const auto &thread : placed) {
+		if (per_core[std::make_pair(thread.socket, thread.core)] > 1) shared_core++;
+		if (per_llc[thread.llc] > 1) shared_llc++;
+		if (per_cpu[thread.name] > 1) shared_cpu++;
+	}
+
+	result[1] = threads / names.size();
+	result[2] = (double)per_socket.size() / std::max(sockets, 1);
+	result[3] = max_socket / threads;
+	result[4] = shared_core / threads;
+	result[5] = shared_llc / threads;
+	result[6] = shared_cpu / threads;
+
+	return result;
+}
+
+const std::vector<double> &PerformanceModel::getWeights() const { return weights; }
+
+} // namespace AutopinPlus
@@ -47,6 +47,12 @@ QString PerformanceMonitor::getName() { return name; }
 
 QString PerformanceMonitor::getUnit() { return ""; }
 
+double PerformanceMonitor::getCoverage(int tid) { return 1; }
+
+bool PerformanceMonitor::isProcessWide() { return false; }
+
+bool PerformanceMonitor::isCumulative() { return true; }
+
 void PerformanceMonitor::start(ProcessTree::autopin_tid_list tasks) {
 	for (const auto &task : tasks) {
 		CHECK_ERRORV(start(task));
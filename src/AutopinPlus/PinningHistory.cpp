@@ -28,6 +28,9 @@
 
 #include <AutopinPlus/PinningHistory.h>
 
+#include <AutopinPlus/Exception.h>
+#include <sched.h>
+
 namespace AutopinPlus {
 
 PinningHistory::PinningHistory(Configuration *config, const AutopinContext &context)
@@ -40,6 +43,9 @@ void PinningHistory::addPinning(int phase, PinningHistory::autopin_pinning pinni
 	res.first = pinning;
 	res.second = value;
 
+	// The statistics are not valid anymore if the pinning is added without them
+	if (statsmap[phase].erase(pinning) > 0) history_modified = true;
+
 	if (pinmap.find(phase) == pinmap.end()) {
 		pinmap[phase].push_back(res);
 		bestpinmap[phase] = res;
@@ -50,6 +56,12 @@ void PinningHistory::addPinning(int phase, PinningHistory::autopin_pinning pinni
 				if (elem.second != value) {
 					elem.second = value;
 					history_modified = true;
+
+					// The value of the best pinning may have become worse
+					bestpinmap[phase] = elem;
+					for (auto &other : pinmap[phase]) {
+						if (better(other.second, bestpinmap[phase].second)) bestpinmap[phase] = other;
+					}
 				}
 				return;
 			}
@@ -57,10 +69,18 @@ void PinningHistory::addPinning(int phase, PinningHistory::autopin_pinning pinni
 		pinmap[phase].push_back(res);
 		history_modified = true;
 
-		if (bestpinmap[phase].second < value) bestpinmap[phase] = res;
+		if (better(value, bestpinmap[phase].second)) bestpinmap[phase] = res;
 	}
 }
 
+void PinningHistory::addPinning(int phase, PinningHistory::autopin_pinning pinning, double value,
+								PinningHistory::pinning_stats stats) {
+	addPinning(phase, pinning, value);
+
+	statsmap[phase][pinning] = stats;
+	history_modified = true;
+}
+
 PinningHistory::pinning_result PinningHistory::getBestPinning(int phase) const {
 
 	auto result = bestpinmap.find(phase);
@@ -72,6 +92,25 @@ PinningHistory::pinning_result PinningHistory::getBestPinning(int phase) const {
 	return pinning_result();
 }
 
+void PinningHistory::setObjective(PerformanceMonitor::montype type) {
+	if (type != PerformanceMonitor::MIN) type = PerformanceMonitor::MAX;
+	if (type == objective) return;
+
+	objective = type;
+	history_modified = true;
+
+	for (const auto &phase : pinmap) {
+		bestpinmap[phase.first] = phase.second.front();
+		for (const auto &elem : phase.second) {
+			if (better(elem.second, bestpinmap[phase.first].second)) bestpinmap[phase.first] = elem;
+		}
+	}
+}
+
+PerformanceMonitor::montype PinningHistory::getObjective() const { return objective; }
+
+bool PinningHistory::better(double a, double b) const { return (objective == PerformanceMonitor::MIN) ? a < b : a > b; }
+
 std::list<PinningHistory::pinning_result> PinningHistory::getPinnings(int phase) const {
 
 	auto result = pinmap.find(phase);
@@ -81,6 +120,186 @@ std::list<PinningHistory::pinning_result> PinningHistory::getPinnings(int phase)
 	return std::list<pinning_result>();
 }
 
+std::set<int> PinningHistory::getPhases() const {
+	std::set<int> result;
+
+	for (const auto &elem : pinmap) result.insert(elem.first);
+
+	return result;
+}
+
+PinningHistory::pinning_stats PinningHistory::getPinningStats(int phase,
+															 const PinningHistory::autopin_pinning &pinning) const {
+	pinning_stats result = {0, 0};
+
+	auto it = statsmap.find(phase);
+	if (it == statsmap.end()) return result;
+
+	auto jt = it->second.find(pinning);
+	if (jt != it->second.end()) result = jt->second;
+
+	return result;
+}
+
+void PinningHistory::setPinningMetrics(int phase, const PinningHistory::autopin_pinning &pinning,
+									   const PinningHistory::pinning_metrics &metrics) {
+	for (const auto &metric : metrics) {
+		double &value = metricsmap[phase][pinning][metric.first];
+		if (value != metric.second) history_modified = true;
+		value = metric.second;
+	}
+}
+
+PinningHistory::pinning_metrics PinningHistory::getPinningMetrics(int phase,
+																 const PinningHistory::autopin_pinning &pinning) const {
+	auto it = metricsmap.find(phase);
+	if (it == metricsmap.end()) return pinning_metrics();
+
+	auto jt = it->second.find(pinning);
+	if (jt == it->second.end()) return pinning_metrics();
+
+	return jt->second;
+}
+
+void PinningHistory::setPinningTasks(int phase, const PinningHistory::autopin_pinning &pinning,
+									 const QStringList &tasks) {
+	QStringList &value = tasksmap[phase][pinning];
+	if (value != tasks) history_modified = true;
+	value = tasks;
+}
+
+QStringList PinningHistory::getPinningTasks(int phase, const PinningHistory::autopin_pinning &pinning) const {
+	auto it = tasksmap.find(phase);
+	if (it == tasksmap.end()) return QStringList();
+
+	auto jt = it->second.find(pinning);
+	if (jt == it->second.end()) return QStringList();
+
+	return jt->second;
+}
+
+QString PinningHistory::showCpuSet(const PinningHistory::autopin_cpuset &cpus) {
+	QStringList result;
+
+	// Merge consecutive cores into ranges
+	for (auto it = cpus.begin(); it != cpus.end();) {
+		int first = *it, last = *it;
+		for (++it; it != cpus.end() && *it == last + 1; ++it) last = *it;
+
+		if (first == last)
+			result.append(QString::number(first));
+		else
+			result.append(QString::number(first) + "-" + QString::number(last));
+	}
+
+	return result.join(",");
+}
+
+PinningHistory::autopin_cpuset PinningHistory::readCpuSet(QString str) {
+	autopin_cpuset result;
+
+	for (const auto &range : str.split(',')) {
+		QStringList bounds = range.split('-');
+		bool ok_first = false, ok_last = false;
+		int first = bounds[0].toInt(&ok_first);
+		int last = (bounds.size() == 2) ? bounds[1].toInt(&ok_last) : first;
+
+		if (!ok_first || (bounds.size() == 2 && !ok_last) || bounds.size() > 2 || first < 0 || last < first ||
+			last >= CPU_SETSIZE)
+			throw Exception("PinningHistory::readCpuSet(" + str + ") failed: Invalid.");
+
+		for (int cpu = first; cpu <= last; cpu++) result.insert(cpu);
+	}
+
+	return result;
+}
+
+QString PinningHistory::showPinning(const PinningHistory::autopin_pinning &pinning) {
+	QStringList result;
+
+	for (const auto &cpus : pinning) result.append(showCpuSet(cpus));
+
+	return result.join(":");
+}
+
+void PinningHistory::setTopology(const OSServices::autopin_topology &topology) {
+	placement_names = placementNames(topology);
+
+	placement_cpus.clear();
+	for (const auto &elem : placement_names) placement_cpus[elem.second] = elem.first;
+}
+
+std::map<int, QString> PinningHistory::placementNames(const OSServices::autopin_topology &topology) {
+	std::map<int, QString> result;
+
+	// Number the sockets, the cores within each socket and the hardware threads within each core
+	std::map<int, std::map<int, std::set<int>>> sockets;
+	for (const auto &cpu : topology) sockets[cpu.socket][cpu.core].insert(cpu.cpu);
+
+	int socket_index = 0;
+	for (const auto &socket : sockets) {
+		int core_index = 0;
+		for (const auto &core : socket.second) {
+			int thread_index = 0;
+			for (int cpu : core.second) {
+				result[cpu] = "s" + QString::number(socket_index) + "c" + QString::number(core_index) + "t" +
+							  QString::number(thread_index++);
+			}
+			core_index++;
+		}
+		socket_index++;
+	}
+
+	return result;
+}
+
+void PinningHistory::addUnplacedResult(int phase, const QString &placement, double value) {
+	unplaced[phase].push_back(placement_result(placement, value));
+}
+
+const std::map<int, std::list<PinningHistory::placement_result>> &PinningHistory::getUnplacedResults() const {
+	return unplaced;
+}
+
+QString PinningHistory::showPlacement(const autopin_pinning &pinning) const {
+	QStringList result;
+
+	if (placement_names.empty()) return "";
+
+	for (const auto &cpus : pinning) {
+		QStringList names;
+
+		for (int cpu : cpus) {
+			auto it = placement_names.find(cpu);
+			if (it == placement_names.end()) return "";
+			names.append(it->second);
+		}
+
+		result.append(names.join(","));
+	}
+
+	return result.join(":");
+}
+
+PinningHistory::autopin_pinning PinningHistory::readPlacement(QString str) const {
+	autopin_pinning result;
+
+	for (const auto &task : str.split(':')) {
+		autopin_cpuset cpus;
+
+		for (const auto &name : task.split(',')) {
+			auto it = placement_cpus.find(name);
+			if (it == placement_cpus.end())
+				throw Exception("PinningHistory::readPlacement(" + str + ") failed: No core " + name + ".");
+			cpus.insert(it->second);
+		}
+
+		result.push_back(cpus);
+	}
+
+	return result;
+}
+
 const QString &PinningHistory::getStrategy() const { return strategy; }
 
 const Configuration::configopts &PinningHistory::getStrategyOptions() const { return strategy_options; }
@@ -0,0 +1,71 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/PinningSpace.h>
+
+#include <algorithm> // for none_of, swap
+#include <qglobal.h> // for qrand
+
+namespace AutopinPlus {
+
+PinningSpace::PinningSpace(QList<int> cpus, int threads) : cpus(cpus), threads(threads) {}
+
+const QList<int> &PinningSpace::getCpus() const { return cpus; }
+
+int PinningSpace::getThreads() const { return threads; }
+
+PinningHistory::autopin_pinning PinningSpace::randomPinning() const {
+	QList<int> shuffled = cpus;
+
+	// Partial Fisher-Yates shuffle, we only need the first "threads" elements
+	for (int i = 0; i < threads; i++) shuffled.swap(i, i + qrand() % (shuffled.size() - i));
+
+	PinningHistory::autopin_pinning result;
+	for (int i = 0; i < threads; i++) result.push_back({shuffled[i]});
+
+	return result;
+}
+
+PinningHistory::autopin_pinning PinningSpace::neighbour(const PinningHistory::autopin_pinning &pinning) const {
+	PinningHistory::autopin_pinning result = pinning;
+
+	if (result.empty()) return result;
+
+	QList<int> unused;
+	for (auto cpu : cpus) {
+		if (std::none_of(result.begin(), result.end(),
+						 [cpu](const PinningHistory::autopin_cpuset &set) { return set.count(cpu) > 0; }))
+			unused.append(cpu);
+	}
+
+	if (result.size() >= 2 && (unused.isEmpty() || qrand() % 2 == 0)) {
+		// Swap the processors of two threads
+		int a = qrand() % result.size();
+		int b = qrand() % (result.size() - 1);
+		if (b >= a) b++;
+		std::swap(result[a], result[b]);
+	} else if (!unused.isEmpty()) {
+		// Move one thread to a processor which is currently not used
+		result[qrand() % result.size()] = {unused[qrand() % unused.size()]};
+	}
+
+	return result;
+}
+
+} // namespace AutopinPlus
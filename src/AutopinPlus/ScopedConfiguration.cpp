@@ -0,0 +1,48 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/ScopedConfiguration.h>
+
+namespace AutopinPlus {
+
+ScopedConfiguration::ScopedConfiguration(Configuration *global, QString scope, QStringList local,
+										 const AutopinContext &context)
+	: Configuration(0, nullptr, context), global(global), scope(scope), local(local) {
+	name = global->getName() + ":" + scope;
+}
+
+QString ScopedConfiguration::getScope() { return scope; }
+
+void ScopedConfiguration::init() {}
+
+Configuration::configopts ScopedConfiguration::getConfigOpts() {
+	Configuration::configopts result = global->getConfigOpts();
+	result.push_back(Configuration::configopt("scope", QStringList(scope)));
+	return result;
+}
+
+QStringList ScopedConfiguration::getConfigOptionList(QString opt) {
+	QStringList result = global->getConfigOptionList(scope + "." + opt);
+
+	if (result.empty() && !local.contains(opt)) result = global->getConfigOptionList(opt);
+
+	return result;
+}
+
+} // namespace AutopinPlus
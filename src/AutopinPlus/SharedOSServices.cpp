@@ -0,0 +1,132 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/SharedOSServices.h>
+
+namespace AutopinPlus {
+
+SharedOSServices::SharedOSServices(OSServices *base, const AutopinContext &context)
+	: OSServices(context), base(base) {}
+
+void SharedOSServices::setShare(const QList<int> &cpus) { share = cpus; }
+
+const QList<int> &SharedOSServices::getShare() const { return share; }
+
+void SharedOSServices::applyShare(const ProcessTree::autopin_tid_list &tasks) {
+	// Forget the affinities of terminated tasks
+	for (auto it = affinities.begin(); it != affinities.end();) {
+		if (tasks.count(it->first) == 0)
+			it = affinities.erase(it);
+		else
+			++it;
+	}
+
+	std::set<int> all(share.begin(), share.end());
+
+	for (int tid : tasks) {
+		auto it = affinities.find(tid);
+		if (it != affinities.end())
+			base->setAffinity(tid, mapCpus(it->second));
+		else
+			base->setAffinity(tid, all);
+	}
+}
+
+void SharedOSServices::init() {}
+
+QString SharedOSServices::getHostname() { return base->getHostname(); }
+
+QString SharedOSServices::getCommDefaultAddr() { return base->getCommDefaultAddr(); }
+
+int SharedOSServices::createProcess(QString cmd, bool wait) { return base->createProcess(cmd, wait); }
+
+void SharedOSServices::setAffinity(int tid, const std::set<int> &cpus) {
+	affinities[tid] = cpus;
+	base->setAffinity(tid, mapCpus(cpus));
+}
+
+void SharedOSServices::attachToProcess(ObservedProcess *observed_process) { base->attachToProcess(observed_process); }
+
+void SharedOSServices::detachFromProcess() { base->detachFromProcess(); }
+
+void SharedOSServices::initCommChannel(ObservedProcess *proc) { base->initCommChannel(proc); }
+
+void SharedOSServices::deinitCommChannel() { base->deinitCommChannel(); }
+
+void SharedOSServices::connectCommChannel(int timeout) { base->connectCommChannel(timeout); }
+
+void SharedOSServices::sendMsg(int event_id, int arg, double val) { base->sendMsg(event_id, arg, val); }
+
+ProcessTree::autopin_tid_list SharedOSServices::getPid(QString proc) { return base->getPid(proc); }
+
+QString SharedOSServices::getCmd(int pid) { return base->getCmd(pid); }
+
+ProcessTree::autopin_tid_list SharedOSServices::getProcessThreads(int pid) { return base->getProcessThreads(pid); }
+
+ProcessTree::autopin_tid_list SharedOSServices::getChildProcesses(int pid) { return base->getChildProcesses(pid); }
+
+int SharedOSServices::getTaskSortId(int tid) { return base->getTaskSortId(tid); }
+
+OSServices::autopin_topology SharedOSServices::getTopology() {
+	autopin_topology result, topology = base->getTopology();
+
+	for (int i = 0; i < share.size(); i++) {
+		for (auto cpu : topology) {
+			if (cpu.cpu != share[i]) continue;
+			cpu.cpu = i;
+			result.push_back(cpu);
+			break;
+		}
+	}
+
+	return result;
+}
+
+OSServices::autopin_memory_nodes SharedOSServices::getMemoryNodes(int tid) { return base->getMemoryNodes(tid); }
+
+void SharedOSServices::migrateMemory(int tid, const QList<int> &from, int to) { base->migrateMemory(tid, from, to); }
+
+OSServices::autopin_task_info SharedOSServices::getTaskInfo(int tid) { return base->getTaskInfo(tid); }
+
+int SharedOSServices::getTaskCreator(int tid) { return base->getTaskCreator(tid); }
+
+bool SharedOSServices::isRunning(int pid) { return base->isRunning(pid); }
+
+OSServices::autopin_cpu_states SharedOSServices::getCpuStates() {
+	autopin_cpu_states result, states = base->getCpuStates();
+
+	for (int i = 0; i < share.size(); i++) {
+		auto it = states.find(share[i]);
+		if (it != states.end()) result[i] = it->second;
+	}
+
+	return result;
+}
+
+std::set<int> SharedOSServices::mapCpus(const std::set<int> &cpus) {
+	std::set<int> result;
+
+	if (share.empty()) return result;
+
+	for (int cpu : cpus) result.insert(share[cpu % share.size()]);
+
+	return result;
+}
+
+} // namespace AutopinPlus
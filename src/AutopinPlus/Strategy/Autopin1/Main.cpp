@@ -28,6 +28,9 @@
 
 #include <AutopinPlus/Strategy/Autopin1/Main.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace AutopinPlus {
 namespace Strategy {
 namespace Autopin1 {
@@ -35,7 +38,11 @@ namespace Autopin1 {
 Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
 		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
 	: ControlStrategy(config, proc, service, monitors, history, context), current_pinning(0), best_pinning(-1),
-	  monitor(nullptr), notifications(false) {
+	  warmup_interval(0), warmup_window(3), warmup_tolerance(0.05), sample_interval(0), min_samples(5),
+	  confidence(0.95), precision(0.02), numa_weight(0), numa_migrate(false), freq_interval(0), freq_normalize(false),
+	  slow_threshold(0), throttle_weight(0), reference_freq(0), drift_interval(0), drift_threshold(0.1),
+	  drift_window(3), min_coverage(0.5), drift_count(0), best_rate(0), last_rate(0), monitor(nullptr),
+	  notifications(false) {
 	// Setup timers
 	init_timer.setSingleShot(true);
 	connect(&init_timer, SIGNAL(timeout()), this, SLOT(slot_startPinning()));
@@ -46,6 +53,14 @@ Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
 	measure_timer.setSingleShot(true);
 	connect(&measure_timer, SIGNAL(timeout()), this, SLOT(slot_stopPinning()));
 
+	connect(&sample_timer, SIGNAL(timeout()), this, SLOT(slot_sampleMonitor()));
+
+	connect(&warmup_sample_timer, SIGNAL(timeout()), this, SLOT(slot_sampleWarmup()));
+
+	connect(&freq_timer, SIGNAL(timeout()), this, SLOT(slot_sampleFrequency()));
+
+	connect(&drift_timer, SIGNAL(timeout()), this, SLOT(slot_sampleDrift()));
+
 	this->name = "autopin1";
 }
 
@@ -53,17 +68,24 @@ void Main::init() {
 
 	context.enableIndentation();
 
-	context.info("> Initializing control strategy autopin1");
+	context.info("> Initializing control strategy " + name);
+
+	CHECK_ERRORV(readOptions());
+
+	// Read the pinnings from the configuration, the objective of the strategy is needed for predicting pinnings
+	CHECK_ERRORV(pinnings = readPinnings(name + ".schedule", monitor_type));
 
-	QString config_prefix = "autopin1.";
+	context.disableIndentation();
+}
 
-	// Read the pinnings from the configuration
-	CHECK_ERRORV(pinnings = readPinnings(config_prefix + "schedule"));
+void Main::readOptions() {
+	QString config_prefix = name + ".";
 
 	// Select a performance monitor
 	if (!monitors.empty() && (*monitors.begin())->getValType() != PerformanceMonitor::UNKNOWN) {
 		monitor = *monitors.begin();
-		monitor_type = monitor->getValType();
+		monitor_type = objectiveType();
+		if (history != nullptr) history->setObjective(monitor_type);
 		context.info("  :: Using performance monitor \"" + monitor->getName() + "\"");
 	} else
 		REPORTV(Error::BAD_CONFIG, "no_monitor", "No performance monitor found!");
@@ -75,6 +97,25 @@ void Main::init() {
 	openmp_icc = false;
 	skip.clear();
 	notification_interval = 0;
+	warmup_interval = 0;
+	warmup_window = 3;
+	warmup_tolerance = 0.05;
+	sample_interval = 0;
+	min_samples = 5;
+	confidence = 0.95;
+	precision = 0.02;
+	numa_weight = 0;
+	numa_migrate = false;
+	cpu_nodes.clear();
+	freq_interval = 0;
+	freq_normalize = false;
+	slow_threshold = 0;
+	throttle_weight = 0;
+	reference_freq = 0;
+	drift_interval = 0;
+	drift_threshold = 0.1;
+	drift_window = 3;
+	min_coverage = 0.5;
 
 	// Read user values from the configuration
 	if (config->configOptionExists(config_prefix + "init_time") > 0)
@@ -95,6 +136,57 @@ void Main::init() {
 	if (config->configOptionExists(config_prefix + "notification_interval") > 0)
 		notification_interval = config->getConfigOptionInt(config_prefix + "notification_interval");
 
+	if (config->configOptionExists(config_prefix + "warmup_interval") > 0)
+		warmup_interval = config->getConfigOptionInt(config_prefix + "warmup_interval");
+
+	if (config->configOptionExists(config_prefix + "warmup_window") > 0)
+		warmup_window = config->getConfigOptionInt(config_prefix + "warmup_window");
+
+	if (config->configOptionExists(config_prefix + "warmup_tolerance") > 0)
+		warmup_tolerance = config->getConfigOptionDouble(config_prefix + "warmup_tolerance");
+
+	if (config->configOptionExists(config_prefix + "sample_interval") > 0)
+		sample_interval = config->getConfigOptionInt(config_prefix + "sample_interval");
+
+	if (config->configOptionExists(config_prefix + "min_samples") > 0)
+		min_samples = config->getConfigOptionInt(config_prefix + "min_samples");
+
+	if (config->configOptionExists(config_prefix + "confidence") > 0)
+		confidence = config->getConfigOptionDouble(config_prefix + "confidence");
+
+	if (config->configOptionExists(config_prefix + "precision") > 0)
+		precision = config->getConfigOptionDouble(config_prefix + "precision");
+
+	if (config->configOptionExists(config_prefix + "numa_weight") > 0)
+		numa_weight = config->getConfigOptionDouble(config_prefix + "numa_weight");
+
+	if (config->configOptionBool(config_prefix + "numa_migrate"))
+		numa_migrate = config->getConfigOptionBool(config_prefix + "numa_migrate");
+
+	if (config->configOptionExists(config_prefix + "freq_interval") > 0)
+		freq_interval = config->getConfigOptionInt(config_prefix + "freq_interval");
+
+	if (config->configOptionBool(config_prefix + "freq_normalize"))
+		freq_normalize = config->getConfigOptionBool(config_prefix + "freq_normalize");
+
+	if (config->configOptionExists(config_prefix + "slow_threshold") > 0)
+		slow_threshold = config->getConfigOptionDouble(config_prefix + "slow_threshold");
+
+	if (config->configOptionExists(config_prefix + "throttle_weight") > 0)
+		throttle_weight = config->getConfigOptionDouble(config_prefix + "throttle_weight");
+
+	if (config->configOptionExists(config_prefix + "drift_interval") > 0)
+		drift_interval = config->getConfigOptionInt(config_prefix + "drift_interval");
+
+	if (config->configOptionExists(config_prefix + "drift_threshold") > 0)
+		drift_threshold = config->getConfigOptionDouble(config_prefix + "drift_threshold");
+
+	if (config->configOptionExists(config_prefix + "drift_window") > 0)
+		drift_window = config->getConfigOptionInt(config_prefix + "drift_window");
+
+	if (config->configOptionExists(config_prefix + "min_coverage") > 0)
+		min_coverage = config->getConfigOptionDouble(config_prefix + "min_coverage");
+
 	for (int i = 0; i < skip_str.size(); i++) {
 		QString entry = skip_str[i];
 		bool ok;
@@ -103,15 +195,95 @@ void Main::init() {
 		skip.insert(entry_int);
 	}
 
+	// The second thread of an OpenMP program compiled with icc is a helper thread
+	if (openmp_icc) skip.insert(1);
+
+	auto option = [&](const QString &opt) {
+		if (config->configOptionExists(config_prefix + opt) > 0) return config->getConfigOptionList(config_prefix + opt);
+		return QStringList();
+	};
+	CHECK_ERRORV(readRoles(option));
+
 	if (init_time < 0) REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid init time: " + QString::number(init_time));
 	if (warmup_time < 0)
 		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid warmup time: " + QString::number(warmup_time));
 	if (measure_time <= 0)
 		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid measure time: " + QString::number(measure_time));
+	if (warmup_interval < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid warmup interval: " + QString::number(warmup_interval));
+	if (warmup_window < 2)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid warmup window: " + QString::number(warmup_window));
+	if (warmup_tolerance < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid warmup tolerance: " + QString::number(warmup_tolerance));
+	if (sample_interval < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid sample interval: " + QString::number(sample_interval));
+	if (min_samples < 2)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid minimum number of samples: " + QString::number(min_samples));
+	if (confidence <= 0 || confidence >= 1)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid confidence level: " + QString::number(confidence));
+	if (precision < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid precision: " + QString::number(precision));
+	if (numa_weight < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid NUMA weight: " + QString::number(numa_weight));
+	if (freq_interval < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid frequency interval: " + QString::number(freq_interval));
+	if (slow_threshold < 0 || slow_threshold > 1)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid slow threshold: " + QString::number(slow_threshold));
+	if (throttle_weight < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid throttle weight: " + QString::number(throttle_weight));
+	if (drift_interval < 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid drift interval: " + QString::number(drift_interval));
+	if (drift_threshold <= 0)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid drift threshold: " + QString::number(drift_threshold));
+	if (drift_window < 1)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid drift window: " + QString::number(drift_window));
+	if (min_coverage < 0 || min_coverage > 1)
+		REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid minimum coverage: " + QString::number(min_coverage));
+
+	if (numa_weight > 0 || numa_migrate) {
+		OSServices::autopin_topology topology;
+		CHECK_ERRORV(topology = service->getTopology());
+		for (const auto &cpu : topology) cpu_nodes[cpu.cpu] = cpu.node;
+	}
+
+	if (freq_normalize || throttle_weight > 0) {
+		OSServices::autopin_cpu_states states;
+		CHECK_ERRORV(states = service->getCpuStates());
+		for (const auto &state : states) reference_freq = std::max(reference_freq, state.second.max_frequency);
+
+		if (states.empty())
+			context.report(Error::UNSUPPORTED, "uncritical", "The frequencies of the cpus are not available");
+	}
 
 	context.info("  :: Init time: " + QString::number(init_time));
 	context.info("  :: Warmup time: " + QString::number(warmup_time));
 	context.info("  :: Measure time: " + QString::number(measure_time));
+	if (warmup_interval > 0) {
+		context.info("  :: Adaptive warmup is enabled (sample interval: " + QString::number(warmup_interval) +
+					 " ms, window: " + QString::number(warmup_window) + ", tolerance: " +
+					 QString::number(warmup_tolerance) + ")");
+	}
+	if (sample_interval > 0) {
+		context.info("  :: Early termination is enabled (sample interval: " + QString::number(sample_interval) +
+					 " ms, minimum samples: " + QString::number(min_samples) + ", confidence: " +
+					 QString::number(confidence) + ", precision: " + QString::number(precision) + ")");
+		if (numa_weight > 0 || freq_normalize || throttle_weight > 0)
+			context.info("  :: Results are adjusted, measurements only end early when they are precise enough");
+	}
+	if (numa_weight > 0)
+		context.info("  :: Memory locality feedback is enabled (weight: " + QString::number(numa_weight) + ")");
+	if (numa_migrate) context.info("  :: Memory migration is enabled");
+	if (freq_normalize)
+		context.info("  :: Results are normalized to " + QString::number(reference_freq) + " MHz (sample interval: " +
+					 QString::number(freq_interval) + " ms)");
+	if (throttle_weight > 0)
+		context.info("  :: Throttled cpus are penalized (weight: " + QString::number(throttle_weight) +
+					 ", slow threshold: " + QString::number(slow_threshold) + ")");
+	if (drift_interval > 0) {
+		context.info("  :: Drift detection is enabled (sample interval: " + QString::number(drift_interval) +
+					 " s, threshold: " + QString::number(drift_threshold) + ", window: " +
+					 QString::number(drift_window) + ")");
+	}
 	if (openmp_icc) context.info("  :: OpenMP/ICC support is enabled");
 	if (!skip.empty()) context.info("  :: These tasks will be skipped: " + skip_str.join(" "));
 
@@ -121,8 +293,10 @@ void Main::init() {
 	init_timer.setInterval(init_time * 1000);
 	warmup_timer.setInterval(warmup_time * 1000);
 	measure_timer.setInterval(measure_time * 1000);
-
-	context.disableIndentation();
+	sample_timer.setInterval(sample_interval);
+	warmup_sample_timer.setInterval(warmup_interval);
+	freq_timer.setInterval(freq_interval);
+	drift_timer.setInterval(drift_interval * 1000);
 }
 
 Configuration::configopts Main::getConfigOpts() {
@@ -139,9 +313,29 @@ Configuration::configopts Main::getConfigOpts() {
 
 	result.push_back(Configuration::configopt("skip", skip_str));
 
+	for (const auto &opt : getRoleOpts()) result.push_back(opt);
+
 	result.push_back(
 		Configuration::configopt("notification_interval", QStringList(QString::number(notification_interval))));
 
+	result.push_back(Configuration::configopt("warmup_interval", QStringList(QString::number(warmup_interval))));
+	result.push_back(Configuration::configopt("warmup_window", QStringList(QString::number(warmup_window))));
+	result.push_back(Configuration::configopt("warmup_tolerance", QStringList(QString::number(warmup_tolerance))));
+	result.push_back(Configuration::configopt("sample_interval", QStringList(QString::number(sample_interval))));
+	result.push_back(Configuration::configopt("min_samples", QStringList(QString::number(min_samples))));
+	result.push_back(Configuration::configopt("confidence", QStringList(QString::number(confidence))));
+	result.push_back(Configuration::configopt("precision", QStringList(QString::number(precision))));
+	result.push_back(Configuration::configopt("numa_weight", QStringList(QString::number(numa_weight))));
+	result.push_back(Configuration::configopt("numa_migrate", QStringList(numa_migrate ? "true" : "false")));
+	result.push_back(Configuration::configopt("freq_interval", QStringList(QString::number(freq_interval))));
+	result.push_back(Configuration::configopt("freq_normalize", QStringList(freq_normalize ? "true" : "false")));
+	result.push_back(Configuration::configopt("slow_threshold", QStringList(QString::number(slow_threshold))));
+	result.push_back(Configuration::configopt("throttle_weight", QStringList(QString::number(throttle_weight))));
+	result.push_back(Configuration::configopt("drift_interval", QStringList(QString::number(drift_interval))));
+	result.push_back(Configuration::configopt("drift_threshold", QStringList(QString::number(drift_threshold))));
+	result.push_back(Configuration::configopt("drift_window", QStringList(QString::number(drift_window))));
+	result.push_back(Configuration::configopt("min_coverage", QStringList(QString::number(min_coverage))));
+
 	return result;
 }
 
@@ -171,20 +365,111 @@ void Main::slot_startPinning() {
 	QString msg =
 		"> Test pinning " + QString::number(current_pinning + 1) + " of " + QString::number(pinnings.size()) + ":";
 
-	for (auto &elem : new_pinning) msg += " " + QString::number(elem);
+	for (auto &elem : new_pinning) msg += " " + PinningHistory::showCpuSet(elem);
 
 	context.info(msg);
 
 	// Pin threads
 	CHECK_ERRORV(applyPinning(new_pinning));
+	if (numa_migrate) CHECK_ERRORV(migrateMemory());
 
 	// Start timer
-	context.info("> Waiting " + QString::number(warmup_time) + " seconds (warmup time)");
+	if (warmup_interval > 0) {
+		context.info("> Waiting at most " + QString::number(warmup_time) + " seconds (warmup time)");
+
+		// Monitor the tasks until their performance has settled
+		warmup_start.invalidate();
+		warmup_start.start();
+		last_samples.clear();
+		warmup_rates.clear();
+
+		for (auto &elem : pinned_tasks) {
+			CHECK_ERRORV(monitor->start(elem.tid));
+			warmup_tasks.insert(elem.tid);
+		}
+
+		warmup_sample_timer.start();
+	} else {
+		context.info("> Waiting " + QString::number(warmup_time) + " seconds (warmup time)");
+	}
+
 	context.disableIndentation();
 	warmup_timer.start();
 }
 
+void Main::slot_sampleWarmup() {
+	if (!warmup_timer.isActive()) {
+		warmup_sample_timer.stop();
+		return;
+	}
+
+	double rate;
+	bool sampled;
+	CHECK_ERRORV(sampled = readRate(warmup_tasks, warmup_start.elapsed(), rate));
+	if (!sampled) return;
+
+	warmup_rates.push_back(rate);
+	if ((int)warmup_rates.size() > warmup_window) warmup_rates.pop_front();
+	if ((int)warmup_rates.size() < warmup_window) return;
+
+	// The warmup has finished when all rates in the window are close to their mean
+	double mean = 0;
+	for (auto elem : warmup_rates) mean += elem;
+	mean /= warmup_rates.size();
+
+	for (auto elem : warmup_rates) {
+		if (std::fabs(elem - mean) > warmup_tolerance * std::fabs(mean)) return;
+	}
+
+	context.enableIndentation();
+	context.info("> Performance has settled after " + QString::number(warmup_start.elapsed() / 1000.0) +
+				 " seconds, ending warmup");
+	context.disableIndentation();
+
+	warmup_timer.stop();
+	slot_startMonitor();
+}
+
+void Main::stopWarmupMonitoring() {
+	warmup_sample_timer.stop();
+
+	for (auto tid : warmup_tasks) CHECK_ERRORV(monitor->stop(tid));
+	warmup_tasks.clear();
+}
+
+bool Main::readRate(const std::set<int> &tids, qint64 now, double &rate) {
+	double sum = 0;
+	int count = 0;
+
+	for (auto tid : tids) {
+		double value;
+		CHECK_ERROR(value = monitor->value(tid), false);
+
+		// Values like instructions per cycle are already rates
+		if (!monitor->isCumulative()) {
+			sum += value;
+			count++;
+			continue;
+		}
+
+		auto last = last_samples.find(tid);
+		if (last != last_samples.end() && now > last->second.second) {
+			sum += (value - last->second.first) / (now - last->second.second);
+			count++;
+		}
+
+		last_samples[tid] = std::make_pair(value, now);
+	}
+
+	if (count == 0) return false;
+
+	rate = sum / count;
+	return true;
+}
+
 void Main::slot_startMonitor() {
+	CHECK_ERRORV(stopWarmupMonitoring());
+
 	context.enableIndentation();
 
 	// Start timer
@@ -200,33 +485,137 @@ void Main::slot_startMonitor() {
 		it->stop = -1;
 	}
 
+	if (freq_normalize || throttle_weight > 0) {
+		freq_samples.clear();
+		CHECK_ERRORV(start_states = service->getCpuStates());
+		CHECK_ERRORV(slot_sampleFrequency());
+		if (freq_interval > 0) freq_timer.start();
+	}
+
+	CHECK_ERRORV(startMeasurement());
+
 	// Start timer
 	context.info("> Waiting " + QString::number(measure_time) + " seconds (measure time)");
 	context.disableIndentation();
 	measure_timer.start();
+
+	samples.clear();
+	last_samples.clear();
+	if (sample_interval > 0) sample_timer.start();
+}
+
+void Main::slot_sampleMonitor() {
+	if (!measure_timer.isActive()) {
+		sample_timer.stop();
+		return;
+	}
+
+	// Determine the performance of all running tasks since the last sample
+	std::set<int> tids;
+	for (auto &elem : pinned_tasks) {
+		if (elem.stop == -1 && !elem.inherited) tids.insert(elem.tid);
+	}
+
+	double current_sample;
+	bool sampled;
+	CHECK_ERRORV(sampled = readRate(tids, measure_start.elapsed(), current_sample));
+	if (!sampled) return;
+
+	samples.push_back(current_sample);
+
+	if ((int)samples.size() < min_samples) return;
+
+	// Compute the mean and the confidence interval of the samples
+	double mean = 0, variance = 0;
+	for (auto sample : samples) mean += sample;
+	mean /= samples.size();
+	for (auto sample : samples) variance += (sample - mean) * (sample - mean);
+	variance /= samples.size() - 1;
+	double halfwidth = zValue(confidence) * std::sqrt(variance / samples.size());
+
+	QString reason;
+
+	// The samples are raw rates of the monitor, so they are compared with the rate of the best pinning before any
+	// adjustments and in the direction of the monitor. If the results are adjusted, a pinning with a worse rate may
+	// still have the better result, so it can't be ruled out before the adjustments are known.
+	bool bigger_better = monitor->getValType() == PerformanceMonitor::montype::MAX;
+	bool comparable =
+		best_pinning != -1 && best_rate > 0 && numa_weight == 0 && !freq_normalize && throttle_weight == 0;
+
+	if (comparable && bigger_better && mean + halfwidth < best_rate)
+		reason = "pinning is worse than the best pinning";
+	else if (comparable && !bigger_better && mean - halfwidth > best_rate)
+		reason = "pinning is worse than the best pinning";
+	else if (halfwidth <= precision * std::fabs(mean))
+		reason = "result is precise enough";
+
+	if (reason.isEmpty()) return;
+
+	context.enableIndentation();
+	context.info("> Ending measurement after " + QString::number(samples.size()) + " samples (" + reason + ")");
+	context.disableIndentation();
+
+	sample_timer.stop();
+	measure_timer.stop();
+	QTimer::singleShot(0, this, SLOT(slot_stopPinning()));
 }
 
 void Main::slot_stopPinning() {
 	context.enableIndentation();
 	notifications = false;
+	sample_timer.stop();
+	freq_timer.stop();
 
 	context.info("> Reading results of pinning " + QString::number(current_pinning + 1));
 	CHECK_ERRORV(checkPinnedTasks());
 
 	double current_result = 0;
+	double coverage = 1;
+	int measured = 0;
 
 	for (auto &elem : pinned_tasks) {
+		// The values of tasks created during the measurement are included in those of their creators
+		if (elem.inherited) continue;
+
 		if (elem.stop == -1) {
 			elem.stop = measure_start.elapsed();
 			CHECK_ERRORV(elem.result = monitor->stop(elem.tid));
+			elem.coverage = monitor->getCoverage(elem.tid);
 		}
-		double tres = elem.result;
-		elem.result = tres / (elem.stop - elem.start);
+		// Only counts depend on the length of the measurement
+		if (monitor->isCumulative()) elem.result = elem.result / (elem.stop - elem.start);
 		context.info("  :: Result for task " + QString::number(elem.tid) + ": " + QString::number(elem.result));
 		current_result += elem.result;
+		coverage = std::min(coverage, elem.coverage);
+		measured++;
 	}
 
-	current_result = current_result / pinned_tasks.size();
+	// The values of multiplexed counters are extrapolated by the monitor, which is less reliable the less time
+	// the counters were actually running
+	bool reliable = coverage >= min_coverage;
+	if (coverage < 1) context.info("  :: Counters were running " + QString::number(coverage * 100) + "% of the time");
+	if (!reliable) {
+		context.info("  :: The result is unreliable (minimum coverage: " + QString::number(min_coverage * 100) +
+					 "%), it won't be stored in the pinning history");
+	}
+
+	current_result = current_result / measured;
+	last_rate = current_result;
+	if (freq_normalize || throttle_weight > 0) CHECK_ERRORV(current_result = adjustForFrequency(current_result));
+	CHECK_ERRORV(current_result = evaluatePinning(current_result));
+
+	// Penalize pinnings which separate the tasks from their memory
+	if (numa_weight > 0) {
+		double locality = 0;
+		CHECK_ERRORV(locality = memoryLocality());
+		context.info("  :: Memory locality: " + QString::number(locality));
+
+		double penalty = 1 + numa_weight * (1 - locality);
+		if (monitor_type == PerformanceMonitor::montype::MAX)
+			current_result /= penalty;
+		else
+			current_result *= penalty;
+	}
 
 	switch (monitor_type) {
 	case PerformanceMonitor::montype::MAX:
@@ -254,25 +643,262 @@ void Main::slot_stopPinning() {
 		return;
 	}
 
+	if (best_pinning == current_pinning) best_rate = last_rate;
+
 	context.biginfo("> Result of pinning " + QString::number(current_pinning + 1) + ": " +
 					QString::number(current_result));
-	addPinningToHistory(pinnings[current_pinning], current_result);
+	if (reliable && addPinningToHistory(pinnings[current_pinning], current_result))
+		history->setPinningTasks(proc->getExecutionPhase(), pinnings[current_pinning], pinned_ids);
 	pinned_tasks.clear();
 
-	current_pinning++;
-	if ((uint)current_pinning < pinnings.size()) {
+	if (nextPinning(current_result)) {
 		QTimer::singleShot(0, this, SLOT(slot_startPinning()));
 	} else {
-		context.info("");
-		context.info("> All pinnings have been tested");
-		context.info("> Applying best pinning: " + QString::number(best_pinning + 1));
-		CHECK_ERRORV(refreshTasks());
-		applyPinning(pinnings[best_pinning]);
-		context.biginfo("> Control strategy autopin1 has finished");
-		if (history != nullptr) history->deinit();
+		finish();
+	}
+
+	context.disableIndentation();
+}
+
+void Main::finish() {
+	context.info("");
+	context.info("> All pinnings have been tested");
+	context.info("> Applying best pinning: " + QString::number(best_pinning + 1));
+	CHECK_ERRORV(refreshTasks());
+	applyPinning(pinnings[best_pinning]);
+	context.biginfo("> Control strategy " + name + " has finished");
+	if (history != nullptr) history->deinit();
+
+	if (drift_interval > 0) startDriftDetection();
+}
+
+void Main::restart() {
+	current_pinning = 0;
+	best_pinning = -1;
+	best_performance = 0;
+}
+
+void Main::startDriftDetection() {
+	context.enableIndentation();
+
+	if (best_rate <= 0) {
+		context.info("> The rate of the best pinning is not known, performance drift can't be detected");
+		context.disableIndentation();
+		return;
 	}
 
+	context.info("> Watching for performance drift (reference: " + QString::number(best_rate) + ")");
 	context.disableIndentation();
+
+	measure_start.invalidate();
+	measure_start.start();
+	last_samples.clear();
+	drift_count = 0;
+
+	for (auto &elem : pinned_tasks) CHECK_ERRORV(monitor->start(elem.tid));
+
+	drift_timer.start();
+}
+
+void Main::slot_sampleDrift() {
+	CHECK_ERRORV(checkPinnedTasks());
+
+	std::set<int> tids;
+	for (auto &elem : pinned_tasks) tids.insert(elem.tid);
+
+	double rate;
+	bool sampled;
+	CHECK_ERRORV(sampled = readRate(tids, measure_start.elapsed(), rate));
+	if (!sampled) return;
+
+	// The samples are raw rates of the monitor like best_rate
+	bool worse = (monitor->getValType() == PerformanceMonitor::montype::MAX) ? rate < best_rate * (1 - drift_threshold)
+																			 : rate > best_rate * (1 + drift_threshold);
+
+	if (!worse) {
+		drift_count = 0;
+		return;
+	}
+
+	drift_count++;
+
+	context.enableIndentation();
+	context.info("> Performance has drifted: " + QString::number(rate) + " (" + QString::number(drift_count) + "/" +
+				 QString::number(drift_window) + ")");
+
+	if (drift_count < drift_window) {
+		context.disableIndentation();
+		return;
+	}
+
+	drift_timer.stop();
+	for (auto &elem : pinned_tasks) CHECK_ERRORV(monitor->stop(elem.tid));
+	pinned_tasks.clear();
+
+	context.biginfo("> Starting a new round of tuning");
+	context.disableIndentation();
+
+	restart();
+	QTimer::singleShot(0, this, SLOT(slot_startPinning()));
+}
+
+void Main::startMeasurement() {}
+
+double Main::evaluatePinning(double performance) { return performance; }
+
+PerformanceMonitor::montype Main::objectiveType() { return monitor->getValType(); }
+
+bool Main::nextPinning(double result) {
+	current_pinning++;
+	return (uint)current_pinning < pinnings.size();
+}
+
+double Main::zValue(double confidence) {
+	// Find z with P(|X| <= z) = confidence by bisection
+	double low = 0, high = 10;
+	for (int i = 0; i < 100; i++) {
+		double z = (low + high) / 2;
+		if (std::erf(z / std::sqrt(2.0)) < confidence)
+			low = z;
+		else
+			high = z;
+	}
+
+	return (low + high) / 2;
+}
+
+double Main::memoryLocality() {
+	double result = 0;
+	int count = 0;
+
+	for (const auto &elem : pinned_tasks) {
+		OSServices::autopin_memory_nodes nodes;
+		CHECK_ERROR(nodes = service->getMemoryNodes(elem.tid), 1);
+
+		unsigned long total = 0;
+		for (const auto &node : nodes) total += node.second;
+		if (total == 0) continue;
+
+		std::set<int> local_nodes;
+		for (int cpu : elem.cpus) local_nodes.insert(cpu_nodes[cpu]);
+
+		unsigned long local = 0;
+		for (int node : local_nodes) local += nodes[node];
+
+		result += (double)local / total;
+		count++;
+	}
+
+	return (count > 0) ? result / count : 1;
+}
+
+void Main::migrateMemory() {
+	std::map<int, int> used_nodes;
+	for (const auto &elem : pinned_tasks) {
+		for (int cpu : elem.cpus) used_nodes[cpu_nodes[cpu]]++;
+	}
+
+	if (used_nodes.empty()) return;
+
+	int target = used_nodes.begin()->first;
+	for (const auto &node : used_nodes) {
+		if (node.second > used_nodes[target]) target = node.first;
+	}
+
+	// Tasks of the same process share their memory, so only the first one of them will find something to move
+	for (const auto &elem : pinned_tasks) {
+		OSServices::autopin_memory_nodes nodes;
+		CHECK_ERRORV(nodes = service->getMemoryNodes(elem.tid));
+
+		QList<int> from;
+		for (const auto &node : nodes) {
+			if (node.second > 0 && used_nodes.count(node.first) == 0) from.append(node.first);
+		}
+
+		if (from.isEmpty()) continue;
+
+		context.info("  :: Moving memory of task " + QString::number(elem.tid) + " to node " + QString::number(target));
+		CHECK_ERRORV(service->migrateMemory(elem.tid, from, target));
+	}
+}
+
+PinningHistory::autopin_cpuset Main::pinnedCpus() {
+	PinningHistory::autopin_cpuset result;
+	for (const auto &elem : pinned_tasks) result.insert(elem.cpus.begin(), elem.cpus.end());
+	return result;
+}
+
+void Main::slot_sampleFrequency() {
+	OSServices::autopin_cpu_states states;
+	CHECK_ERRORV(states = service->getCpuStates());
+
+	for (auto cpu : pinnedCpus()) {
+		auto state = states.find(cpu);
+		if (state == states.end() || state->second.frequency <= 0) continue;
+
+		freq_samples[cpu].first += state->second.frequency;
+		freq_samples[cpu].second++;
+	}
+}
+
+double Main::adjustForFrequency(double performance) {
+	OSServices::autopin_cpu_states states;
+	CHECK_ERROR(slot_sampleFrequency(), performance);
+	CHECK_ERROR(states = service->getCpuStates(), performance);
+
+	PinningHistory::autopin_cpuset cpus = pinnedCpus();
+	double frequency = 0;
+	int known = 0;
+	QStringList degraded;
+
+	for (auto cpu : cpus) {
+		auto samples = freq_samples.find(cpu);
+		auto state = states.find(cpu);
+		auto start = start_states.find(cpu);
+
+		double average = 0;
+		if (samples != freq_samples.end() && samples->second.second > 0) {
+			average = samples->second.first / samples->second.second;
+			frequency += average;
+			known++;
+		}
+
+		if (state == states.end() || start == start_states.end()) continue;
+
+		if (state->second.throttle_count > start->second.throttle_count)
+			degraded.push_back(QString::number(cpu) + " (throttled)");
+		else if (slow_threshold > 0 && average > 0 && average < slow_threshold * state->second.max_frequency)
+			degraded.push_back(QString::number(cpu) + " (slow)");
+	}
+
+	if (known > 0) {
+		frequency /= known;
+		context.info("  :: Average frequency: " + QString::number(frequency) + " MHz");
+	}
+
+	// The adjustments are applied to the rate of the monitor, which may be optimized in the other direction than the
+	// result of evaluatePinning()
+	bool bigger_better = monitor->getValType() == PerformanceMonitor::montype::MAX;
+
+	// The performance is assumed to be proportional to the frequency
+	if (freq_normalize && frequency > 0 && reference_freq > 0) {
+		if (bigger_better)
+			performance *= reference_freq / frequency;
+		else
+			performance *= frequency / reference_freq;
+	}
+
+	if (throttle_weight > 0 && !degraded.empty() && !cpus.empty()) {
+		context.info("  :: Degraded cpus: " + degraded.join(" "));
+
+		double penalty = 1 + throttle_weight * degraded.size() / cpus.size();
+		if (bigger_better)
+			performance /= penalty;
+		else
+			performance *= penalty;
+	}
+
+	return performance;
 }
 
 void Main::slot_TaskCreated(int tid) {
@@ -283,43 +909,89 @@ void Main::slot_TaskCreated(int tid) {
 
 		if (it != pinned_tasks.end()) return;
 
-		unsigned int i = pinned_tasks.size();
-		PinningHistory::autopin_pinning pinning = pinnings[current_pinning];
-		if (i < pinning.size()) {
-			int j = tasks.size();
-			if (skip.find(j) != skip.end()) {
-				context.info("  :: Not pinning task " + QString::number(tid) + " (skipped)");
-			} else if (j == 1 && openmp_icc) {
-				context.info("  :: Not pinning task " + QString::number(tid) + " (icc thread)");
-			} else {
-				context.info("  :: Pinning task " + QString::number(tid) + " to core " + QString::number(pinning[i]));
-				CHECK_ERRORV(service->setAffinity(tid, pinning[i]));
-
-				pinned_task new_entry;
-				new_entry.tid = tid;
-
-				// Start monitor if measurement is already running
-				if (measure_timer.isActive()) {
-					CHECK_ERRORV(monitor->start(tid));
-					new_entry.start = measure_start.elapsed();
-					new_entry.stop = -1;
-				}
-
-				pinned_tasks.push_back(new_entry);
-			}
-		}
+		int index = tasks.size();
 		tasks.push_back(tid);
+
+		// A new task still has the name of its creator and hasn't been running yet, so it is only classified
+		// after it has been running for a while
+		if (role_rules.empty()) {
+			CHECK_ERRORV(pinCreatedTask(tid, index));
+		} else {
+			created_task task = {tid, index, Clock::now()};
+			created_tasks.push_back(task);
+			QTimer::singleShot(role_delay, this, SLOT(slot_pinCreatedTask()));
+		}
 	}
 }
 
+void Main::slot_pinCreatedTask() {
+	// The list is cleared when a pinning is applied, so the timer may find tasks of a later pinning
+	while (!created_tasks.empty() && Clock::now() - created_tasks.front().time >= role_delay) {
+		created_task task = created_tasks.front();
+		created_tasks.pop_front();
+
+		if (notifications) CHECK_ERRORV(pinCreatedTask(task.tid, task.index));
+	}
+}
+
+void Main::pinCreatedTask(int tid, int index) {
+	QString role;
+	if (!selectTask(tid, index, skip, role)) return;
+
+	std::set<int> used;
+	for (const auto &elem : pinned_tasks) used.insert(elem.entry);
+
+	int i = selectEntry(role, used);
+	if (i < 0) return;
+
+	const PinningHistory::autopin_pinning &pinning = pinnings[current_pinning];
+	context.info("  :: Pinning task " + QString::number(tid) + " (role " + role + ") to core " +
+				 PinningHistory::showCpuSet(pinning[i]));
+	CHECK_ERRORV(service->setAffinity(tid, pinning[i]));
+
+	pinned_task new_entry;
+	new_entry.tid = tid;
+	new_entry.cpus = pinning[i];
+	new_entry.inherited = false;
+	new_entry.entry = i;
+	while (pinned_ids.size() <= i) pinned_ids.push_back("");
+	pinned_ids[i] = getTaskId(tid);
+
+	// Start monitor if measurement is already running. Process-wide monitors already count the task
+	// as part of the task which created it.
+	if (measure_timer.isActive() && monitor->isProcessWide()) {
+		new_entry.inherited = true;
+	} else if (measure_timer.isActive()) {
+		CHECK_ERRORV(monitor->start(tid));
+		new_entry.start = measure_start.elapsed();
+		new_entry.stop = -1;
+	}
+
+	pinned_tasks.push_back(new_entry);
+}
+
 void Main::slot_TaskTerminated(int tid) {
-	if (notifications) {
+	if (notifications || drift_timer.isActive()) {
+		// The monitor is stopped below
+		warmup_tasks.erase(tid);
+
+		auto created = std::find_if(created_tasks.begin(), created_tasks.end(),
+									[tid](const created_task &t) { return t.tid == tid; });
+		if (created != created_tasks.end()) created_tasks.erase(created);
+
 		auto it = std::find_if(pinned_tasks.begin(), pinned_tasks.end(),
 							   [tid](const pinned_task &t) { return t.tid == tid; });
 
 		if (it == pinned_tasks.end()) return;
 
-		CHECK_ERRORV(it->result = monitor->stop(tid));
+		// The counters of process-wide monitors also include the tasks created by this task, which may still be
+		// running, so they are read at the end of the measurement
+		if (monitor->isProcessWide() && measure_timer.isActive()) return;
+
+		if (!it->inherited) {
+			CHECK_ERRORV(it->result = monitor->stop(tid));
+			it->coverage = monitor->getCoverage(tid);
+		}
 
 		if (measure_timer.isActive()) {
 			it->stop = measure_start.elapsed();
@@ -337,6 +1009,9 @@ void Main::slot_PhaseChanged(int newphase) {
 		// Stop all timers
 		warmup_timer.stop();
 		measure_timer.stop();
+		sample_timer.stop();
+		freq_timer.stop();
+		CHECK_ERRORV(stopWarmupMonitoring());
 
 		// Clear the list of pinned tasks
 		pinned_tasks.clear();
@@ -353,24 +1028,29 @@ void Main::slot_PhaseChanged(int newphase) {
 }
 
 void Main::applyPinning(PinningHistory::autopin_pinning pinning) {
-	// i counts the pinnings
-	// j counts the tasks
-	unsigned int i = 0, j = 0;
-	while (i < pinning.size() && j < tasks.size()) {
-		if (skip.find(j) != skip.end()) {
-			context.info("  :: Not pinning task " + QString::number(tasks[j]) + " (skipped)");
-		} else if (j == 1 && openmp_icc) {
-			context.info("  :: Not pinning task " + QString::number(tasks[j]) + " (icc thread)");
-		} else {
-			pinned_task new_entry;
-			new_entry.tid = tasks[j];
-			context.info("  :: Pinning task " + QString::number(tasks[j]) + " to core " + QString::number(pinning[i]));
-			CHECK_ERRORV(service->setAffinity(tasks[j], pinning[i]));
-			pinned_tasks.push_back(new_entry);
-			i++;
-		}
-
-		j++;
+	autopin_tasklist selected;
+	QStringList roles;
+	CHECK_ERRORV(selected = selectTasks(skip, roles));
+
+	// Tasks created before are classified by selectTasks()
+	created_tasks.clear();
+
+	// The entries assigned to the tasks of a role are used for the new tasks of this role
+	entry_roles.clear();
+	for (unsigned int i = 0; i < pinning.size(); i++) entry_roles.push_back(i < selected.size() ? roles[i] : "");
+
+	pinned_ids.clear();
+	for (unsigned int i = 0; i < pinning.size() && i < selected.size(); i++) {
+		pinned_task new_entry;
+		new_entry.tid = selected[i];
+		new_entry.cpus = pinning[i];
+		new_entry.inherited = false;
+		new_entry.entry = i;
+		pinned_ids.push_back(getTaskId(selected[i]));
+		context.info("  :: Pinning task " + QString::number(selected[i]) + " to core " +
+					 PinningHistory::showCpuSet(pinning[i]));
+		CHECK_ERRORV(service->setAffinity(selected[i], pinning[i]));
+		pinned_tasks.push_back(new_entry);
 	}
 }
 
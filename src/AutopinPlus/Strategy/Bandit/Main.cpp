@@ -0,0 +1,234 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Bandit/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <algorithm>						// for find, max
+#include <cmath>							// for sqrt, log, cos, fabs
+#include <qdatetime.h>						// for QTime
+#include <qglobal.h>						// for qrand, qsrand
+#include <qstringlist.h>					// for QStringList
+#include <stdlib.h>							// for RAND_MAX
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bandit {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "bandit";
+}
+
+void Main::init() {
+	// Read the schedule and the options shared with autopin1
+	Autopin1::Main::init();
+
+	context.enableIndentation();
+
+	try {
+		if (config->configOptionExists(name + ".policy") > 0)
+			policy = config->getConfigOption(name + ".policy");
+
+		if (config->configOptionExists(name + ".exploration") > 0)
+			exploration = Tools::readDouble(config->getConfigOption(name + ".exploration"));
+
+		if (config->configOptionExists(name + ".rounds") > 0)
+			rounds = Tools::readInt(config->getConfigOption(name + ".rounds"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (policy != "ucb" && policy != "thompson") {
+		context.report(Error::BAD_CONFIG, "invalid_value", name + ".init() failed: Unknown policy \"" + policy + "\".");
+		return;
+	}
+
+	if (exploration < 0 || rounds < 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Invalid value for 'exploration' or 'rounds'.");
+		return;
+	}
+
+	context.info("  :: policy: " + policy);
+	context.info("  :: exploration: " + QString::number(exploration));
+	context.info("  :: rounds: " + QString::number(rounds));
+
+	arms.assign(pinnings.size(), arm());
+
+	// Use the results of earlier runs as prior knowledge
+	if (history != nullptr) {
+		int phase = proc->getExecutionPhase();
+
+		for (const auto &result : history->getPinnings(phase)) {
+			auto it = std::find(pinnings.begin(), pinnings.end(), result.first);
+			if (it == pinnings.end()) continue;
+
+			PinningHistory::pinning_stats stats = history->getPinningStats(phase, result.first);
+			arm &a = arms[it - pinnings.begin()];
+
+			a.samples = std::max(stats.samples, 1);
+			a.mean = result.second;
+			a.m2 = stats.variance * (a.samples - 1);
+		}
+	}
+
+	qsrand(QTime::currentTime().msec());
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result = Autopin1::Main::getConfigOpts();
+
+	result.push_back(Configuration::configopt("policy", QStringList(policy)));
+	result.push_back(Configuration::configopt("exploration", QStringList(QString::number(exploration))));
+	result.push_back(Configuration::configopt("rounds", QStringList(QString::number(rounds))));
+
+	return result;
+}
+
+bool Main::addPinningToHistory(PinningHistory::autopin_pinning pinning, double value) {
+	arm &a = arms[current_pinning];
+
+	// Welford's online algorithm for the mean and the variance
+	a.samples++;
+	double delta = value - a.mean;
+	a.mean += delta / a.samples;
+	a.m2 += delta * (value - a.mean);
+
+	a.rate_samples++;
+	a.rate += (last_rate - a.rate) / a.rate_samples;
+
+	if (history == nullptr) return false;
+
+	PinningHistory::pinning_stats stats = {a.samples, (a.samples > 1) ? a.m2 / (a.samples - 1) : 0};
+	history->addPinning(proc->getExecutionPhase(), pinning, a.mean, stats);
+
+	return true;
+}
+
+bool Main::nextPinning(double result) {
+	measurements++;
+
+	// Determine the pinning with the best mean so far
+	int best = 0;
+	for (int i = 1; i < (int)arms.size(); i++) {
+		if (arms[i].samples > 0 && (arms[best].samples == 0 || score(i) > score(best))) best = i;
+	}
+
+	// Early termination and drift detection compare with the best mean instead of the best single measurement, which
+	// may have been an outlier. The rate of pinnings which are only known from the history is not known.
+	if (arms[best].samples > 0) {
+		best_pinning = best;
+		best_performance = arms[best].mean;
+		best_rate = (arms[best].rate_samples > 0) ? arms[best].rate : 0;
+	}
+
+	if (rounds > 0 && measurements >= rounds) return false;
+
+	// Every pinning has to be measured at least once
+	for (int i = 0; i < (int)arms.size(); i++) {
+		if (arms[i].samples == 0) {
+			current_pinning = i;
+			return true;
+		}
+	}
+
+	int total = 0;
+	for (const auto &a : arms) total += a.samples;
+
+	double sd = deviation();
+	double best_value = 0;
+	int next = -1;
+
+	for (int i = 0; i < (int)arms.size(); i++) {
+		double value;
+
+		if (policy == "ucb") {
+			value = score(i) + exploration * sd * std::sqrt(2 * std::log((double)total) / arms[i].samples);
+		} else {
+			double arm_sd = (arms[i].samples > 1) ? std::sqrt(arms[i].m2 / (arms[i].samples - 1)) : sd;
+			value = score(i) + gaussian() * arm_sd / std::sqrt((double)arms[i].samples);
+		}
+
+		if (next == -1 || value > best_value) {
+			best_value = value;
+			next = i;
+		}
+	}
+
+	if (next != best)
+		context.info("> Measuring pinning " + QString::number(next + 1) + " again (best so far: " +
+					 QString::number(best + 1) + ")");
+
+	current_pinning = next;
+
+	return true;
+}
+
+void Main::restart() {
+	Autopin1::Main::restart();
+
+	// The old statistics do not describe the current behaviour of the process any more
+	measurements = 0;
+	arms.assign(pinnings.size(), arm());
+}
+
+double Main::score(int index) {
+	return (monitor_type == PerformanceMonitor::MIN) ? -arms[index].mean : arms[index].mean;
+}
+
+double Main::deviation() {
+	double m2 = 0, max_mean = 0;
+	int degrees = 0;
+
+	for (const auto &a : arms) {
+		if (a.samples == 0) continue;
+		m2 += a.m2;
+		degrees += a.samples - 1;
+		max_mean = std::max(max_mean, std::fabs(a.mean));
+	}
+
+	if (degrees > 0 && m2 > 0) return std::sqrt(m2 / degrees);
+
+	// Not enough data yet, assume that the measurements vary by 10%
+	return max_mean / 10;
+}
+
+double Main::gaussian() {
+	// Box-Muller transform
+	double u1 = (qrand() + 1.0) / (RAND_MAX + 2.0);
+	double u2 = (qrand() + 1.0) / (RAND_MAX + 2.0);
+
+	return std::sqrt(-2 * std::log(u1)) * std::cos(2 * M_PI * u2);
+}
+
+} // namespace Bandit
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -0,0 +1,170 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Bayesian/GaussianProcess.h>
+
+#include <AutopinPlus/PinningHistory.h> // for PinningHistory, etc
+#include <algorithm>					// for find, max
+#include <cmath>						// for exp, sqrt, erfc, M_PI
+#include <stddef.h>						// for size_t
+#include <utility>						// for pair
+#include <vector>						// for vector
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bayesian {
+
+GaussianProcess::GaussianProcess(double length_scale, double noise) : length_scale(length_scale), noise(noise) {}
+
+void GaussianProcess::addObservation(const PinningHistory::autopin_pinning &pinning, double value) {
+	inputs.push_back(pinning);
+	outputs.push_back(value);
+
+	fit();
+}
+
+bool GaussianProcess::contains(const PinningHistory::autopin_pinning &pinning) const {
+	return std::find(inputs.begin(), inputs.end(), pinning) != inputs.end();
+}
+
+std::pair<double, double> GaussianProcess::predict(const PinningHistory::autopin_pinning &pinning) const {
+	size_t n = inputs.size();
+
+	// Without any observations, the prediction is just the prior.
+	if (n == 0) return std::pair<double, double>(0, 1);
+
+	std::vector<double> k(n), v(n);
+	for (size_t i = 0; i < n; i++) k[i] = kernel(inputs[i], pinning);
+
+	// The posterior mean is the covariance with the observations times their weights.
+	double mu = 0;
+	for (size_t i = 0; i < n; i++) mu += k[i] * alpha[i];
+
+	// The posterior variance is reduced by the part of the covariance which is explained by the observations, which
+	// is obtained by solving L * v = k by forward substitution.
+	double var = kernel(pinning, pinning);
+	for (size_t i = 0; i < n; i++) {
+		double sum = k[i];
+		for (size_t j = 0; j < i; j++) sum -= cholesky[i * n + j] * v[j];
+		v[i] = sum / cholesky[i * n + i];
+		var -= v[i] * v[i];
+	}
+
+	return std::pair<double, double>(mean + deviation * mu, deviation * std::sqrt(std::max(var, 0.0)));
+}
+
+double GaussianProcess::expectedImprovement(const PinningHistory::autopin_pinning &pinning) const {
+	if (outputs.empty()) return 0;
+
+	double best = *std::max_element(outputs.begin(), outputs.end());
+	auto prediction = predict(pinning);
+	double improvement = prediction.first - best;
+	double sigma = prediction.second;
+
+	if (sigma <= 0) return std::max(improvement, 0.0);
+
+	double z = improvement / sigma;
+	double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+	double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+
+	return improvement * cdf + sigma * pdf;
+}
+
+PinningHistory::pinning_result GaussianProcess::getBest() const {
+	if (outputs.empty()) return PinningHistory::pinning_result();
+
+	size_t best = std::max_element(outputs.begin(), outputs.end()) - outputs.begin();
+
+	return PinningHistory::pinning_result(inputs[best], outputs[best]);
+}
+
+int GaussianProcess::size() const { return inputs.size(); }
+
+double GaussianProcess::kernel(const PinningHistory::autopin_pinning &a, const PinningHistory::autopin_pinning &b) const {
+	size_t n = std::max(a.size(), b.size());
+
+	if (n == 0) return 1;
+
+	// Sum up how differently the threads are placed, i.e. one minus the overlap of their sets of cores. Threads
+	// which only exist in one of the pinnings are considered to be placed differently.
+	double different = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (i >= a.size() || i >= b.size()) {
+			different++;
+			continue;
+		}
+
+		size_t common = 0;
+		for (int cpu : a[i]) common += b[i].count(cpu);
+
+		size_t total = a[i].size() + b[i].size() - common;
+		if (total > 0) different += 1 - (double)common / total;
+	}
+
+	return std::exp(-(different / n) / length_scale);
+}
+
+void GaussianProcess::fit() {
+	size_t n = inputs.size();
+
+	// Normalize the observations so that the prior (zero mean, unit variance) fits them.
+	mean = 0;
+	for (auto value : outputs) mean += value;
+	mean /= n;
+
+	deviation = 0;
+	for (auto value : outputs) deviation += (value - mean) * (value - mean);
+	deviation = std::sqrt(deviation / n);
+	if (deviation <= 0) deviation = 1;
+
+	// Build the covariance matrix of the observations including the noise and decompose it in place.
+	cholesky.assign(n * n, 0);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j <= i; j++) {
+			double sum = kernel(inputs[i], inputs[j]);
+			if (i == j) sum += noise + 1e-9;
+
+			for (size_t k = 0; k < j; k++) sum -= cholesky[i * n + k] * cholesky[j * n + k];
+
+			if (i == j)
+				cholesky[i * n + i] = std::sqrt(std::max(sum, 1e-12));
+			else
+				cholesky[i * n + j] = sum / cholesky[j * n + j];
+		}
+	}
+
+	// Solve L * L^T * alpha = y by forward and backward substitution.
+	std::vector<double> y(n);
+	for (size_t i = 0; i < n; i++) {
+		double sum = (outputs[i] - mean) / deviation;
+		for (size_t j = 0; j < i; j++) sum -= cholesky[i * n + j] * y[j];
+		y[i] = sum / cholesky[i * n + i];
+	}
+
+	alpha.assign(n, 0);
+	for (size_t i = n; i-- > 0;) {
+		double sum = y[i];
+		for (size_t j = i + 1; j < n; j++) sum -= cholesky[j * n + i] * alpha[j];
+		alpha[i] = sum / cholesky[i * n + i];
+	}
+}
+
+} // namespace Bayesian
+} // namespace Strategy
+} // namespace AutopinPlus
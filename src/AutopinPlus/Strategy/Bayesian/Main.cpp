@@ -0,0 +1,179 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Bayesian/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>						 // for AutopinContext
+#include <AutopinPlus/Configuration.h>						 // for Configuration, etc
+#include <AutopinPlus/Error.h>								 // for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>							 // for Exception
+#include <AutopinPlus/PerformanceMonitor.h>					 // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>						 // for PinningHistory, etc
+#include <AutopinPlus/Strategy/Bayesian/GaussianProcess.h> // for GaussianProcess
+#include <AutopinPlus/Tools.h>								 // for Tools
+#include <qstring.h>										 // for QString, operator+
+#include <qstringlist.h>									 // for QStringList
+#include <qdatetime.h>										 // for QTime
+#include <qglobal.h>										 // for qrand, qsrand
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Bayesian {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "bayesian";
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("> Initializing control strategy " + name);
+
+	// Read the options shared with autopin1
+	CHECK_ERRORV(readOptions());
+
+	// The schedule is optional for this strategy, if it exists it is used as the initial design.
+	if (config->configOptionExists(name + ".schedule") > 0)
+		CHECK_ERRORV(pinnings = readPinnings(name + ".schedule", monitor_type));
+
+	CHECK_ERRORV(space = readPinningSpace(pinnings));
+
+	try {
+		if (config->configOptionExists(name + ".budget") > 0)
+			budget = Tools::readInt(config->getConfigOption(name + ".budget"));
+
+		if (config->configOptionExists(name + ".init_samples") > 0)
+			init_samples = Tools::readInt(config->getConfigOption(name + ".init_samples"));
+
+		if (config->configOptionExists(name + ".candidates") > 0)
+			candidates = Tools::readInt(config->getConfigOption(name + ".candidates"));
+
+		if (config->configOptionExists(name + ".length_scale") > 0)
+			length_scale = Tools::readDouble(config->getConfigOption(name + ".length_scale"));
+
+		if (config->configOptionExists(name + ".noise") > 0)
+			noise = Tools::readDouble(config->getConfigOption(name + ".noise"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (budget <= 0 || init_samples < 0 || candidates <= 0 || length_scale <= 0 || noise < 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Invalid value for 'budget', 'init_samples', 'candidates', "
+							  "'length_scale' or 'noise'.");
+		return;
+	}
+
+	context.info("  :: cpus: " + Tools::showInts(space.getCpus()).join(" "));
+	context.info("  :: threads: " + QString::number(space.getThreads()));
+	context.info("  :: budget: " + QString::number(budget));
+	context.info("  :: init_samples: " + QString::number(init_samples));
+	context.info("  :: candidates: " + QString::number(candidates));
+	context.info("  :: length_scale: " + QString::number(length_scale));
+	context.info("  :: noise: " + QString::number(noise));
+
+	model = GaussianProcess(length_scale, noise);
+
+	// Fill up the initial design with random pinnings
+	qsrand(QTime::currentTime().msec());
+	while (pinnings.size() < (size_t)init_samples || pinnings.empty()) pinnings.push_back(space.randomPinning());
+	design = pinnings.size();
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result = Autopin1::Main::getConfigOpts();
+
+	result.push_back(Configuration::configopt("cpus", Tools::showInts(space.getCpus())));
+	result.push_back(Configuration::configopt("threads", QStringList(QString::number(space.getThreads()))));
+	result.push_back(Configuration::configopt("budget", QStringList(QString::number(budget))));
+	result.push_back(Configuration::configopt("init_samples", QStringList(QString::number(init_samples))));
+	result.push_back(Configuration::configopt("candidates", QStringList(QString::number(candidates))));
+	result.push_back(Configuration::configopt("length_scale", QStringList(QString::number(length_scale))));
+	result.push_back(Configuration::configopt("noise", QStringList(QString::number(noise))));
+
+	return result;
+}
+
+bool Main::nextPinning(double result) {
+	// The model always maximizes, so flip the sign of monitors where smaller values are better.
+	double score = (monitor_type == PerformanceMonitor::MIN) ? -result : result;
+	model.addObservation(pinnings[current_pinning], score);
+
+	if (model.size() >= budget) {
+		context.info("> Measurement budget of " + QString::number(budget) + " pinnings has been used up");
+		return false;
+	}
+
+	// Work through the initial design first
+	current_pinning++;
+	if ((uint)current_pinning < pinnings.size()) return true;
+
+	PinningHistory::autopin_pinning suggestion;
+	if (!suggestPinning(suggestion)) {
+		context.info("> No untested pinnings left");
+		return false;
+	}
+
+	auto prediction = model.predict(suggestion);
+	context.info("> Next pinning has an expected improvement of " +
+				 QString::number(model.expectedImprovement(suggestion)) + " (predicted value: " +
+				 QString::number(prediction.first) + " +/- " + QString::number(prediction.second) + ")");
+
+	pinnings.push_back(suggestion);
+
+	return true;
+}
+
+void Main::restart() {
+	Autopin1::Main::restart();
+
+	// The old results do not describe the current behaviour of the process any more
+	model = GaussianProcess(length_scale, noise);
+	pinnings.resize(design);
+}
+
+bool Main::suggestPinning(PinningHistory::autopin_pinning &result) {
+	PinningHistory::autopin_pinning best = model.getBest().first;
+	double best_improvement = -1;
+
+	// Half of the candidates are drawn from the whole search space, the other half is taken from the neighbourhood of
+	// the best pinning found so far.
+	for (int i = 0; i < candidates; i++) {
+		PinningHistory::autopin_pinning candidate = (i % 2 == 0 || best.empty()) ? space.randomPinning() : space.neighbour(best);
+
+		if (model.contains(candidate)) continue;
+
+		double improvement = model.expectedImprovement(candidate);
+		if (improvement > best_improvement) {
+			best_improvement = improvement;
+			result = candidate;
+		}
+	}
+
+	return best_improvement >= 0;
+}
+
+} // namespace Bayesian
+} // namespace Strategy
+} // namespace AutopinPlus
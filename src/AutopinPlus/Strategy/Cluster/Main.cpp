@@ -0,0 +1,294 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Cluster/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		   // for AutopinContext
+#include <AutopinPlus/Configuration.h>		   // for Configuration, etc
+#include <AutopinPlus/Error.h>				   // for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>			   // for Exception
+#include <AutopinPlus/Monitor/MemShare/Main.h> // for Main, Main::affinity_graph
+#include <AutopinPlus/OSServices.h>			   // for OSServices, etc
+#include <AutopinPlus/Tools.h>				   // for Tools
+#include <algorithm>						   // for sort, stable_sort, min
+#include <map>								   // for map
+#include <qstring.h>						   // for QString, operator+
+#include <qstringlist.h>					   // for QStringList
+#include <qtimer.h>							   // for QTimer
+#include <tuple>							   // for tie
+#include <utility>							   // for pair, make_pair
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Cluster {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: ControlStrategy(config, proc, service, monitors, history, context) {
+	name = "cluster";
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("> Initializing control strategy " + name);
+
+	// Select the memshare monitor, either by name or the first one
+	for (auto candidate : monitors) {
+		if (candidate->getType() != "memshare") continue;
+
+		if (config->configOptionExists(name + ".monitor") > 0 &&
+			candidate->getName() != config->getConfigOption(name + ".monitor"))
+			continue;
+
+		monitor = static_cast<Monitor::MemShare::Main *>(candidate);
+		break;
+	}
+
+	if (monitor == nullptr) {
+		context.report(Error::BAD_CONFIG, "option_missing",
+					   name + ".init() failed: This strategy requires a performance monitor of type memshare.");
+		return;
+	}
+
+	context.info("  :: Using performance monitor \"" + monitor->getName() + "\"");
+
+	try {
+		if (config->configOptionExists(name + ".init_time") > 0)
+			init_time = Tools::readInt(config->getConfigOption(name + ".init_time"));
+
+		if (config->configOptionExists(name + ".profile_time") > 0)
+			profile_time = Tools::readInt(config->getConfigOption(name + ".profile_time"));
+
+		if (config->configOptionExists(name + ".cpus") > 0)
+			cpus = Tools::readInts(config->getConfigOptionList(name + ".cpus"));
+
+		if (config->configOptionExists(name + ".smt") > 0) smt = config->getConfigOptionBool(name + ".smt");
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (init_time < 0 || profile_time <= 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Invalid value for 'init_time' or 'profile_time'.");
+		return;
+	}
+
+	if (cpus.isEmpty()) {
+		OSServices::autopin_topology topology;
+		CHECK_ERRORV(topology = service->getTopology());
+		for (const auto &cpu : topology) cpus.append(cpu.cpu);
+	}
+
+	context.info("  :: init_time: " + QString::number(init_time));
+	context.info("  :: profile_time: " + QString::number(profile_time));
+	context.info("  :: cpus: " + Tools::showInts(cpus).join(" "));
+	context.info(QString("  :: smt: ") + (smt ? "true" : "false"));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result;
+
+	result.push_back(Configuration::configopt("monitor", QStringList(monitor != nullptr ? monitor->getName() : "")));
+	result.push_back(Configuration::configopt("init_time", QStringList(QString::number(init_time))));
+	result.push_back(Configuration::configopt("profile_time", QStringList(QString::number(profile_time))));
+	result.push_back(Configuration::configopt("cpus", Tools::showInts(cpus)));
+	result.push_back(Configuration::configopt("smt", QStringList(smt ? "true" : "false")));
+
+	return result;
+}
+
+void Main::slot_autopinReady() {
+	context.enableIndentation();
+	context.info("> Waiting " + QString::number(init_time) + " seconds (init time)");
+	context.disableIndentation();
+
+	QTimer::singleShot(init_time * 1000, this, SLOT(slot_startProfiling()));
+}
+
+void Main::slot_startProfiling() {
+	CHECK_ERRORV(refreshTasks());
+
+	context.enableIndentation();
+	context.info("");
+	context.info("> Sampling the memory accesses of " + QString::number(tasks.size()) + " tasks for " +
+				 QString::number(profile_time) + " seconds");
+	context.disableIndentation();
+
+	for (auto task : tasks) CHECK_ERRORV(monitor->start(task));
+
+	QTimer::singleShot(profile_time * 1000, this, SLOT(slot_stopProfiling()));
+}
+
+void Main::slot_stopProfiling() {
+	context.enableIndentation();
+
+	Monitor::MemShare::Main::affinity_graph graph;
+	CHECK_ERRORV(graph = monitor->getAffinityGraph());
+
+	for (auto task : monitor->getMonitoredTasks()) CHECK_ERRORV(monitor->stop(task));
+
+	for (const auto &edge : graph) {
+		context.debug("  :: Affinity between task " + QString::number(edge.first.first) + " and task " +
+					  QString::number(edge.first.second) + ": " + QString::number(edge.second));
+	}
+
+	// Tasks which have been created during the profiling are treated as not communicating at all
+	CHECK_ERRORV(refreshTasks());
+
+	PinningHistory::autopin_pinning pinning;
+	CHECK_ERRORV(pinning = computePinning(graph));
+
+	context.info("> Applying pinning for " + QString::number(pinning.size()) + " tasks");
+
+	for (uint i = 0; i < pinning.size(); i++) {
+		context.info("  :: Pinning task " + QString::number(tasks[i]) + " to core " +
+					 PinningHistory::showCpuSet(pinning[i]));
+		CHECK_ERRORV(service->setAffinity(tasks[i], pinning[i]));
+	}
+
+	context.biginfo("> Control strategy " + name + " has finished");
+	context.disableIndentation();
+}
+
+PinningHistory::autopin_pinning Main::computePinning(const Monitor::MemShare::Main::affinity_graph &graph) {
+	PinningHistory::autopin_pinning result;
+	OSServices::autopin_topology topology;
+
+	CHECK_ERROR(topology = service->getTopology(), result);
+
+	// Keep only the allowed processors, sorted such that neighbouring processors share as many resources as possible
+	OSServices::autopin_topology allowed;
+	for (const auto &cpu : topology) {
+		if (cpus.contains(cpu.cpu)) allowed.push_back(cpu);
+	}
+
+	std::sort(allowed.begin(), allowed.end(), [](const OSServices::autopin_cpu &a, const OSServices::autopin_cpu &b) {
+		return std::tie(a.socket, a.node, a.llc, a.core, a.cpu) < std::tie(b.socket, b.node, b.llc, b.core, b.cpu);
+	});
+
+	if (allowed.empty()) REPORT(Error::BAD_CONFIG, "inconsistent", name + ": None of the processors is available", result);
+
+	// Build the hierarchy of caches, cores and processors
+	std::vector<std::vector<std::vector<int>>> caches;
+	for (uint i = 0; i < allowed.size(); i++) {
+		bool new_cache = i == 0 || allowed[i].llc != allowed[i - 1].llc || allowed[i].socket != allowed[i - 1].socket;
+		bool new_core = new_cache || allowed[i].core != allowed[i - 1].core;
+
+		if (new_cache) caches.emplace_back();
+		if (new_core) caches.back().emplace_back();
+		caches.back().back().push_back(allowed[i].cpu);
+	}
+
+	int count = std::min((int)tasks.size(), (int)allowed.size());
+	if (count < (int)tasks.size())
+		context.info("  :: Only the first " + QString::number(count) + " tasks will be pinned");
+
+	auto weight = [&](int a, int b) {
+		int ta = std::min(tasks[a], tasks[b]), tb = std::max(tasks[a], tasks[b]);
+		auto it = graph.find(std::make_pair(ta, tb));
+		return it != graph.end() ? it->second : 0.0;
+	};
+
+	// Partition the tasks onto the caches
+	std::vector<int> items, capacities;
+	for (int i = 0; i < count; i++) items.push_back(i);
+	for (const auto &cache : caches) {
+		int size = 0;
+		for (const auto &core : cache) size += core.size();
+		capacities.push_back(size);
+	}
+
+	std::vector<int> cache_of = partition(items, capacities, weight);
+	result.resize(count);
+
+	// Partition the tasks of every cache onto its cores
+	for (uint c = 0; c < caches.size(); c++) {
+		std::vector<int> cache_items;
+		for (int i = 0; i < count; i++) {
+			if (cache_of[i] == (int)c) cache_items.push_back(i);
+		}
+
+		// Only use one processor per core if there are enough cores
+		bool share_cores = smt || cache_items.size() > caches[c].size();
+
+		std::vector<int> core_capacities;
+		for (const auto &core : caches[c]) core_capacities.push_back(share_cores ? core.size() : 1);
+
+		std::vector<int> core_of = partition(cache_items, core_capacities, weight);
+
+		std::vector<int> used(caches[c].size(), 0);
+		for (uint i = 0; i < cache_items.size(); i++) {
+			int core = core_of[i];
+			result[cache_items[i]] = {caches[c][core][used[core]++]};
+		}
+	}
+
+	return result;
+}
+
+std::vector<int> Main::partition(const std::vector<int> &items, std::vector<int> capacities,
+								 const std::function<double(int, int)> &weight) {
+	std::vector<int> result(items.size(), -1);
+
+	// Place the items with the most communication first
+	std::vector<double> total(items.size(), 0);
+	for (uint i = 0; i < items.size(); i++) {
+		for (uint j = 0; j < items.size(); j++) {
+			if (i != j) total[i] += weight(items[i], items[j]);
+		}
+	}
+
+	std::vector<int> order;
+	for (uint i = 0; i < items.size(); i++) order.push_back(i);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return total[a] > total[b]; });
+
+	std::vector<std::vector<int>> members(capacities.size());
+
+	for (auto i : order) {
+		int best = -1;
+		double best_weight = 0;
+
+		for (uint g = 0; g < capacities.size(); g++) {
+			if (capacities[g] == 0) continue;
+
+			double group_weight = 0;
+			for (auto j : members[g]) group_weight += weight(items[i], items[j]);
+
+			if (best == -1 || group_weight > best_weight ||
+				(group_weight == best_weight && capacities[g] > capacities[best])) {
+				best = g;
+				best_weight = group_weight;
+			}
+		}
+
+		result[i] = best;
+		members[best].push_back(i);
+		capacities[best]--;
+	}
+
+	return result;
+}
+
+} // namespace Cluster
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -0,0 +1,305 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Genetic/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <algorithm>						// for any_of, find, max, min, etc
+#include <cstdlib>							// for RAND_MAX
+#include <qdatetime.h>						// for QTime
+#include <qglobal.h>						// for qrand, qsrand
+#include <qstring.h>						// for QString, operator+
+#include <qstringlist.h>					// for QStringList
+#include <set>								// for set
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Genetic {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "genetic";
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("> Initializing control strategy " + name);
+
+	// Read the options shared with autopin1
+	CHECK_ERRORV(readOptions());
+
+	// The schedule is optional for this strategy, its pinnings are used for the first population.
+	if (config->configOptionExists(name + ".schedule") > 0)
+		CHECK_ERRORV(pinnings = readPinnings(name + ".schedule", monitor_type));
+
+	CHECK_ERRORV(space = readPinningSpace(pinnings));
+
+	try {
+		if (config->configOptionExists(name + ".population") > 0)
+			population_size = Tools::readInt(config->getConfigOption(name + ".population"));
+
+		offspring = population_size / 2;
+		if (config->configOptionExists(name + ".offspring") > 0)
+			offspring = Tools::readInt(config->getConfigOption(name + ".offspring"));
+
+		if (config->configOptionExists(name + ".mutation") > 0)
+			mutation = Tools::readDouble(config->getConfigOption(name + ".mutation"));
+
+		if (config->configOptionExists(name + ".generations") > 0)
+			generations = Tools::readInt(config->getConfigOption(name + ".generations"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (population_size < 2 || offspring < 1 || mutation < 0 || mutation > 1 || generations < 0) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: Invalid value for 'population', "
+																 "'offspring', 'mutation' or 'generations'.");
+		return;
+	}
+
+	context.info("  :: cpus: " + Tools::showInts(space.getCpus()).join(" "));
+	context.info("  :: threads: " + QString::number(space.getThreads()));
+	context.info("  :: population: " + QString::number(population_size));
+	context.info("  :: offspring: " + QString::number(offspring));
+	context.info("  :: mutation: " + QString::number(mutation));
+	context.info("  :: generations: " + QString::number(generations));
+
+	OSServices::autopin_topology topology;
+	CHECK_ERRORV(topology = service->getTopology());
+	for (const auto &cpu : topology) sockets[cpu.cpu] = cpu.socket;
+
+	qsrand(QTime::currentTime().msec());
+
+	// Continue with the population stored in the history
+	int phase = proc->getExecutionPhase();
+
+	if (history != nullptr) {
+		for (const auto &elem : history->getPinnings(phase)) {
+			if ((int)elem.first.size() != space.getThreads()) continue;
+
+			scores[elem.first] = toScore(elem.second);
+
+			PinningHistory::pinning_metrics metrics = history->getPinningMetrics(phase, elem.first);
+			if (metrics["population"] > 0) {
+				population.push_back(elem.first);
+				generation = std::max(generation, (int)metrics["generation"]);
+			}
+		}
+	}
+
+	if (!population.empty()) {
+		context.info("  :: Continuing with generation " + QString::number(generation) + " from the history (" +
+					 QString::number(population.size()) + " pinnings)");
+	}
+
+	// Fill up the population with the pinnings of the schedule and random pinnings. Pinnings which have not been
+	// measured yet are measured first.
+	PinningHistory::pinning_list candidates;
+	for (const auto &pinning : pinnings) {
+		if ((int)pinning.size() == space.getThreads()) candidates.push_back(pinning);
+	}
+
+	pinnings.clear();
+
+	for (int attempts = 0; attempts < 100 * population_size; attempts++) {
+		if ((int)(population.size() + pinnings.size()) >= population_size) break;
+
+		PinningHistory::autopin_pinning pinning;
+
+		if (!candidates.empty()) {
+			pinning = candidates.front();
+			candidates.pop_front();
+		} else {
+			pinning = space.randomPinning();
+		}
+
+		if (std::find(population.begin(), population.end(), pinning) != population.end() ||
+			std::find(pinnings.begin(), pinnings.end(), pinning) != pinnings.end())
+			continue;
+
+		if (scores.count(pinning) > 0)
+			population.push_back(pinning);
+		else
+			pinnings.push_back(pinning);
+	}
+
+	if (pinnings.empty()) breed();
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result = Autopin1::Main::getConfigOpts();
+
+	result.push_back(Configuration::configopt("cpus", Tools::showInts(space.getCpus())));
+	result.push_back(Configuration::configopt("threads", QStringList(QString::number(space.getThreads()))));
+	result.push_back(Configuration::configopt("population", QStringList(QString::number(population_size))));
+	result.push_back(Configuration::configopt("offspring", QStringList(QString::number(offspring))));
+	result.push_back(Configuration::configopt("mutation", QStringList(QString::number(mutation))));
+	result.push_back(Configuration::configopt("generations", QStringList(QString::number(generations))));
+
+	return result;
+}
+
+bool Main::nextPinning(double result) {
+	scores[pinnings[current_pinning]] = toScore(result);
+
+	current_pinning++;
+	if (current_pinning < (int)pinnings.size()) return true;
+
+	survive();
+	generation++;
+	completed++;
+
+	context.info("> Generation " + QString::number(generation) + " is complete");
+
+	current_pinning = 0;
+
+	if (generations > 0 && completed >= generations) {
+		pinnings.clear();
+		pinnings.push_back(population.front());
+		best_pinning = 0;
+		return false;
+	}
+
+	breed();
+
+	return true;
+}
+
+void Main::restart() {
+	Autopin1::Main::restart();
+	completed = 0;
+}
+
+void Main::breed() {
+	pinnings.clear();
+
+	if (population.empty()) {
+		pinnings.push_back(space.randomPinning());
+		return;
+	}
+
+	for (int attempts = 0; (int)pinnings.size() < offspring && attempts < 100 * offspring; attempts++) {
+		PinningHistory::autopin_pinning child = crossover(select(), select());
+
+		if ((double)qrand() / RAND_MAX < mutation) child = space.neighbour(child);
+
+		if (scores.count(child) > 0 || std::find(pinnings.begin(), pinnings.end(), child) != pinnings.end()) continue;
+
+		pinnings.push_back(child);
+	}
+
+	if (pinnings.empty()) {
+		context.info("> No new pinnings found, measuring the best pinning again");
+		pinnings.push_back(population.front());
+	}
+}
+
+const PinningHistory::autopin_pinning &Main::select() const {
+	const PinningHistory::autopin_pinning &a = population[qrand() % population.size()];
+	const PinningHistory::autopin_pinning &b = population[qrand() % population.size()];
+
+	return (scores.at(a) >= scores.at(b)) ? a : b;
+}
+
+PinningHistory::autopin_pinning Main::crossover(const PinningHistory::autopin_pinning &a,
+												const PinningHistory::autopin_pinning &b) const {
+	PinningHistory::autopin_pinning result;
+
+	// Without the topology, the first threads are inherited from the first parent and the rest from the second one
+	unsigned int cut = qrand() % (a.size() + 1);
+	std::map<int, bool> from_a;
+
+	for (unsigned int i = 0; i < a.size() && i < b.size(); i++) {
+		bool take_a = i < cut;
+
+		auto socket = sockets.find(*a[i].begin());
+		if (socket != sockets.end()) {
+			if (from_a.count(socket->second) == 0) from_a[socket->second] = (qrand() % 2 == 0);
+			take_a = from_a[socket->second];
+		}
+
+		result.push_back(take_a ? a[i] : b[i]);
+	}
+
+	// Move threads which share a processor with a previous thread to unused processors
+	std::set<int> used;
+	std::vector<unsigned int> conflicts;
+	for (unsigned int i = 0; i < result.size(); i++) {
+		if (std::any_of(result[i].begin(), result[i].end(), [&used](int cpu) { return used.count(cpu) > 0; }))
+			conflicts.push_back(i);
+		else
+			used.insert(result[i].begin(), result[i].end());
+	}
+
+	QList<int> unused;
+	for (auto cpu : space.getCpus()) {
+		if (used.count(cpu) == 0) unused.append(cpu);
+	}
+
+	for (auto i : conflicts) {
+		if (unused.isEmpty()) break;
+		result[i] = {unused.takeAt(qrand() % unused.size())};
+	}
+
+	return result;
+}
+
+void Main::survive() {
+	std::vector<PinningHistory::autopin_pinning> candidates = population;
+	for (const auto &pinning : pinnings) {
+		if (std::find(candidates.begin(), candidates.end(), pinning) == candidates.end()) candidates.push_back(pinning);
+	}
+
+	std::stable_sort(candidates.begin(), candidates.end(),
+					 [this](const PinningHistory::autopin_pinning &x, const PinningHistory::autopin_pinning &y) {
+						 return scores.at(x) > scores.at(y);
+					 });
+
+	population.assign(candidates.begin(),
+					  candidates.begin() + std::min(candidates.size(), (std::size_t)population_size));
+
+	if (history == nullptr) return;
+
+	// Mark the population in the history, so that the next run can continue with it
+	int phase = proc->getExecutionPhase();
+	for (unsigned int i = 0; i < candidates.size(); i++) {
+		PinningHistory::pinning_metrics metrics;
+		metrics["population"] = (i < population.size()) ? 1 : 0;
+		metrics["generation"] = generation + 1;
+		history->setPinningMetrics(phase, candidates[i], metrics);
+	}
+}
+
+double Main::toScore(double result) const { return (monitor_type == PerformanceMonitor::MIN) ? -result : result; }
+
+} // namespace Genetic
+} // namespace Strategy
+} // namespace AutopinPlus
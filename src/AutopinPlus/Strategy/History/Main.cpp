@@ -82,6 +82,16 @@ void Main::init() {
 		skip.insert(entry_int);
 	}
 
+	// The second thread of an OpenMP program compiled with icc is a helper thread
+	if (openmp_icc) skip.insert(1);
+
+	auto option = [&](const QString &opt) {
+		auto it = history->getStrategyOption(opt);
+		if (it != history->getStrategyOptions().end()) return it->second;
+		return QStringList();
+	};
+	CHECK_ERRORV(readRoles(option));
+
 	if (init_time < 0) REPORTV(Error::BAD_CONFIG, "invalid_value", "Invalid init time: " + QString::number(init_time));
 
 	context.info("  :: Init time: " + QString::number(init_time));
@@ -108,6 +118,8 @@ Configuration::configopts Main::getConfigOpts() {
 
 	result.push_back(Configuration::configopt("skip", skip_str));
 
+	for (const auto &opt : getRoleOpts()) result.push_back(opt);
+
 	result.push_back(
 		Configuration::configopt("notification_interval", QStringList(QString::number(notification_interval))));
 
@@ -134,7 +146,8 @@ void Main::slot_startPinning() {
 	context.info("");
 	context.info("> Apply pinning.");
 
-	applyPinning(history->getBestPinning(0).first);
+	PinningHistory::autopin_pinning pinning = history->getBestPinning(0).first;
+	applyPinning(pinning, history->getPinningTasks(0, pinning));
 }
 
 void Main::slot_TaskCreated(int tid) {
@@ -148,13 +161,10 @@ void Main::slot_TaskCreated(int tid) {
 		unsigned int i = pinned_tasks.size();
 		PinningHistory::autopin_pinning pinning = pinnings[current_pinning];
 		if (i < pinning.size()) {
-			int j = tasks.size();
-			if (skip.find(j) != skip.end()) {
-				context.info("  :: Not pinning task " + QString::number(tid) + " (skipped)");
-			} else if (j == 1 && openmp_icc) {
-				context.info("  :: Not pinning task " + QString::number(tid) + " (icc thread)");
-			} else {
-				context.info("  :: Pinning task " + QString::number(tid) + " to core " + QString::number(pinning[i]));
+			QString role;
+			if (selectTask(tid, tasks.size(), skip, role)) {
+				context.info("  :: Pinning task " + QString::number(tid) + " to core " +
+							 PinningHistory::showCpuSet(pinning[i]));
 				CHECK_ERRORV(service->setAffinity(tid, pinning[i]));
 
 				pinned_task new_entry;
@@ -197,25 +207,38 @@ void Main::slot_PhaseChanged(int newphase) {
 	}
 }
 
-void Main::applyPinning(PinningHistory::autopin_pinning pinning) {
-	// i counts the pinnings
-	// j counts the tasks
-	unsigned int i = 0, j = 0;
-	while (i < pinning.size() && j < tasks.size()) {
-		if (skip.find(j) != skip.end()) {
-			context.info("  :: Not pinning task " + QString::number(tasks[j]) + " (skipped)");
-		} else if (j == 1 && openmp_icc) {
-			context.info("  :: Not pinning task " + QString::number(tasks[j]) + " (icc thread)");
-		} else {
-			pinned_task new_entry;
-			new_entry.tid = tasks[j];
-			context.info("  :: Pinning task " + QString::number(tasks[j]) + " to core " + QString::number(pinning[i]));
-			CHECK_ERRORV(service->setAffinity(tasks[j], pinning[i]));
-			pinned_tasks.push_back(new_entry);
-			i++;
-		}
+void Main::applyPinning(PinningHistory::autopin_pinning pinning, const QStringList &ids) {
+	autopin_tasklist selected;
+	QStringList roles;
+	CHECK_ERRORV(selected = selectTasks(skip, roles));
+
+	// Entries are applied to the same tasks as when the pinning was stored. The
+	// remaining entries are assigned to the remaining tasks in order.
+	std::deque<int> assigned(pinning.size(), -1);
+	autopin_tasklist remaining;
+	for (const auto &tid : selected) {
+		int i = ids.indexOf(getTaskId(tid));
+		if (i >= 0 && i < (int)pinning.size() && assigned[i] < 0)
+			assigned[i] = tid;
+		else
+			remaining.push_back(tid);
+	}
+
+	for (unsigned int i = 0; i < pinning.size() && !remaining.empty(); i++) {
+		if (assigned[i] >= 0) continue;
+		assigned[i] = remaining.front();
+		remaining.pop_front();
+	}
+
+	for (unsigned int i = 0; i < pinning.size(); i++) {
+		if (assigned[i] < 0) continue;
 
-		j++;
+		pinned_task new_entry;
+		new_entry.tid = assigned[i];
+		context.info("  :: Pinning task " + QString::number(assigned[i]) + " (" + getTaskId(assigned[i]) +
+					 ") to core " + PinningHistory::showCpuSet(pinning[i]));
+		CHECK_ERRORV(service->setAffinity(assigned[i], pinning[i]));
+		pinned_tasks.push_back(new_entry);
 	}
 }
 
@@ -0,0 +1,178 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/LocalSearch/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <cmath>							// for fabs
+#include <qdatetime.h>						// for QTime
+#include <qglobal.h>						// for qsrand
+#include <qstring.h>						// for QString, operator+
+#include <qstringlist.h>					// for QStringList
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace LocalSearch {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "localsearch";
+}
+
+void Main::init() {
+	context.enableIndentation();
+
+	context.info("> Initializing control strategy " + name);
+
+	// Read the options shared with autopin1
+	CHECK_ERRORV(readOptions());
+
+	// The schedule is optional for this strategy, its first pinning is used as the starting point.
+	if (config->configOptionExists(name + ".schedule") > 0)
+		CHECK_ERRORV(pinnings = readPinnings(name + ".schedule", monitor_type));
+
+	CHECK_ERRORV(space = readPinningSpace(pinnings));
+
+	try {
+		if (config->configOptionExists(name + ".threshold") > 0)
+			threshold = Tools::readDouble(config->getConfigOption(name + ".threshold"));
+
+		if (config->configOptionExists(name + ".remeasure") > 0)
+			remeasure = Tools::readInt(config->getConfigOption(name + ".remeasure"));
+
+		if (config->configOptionExists(name + ".iterations") > 0)
+			iterations = Tools::readInt(config->getConfigOption(name + ".iterations"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (threshold < 0 || remeasure < 0 || iterations < 0) {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Invalid value for 'threshold', 'remeasure' or 'iterations'.");
+		return;
+	}
+
+	context.info("  :: cpus: " + Tools::showInts(space.getCpus()).join(" "));
+	context.info("  :: threads: " + QString::number(space.getThreads()));
+	context.info("  :: threshold: " + QString::number(threshold));
+	context.info("  :: remeasure: " + QString::number(remeasure));
+	context.info("  :: iterations: " + QString::number(iterations));
+
+	qsrand(QTime::currentTime().msec());
+
+	// Select the starting point of the search
+	PinningHistory::autopin_pinning start;
+	int phase = proc->getExecutionPhase();
+
+	if (history != nullptr && !history->getPinnings(phase).empty()) {
+		// The pinnings are ranked by the objective of this strategy, the history may have been recorded for another one
+		double best_score = 0;
+		for (const auto &elem : history->getPinnings(phase)) {
+			double score = (monitor_type == PerformanceMonitor::MIN) ? -elem.second : elem.second;
+			if (start.empty() || score > best_score) {
+				start = elem.first;
+				best_score = score;
+			}
+		}
+		context.info("  :: Starting with the best pinning from the history");
+	} else if (!pinnings.empty()) {
+		start = pinnings.front();
+		context.info("  :: Starting with the first pinning of the schedule");
+	} else {
+		start = space.randomPinning();
+		context.info("  :: Starting with a random pinning");
+	}
+
+	pinnings.clear();
+	pinnings.push_back(start);
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result = Autopin1::Main::getConfigOpts();
+
+	result.push_back(Configuration::configopt("cpus", Tools::showInts(space.getCpus())));
+	result.push_back(Configuration::configopt("threads", QStringList(QString::number(space.getThreads()))));
+	result.push_back(Configuration::configopt("threshold", QStringList(QString::number(threshold))));
+	result.push_back(Configuration::configopt("remeasure", QStringList(QString::number(remeasure))));
+	result.push_back(Configuration::configopt("iterations", QStringList(QString::number(iterations))));
+
+	return result;
+}
+
+bool Main::nextPinning(double result) {
+	// Internally, bigger is always better
+	double score = (monitor_type == PerformanceMonitor::MIN) ? -result : result;
+	const PinningHistory::autopin_pinning &measured = pinnings[current_pinning];
+
+	if (measurements == 0 || measured == incumbent) {
+		// Always use the latest result of the current pinning, the performance of the process may have changed.
+		incumbent = measured;
+		incumbent_score = score;
+	} else if (score > incumbent_score + threshold * std::fabs(incumbent_score)) {
+		context.info("> Accepting move, the new pinning is better than the current one");
+		incumbent = measured;
+		incumbent_score = score;
+	} else {
+		context.info("> Rejecting move, keeping the current pinning");
+	}
+
+	measurements++;
+
+	// Only the pinning which will be tested next is kept, so the memory usage doesn't grow over time.
+	pinnings.clear();
+	current_pinning = 0;
+
+	if (iterations > 0 && measurements >= iterations) {
+		pinnings.push_back(incumbent);
+		best_pinning = 0;
+		return false;
+	}
+
+	if (remeasure > 0 && moves >= remeasure) {
+		context.info("> Measuring the current pinning again");
+		pinnings.push_back(incumbent);
+		moves = 0;
+	} else {
+		pinnings.push_back(space.neighbour(incumbent));
+		moves++;
+	}
+
+	return true;
+}
+
+void Main::restart() {
+	Autopin1::Main::restart();
+	measurements = 0;
+	moves = 0;
+}
+
+} // namespace LocalSearch
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -127,8 +127,10 @@ void Main::updateMonitors() {
 
 	// Iterate over all tasks which have been removed...
 	for (auto task : old_tasks - new_tasks) {
-		// ... and remove them from all monitors.
+		// ... and remove them from all monitors. The counters of process-wide monitors also hold the values of the
+		// tasks created by the dead task, so they are kept.
 		for (auto monitor : monitors) {
+			if (monitor->isProcessWide()) continue;
 			context.debug(name + ".updateMonitors(): Stopping monitor for dead task " + QString::number(task) + ".");
 			monitor->clear(task);
 		}
@@ -136,12 +138,16 @@ void Main::updateMonitors() {
 
 	// Iterator over all tasks which have been added...
 	for (auto task : new_tasks - old_tasks) {
-		// ... and add them to all monitors.
+		// ... and add them to all monitors. Process-wide monitors only need to be started for the initial tasks, as all
+		// later tasks are created by one of them.
 		for (auto monitor : monitors) {
+			if (started && monitor->isProcessWide()) continue;
 			context.debug(name + ".updateMonitors(): Starting monitor for new task " + QString::number(task) + ".");
 			monitor->start(task);
 		}
 	}
+
+	started = true;
 }
 
 } // namespace Noop
@@ -0,0 +1,250 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Pareto/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Configuration.h>		// for Configuration, etc
+#include <AutopinPlus/Error.h>				// for Error, Error::::BAD_CONFIG, etc
+#include <AutopinPlus/Exception.h>			// for Exception
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <AutopinPlus/Tools.h>				// for Tools
+#include <limits>							// for numeric_limits
+#include <qstringlist.h>					// for QStringList
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Pareto {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "pareto";
+}
+
+void Main::init() {
+	// Read the schedule and the options shared with autopin1
+	Autopin1::Main::init();
+
+	context.enableIndentation();
+
+	try {
+		if (config->configOptionExists(name + ".objective") > 0)
+			objective = config->getConfigOption(name + ".objective");
+
+		if (config->configOptionExists(name + ".weight") > 0)
+			weight = Tools::readDouble(config->getConfigOption(name + ".weight"));
+	} catch (Exception e) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: " + QString(e.what()));
+		return;
+	}
+
+	if (objective != "edp" && objective != "ed2p" && objective != "weighted") {
+		context.report(Error::BAD_CONFIG, "option_format",
+					   name + ".init() failed: Unknown objective \"" + objective + "\".");
+		return;
+	}
+
+	if (weight < 0 || weight > 1) {
+		context.report(Error::BAD_CONFIG, "option_format", name + ".init() failed: Invalid value for 'weight'.");
+		return;
+	}
+
+	// Select the monitors, by default the one chosen by autopin1 and the first other one
+	if (config->configOptionExists(name + ".performance") > 0)
+		monitor = findMonitor(config->getConfigOption(name + ".performance"));
+
+	if (config->configOptionExists(name + ".energy") > 0) {
+		energy_monitor = findMonitor(config->getConfigOption(name + ".energy"));
+	} else {
+		for (auto candidate : monitors) {
+			if (candidate != monitor) {
+				energy_monitor = candidate;
+				break;
+			}
+		}
+	}
+
+	if (monitor == nullptr || energy_monitor == nullptr || monitor == energy_monitor) {
+		context.report(Error::BAD_CONFIG, "option_missing",
+					   name + ".init() failed: This strategy requires a performance and an energy monitor.");
+		return;
+	}
+
+	performance_type = monitor->getValType();
+	if (performance_type == PerformanceMonitor::UNKNOWN) {
+		context.report(Error::BAD_CONFIG, "inconsistent", name + ".init() failed: The type of the performance monitor \"" +
+															  monitor->getName() + "\" is unknown.");
+		return;
+	}
+
+	// The samples of the performance monitor alone cannot tell if a pinning is worse
+	if (sample_interval > 0) {
+		context.info("  :: Early termination is not supported by this strategy and has been disabled");
+		sample_interval = 0;
+	}
+
+	context.info("  :: performance: " + monitor->getName());
+	context.info("  :: energy: " + energy_monitor->getName());
+	context.info("  :: objective: " + objective);
+	if (objective == "weighted") context.info("  :: weight: " + QString::number(weight));
+
+	context.disableIndentation();
+}
+
+Configuration::configopts Main::getConfigOpts() {
+	Configuration::configopts result = Autopin1::Main::getConfigOpts();
+
+	result.push_back(Configuration::configopt("performance", QStringList(monitor != nullptr ? monitor->getName() : "")));
+	result.push_back(
+		Configuration::configopt("energy", QStringList(energy_monitor != nullptr ? energy_monitor->getName() : "")));
+	result.push_back(Configuration::configopt("objective", QStringList(objective)));
+	result.push_back(Configuration::configopt("weight", QStringList(QString::number(weight))));
+
+	return result;
+}
+
+void Main::slot_PhaseChanged(int newphase) {
+	// The current pinning is measured again from the beginning
+	if (notifications) clearEnergyMonitor();
+
+	Autopin1::Main::slot_PhaseChanged(newphase);
+}
+
+void Main::startMeasurement() {
+	clearEnergyMonitor();
+	if (pinned_tasks.empty()) return;
+
+	// The energy is measured for the whole system, so it's sufficient to start the monitor once
+	energy_tid = pinned_tasks.front().tid;
+	CHECK_ERRORV(energy_monitor->start(energy_tid));
+}
+
+double Main::evaluatePinning(double performance) {
+	double elapsed = measure_start.elapsed();
+	double energy = 0;
+
+	if (energy_tid != -1) {
+		CHECK_ERROR(energy = energy_monitor->stop(energy_tid), 0);
+		energy_tid = -1;
+	}
+
+	if (performance <= 0 || elapsed <= 0) {
+		context.info("  :: No work has been measured, the pinning is considered to be the worst one");
+		return std::numeric_limits<double>::max();
+	}
+
+	double delay = (performance_type == PerformanceMonitor::MAX) ? 1 / performance : performance;
+
+	// The energy needed for one unit of work is the power multiplied with the time needed for it
+	double work_energy = energy / elapsed * delay;
+
+	context.info("  :: Delay: " + QString::number(delay) + ", energy: " + QString::number(work_energy));
+
+	if (points.empty()) reference = std::make_pair(delay, work_energy);
+	points[current_pinning] = std::make_pair(delay, work_energy);
+
+	CHECK_ERROR(storePoints(), 0);
+
+	if (objective == "edp") return work_energy * delay;
+	if (objective == "ed2p") return work_energy * delay * delay;
+
+	double result = 0;
+	if (reference.first > 0) result += weight * delay / reference.first;
+	if (reference.second > 0) result += (1 - weight) * work_energy / reference.second;
+	return result;
+}
+
+// All pinnings are compared by the objective, smaller is better
+PerformanceMonitor::montype Main::objectiveType() { return PerformanceMonitor::MIN; }
+
+void Main::finish() {
+	context.info("");
+	context.info("> Pareto front of delay and energy:");
+
+	for (const auto &point : points) {
+		if (dominated(point.first)) continue;
+
+		context.info("  :: Pinning " + QString::number(point.first + 1) + " (" +
+					 PinningHistory::showPinning(pinnings[point.first]) + "): delay " +
+					 QString::number(point.second.first) + ", energy " + QString::number(point.second.second));
+	}
+
+	Autopin1::Main::finish();
+}
+
+void Main::restart() {
+	Autopin1::Main::restart();
+
+	// The new round of tuning is evaluated relative to its own first pinning
+	clearEnergyMonitor();
+	points.clear();
+	reference = std::make_pair(0.0, 0.0);
+}
+
+PerformanceMonitor *Main::findMonitor(const QString &name) {
+	for (auto candidate : monitors) {
+		if (candidate->getName() == name) return candidate;
+	}
+
+	return nullptr;
+}
+
+bool Main::dominated(int index) {
+	const auto &point = points[index];
+
+	for (const auto &other : points) {
+		if (other.first == index) continue;
+
+		const auto &values = other.second;
+		if (values.first <= point.first && values.second <= point.second &&
+			(values.first < point.first || values.second < point.second))
+			return true;
+	}
+
+	return false;
+}
+
+void Main::storePoints() {
+	if (history == nullptr) return;
+
+	int phase = proc->getExecutionPhase();
+
+	for (const auto &point : points) {
+		PinningHistory::pinning_metrics metrics;
+		metrics["delay"] = point.second.first;
+		metrics["energy"] = point.second.second;
+		metrics["pareto"] = dominated(point.first) ? 0 : 1;
+
+		history->setPinningMetrics(phase, pinnings[point.first], metrics);
+	}
+}
+
+void Main::clearEnergyMonitor() {
+	if (energy_tid == -1) return;
+
+	energy_monitor->clear(energy_tid);
+	energy_tid = -1;
+}
+
+} // namespace Pareto
+} // namespace Strategy
+} // namespace AutopinPlus
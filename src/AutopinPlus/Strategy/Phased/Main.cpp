@@ -0,0 +1,162 @@
+/*
+ * This file is part of Autopin+.
+ *
+ * Copyright (C) 2014 Alexander Kurtz <alexander@kurtz.be>
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AutopinPlus/Strategy/Phased/Main.h>
+
+#include <AutopinPlus/AutopinContext.h>		// for AutopinContext
+#include <AutopinPlus/Error.h>				// for CHECK_ERRORV
+#include <AutopinPlus/ObservedProcess.h>	// for ObservedProcess
+#include <AutopinPlus/PerformanceMonitor.h> // for PerformanceMonitor, etc
+#include <AutopinPlus/PinningHistory.h>		// for PinningHistory, etc
+#include <algorithm>							// for find_if
+#include <list>								// for list
+#include <qstring.h>						// for QString, operator+
+#include <qtimer.h>							// for QTimer
+
+namespace AutopinPlus {
+namespace Strategy {
+namespace Phased {
+
+Main::Main(Configuration *config, ObservedProcess *proc, OSServices *service,
+		   const PerformanceMonitor::monitor_list &monitors, PinningHistory *history, const AutopinContext &context)
+	: Autopin1::Main(config, proc, service, monitors, history, context) {
+	name = "phased";
+
+	// Start with the state of the current phase instead of the first pinning
+	disconnect(&init_timer, SIGNAL(timeout()), this, SLOT(slot_startPinning()));
+	connect(&init_timer, SIGNAL(timeout()), this, SLOT(slot_enterPhase()));
+}
+
+void Main::init() {
+	Autopin1::Main::init();
+
+	// Phase notifications are essential for this strategy
+	if (proc->getCommChanAddr() == "") {
+		context.enableIndentation();
+		context.info("  :: The communication channel is disabled, only phase 0 will be tuned");
+		context.disableIndentation();
+	}
+}
+
+void Main::slot_PhaseChanged(int newphase) {
+	// The current phase is read when the init time is over
+	if (init_timer.isActive()) return;
+
+	// Abort the current measurement, its results are useless now
+	warmup_timer.stop();
+	sample_timer.stop();
+	CHECK_ERRORV(stopWarmupMonitoring());
+
+	if (measure_timer.isActive()) {
+		measure_timer.stop();
+		for (auto &elem : pinned_tasks) {
+			if (elem.stop == -1) CHECK_ERRORV(monitor->stop(elem.tid));
+		}
+	}
+
+	pinned_tasks.clear();
+	notifications = false;
+
+	QTimer::singleShot(0, this, SLOT(slot_enterPhase()));
+}
+
+void Main::slot_enterPhase() {
+	int phase = proc->getExecutionPhase();
+	phase_state &state = getPhaseState(phase);
+
+	// Restore the progress of the phase
+	best_pinning = state.best;
+	best_performance = state.best_performance;
+
+	if ((uint)state.next < pinnings.size()) {
+		context.enableIndentation();
+		context.info("");
+		context.info("> Tuning phase " + QString::number(phase) + ", continuing with pinning " +
+					 QString::number(state.next + 1));
+		context.disableIndentation();
+
+		current_pinning = state.next;
+		slot_startPinning();
+	} else {
+		context.enableIndentation();
+		finish();
+		context.disableIndentation();
+	}
+}
+
+bool Main::nextPinning(double result) {
+	phase_state &state = getPhaseState(proc->getExecutionPhase());
+
+	state.next = current_pinning + 1;
+	state.best = best_pinning;
+	state.best_performance = best_performance;
+
+	current_pinning = state.next;
+	return (uint)current_pinning < pinnings.size();
+}
+
+void Main::finish() {
+	int phase = proc->getExecutionPhase();
+
+	context.info("");
+	context.info("> Applying best pinning of phase " + QString::number(phase) + ": " +
+				 QString::number(best_pinning + 1));
+
+	CHECK_ERRORV(refreshTasks());
+	applyPinning(pinnings[best_pinning]);
+}
+
+Main::phase_state &Main::getPhaseState(int phase) {
+	auto it = phases.find(phase);
+	if (it != phases.end()) return it->second;
+
+	phase_state &state = phases[phase];
+	if (history == nullptr) return state;
+
+	// Check if the history already contains results for all pinnings of this phase
+	std::list<PinningHistory::pinning_result> results = history->getPinnings(phase);
+	phase_state known;
+
+	for (uint i = 0; i < pinnings.size(); i++) {
+		auto result = std::find_if(results.begin(), results.end(), [&](const PinningHistory::pinning_result &r) {
+			return r.first == pinnings[i];
+		});
+		if (result == results.end()) return state;
+
+		bool better = (monitor_type == PerformanceMonitor::MIN) ? result->second < known.best_performance
+																: result->second > known.best_performance;
+		if (known.best == -1 || better) {
+			known.best = i;
+			known.best_performance = result->second;
+		}
+	}
+
+	context.enableIndentation();
+	context.info("> Using the results of phase " + QString::number(phase) + " from the pinning history");
+	context.disableIndentation();
+
+	known.next = pinnings.size();
+	state = known;
+
+	return state;
+}
+
+} // namespace Phased
+} // namespace Strategy
+} // namespace AutopinPlus
@@ -28,6 +28,7 @@
 
 #include <AutopinPlus/XMLPinningHistory.h>
 
+#include <AutopinPlus/Exception.h>
 #include <deque>
 #include <iostream>
 #include <QDate>
@@ -86,6 +87,9 @@ void XMLPinningHistory::init() {
 			hreader.readNextStartElement();
 			if (hreader.name() == "ControlStrategy") {
 				strategy = hreader.attributes().value("type").toString();
+
+				// Histories without an objective have been written when bigger values were always better
+				if (hreader.attributes().value("objective").toString() == "MIN") objective = PerformanceMonitor::MIN;
 				break;
 			}
 		}
@@ -112,7 +116,7 @@ void XMLPinningHistory::init() {
 		}
 
 		// Read pinnings
-		int current_phase = -1;
+		int current_phase = -1, skipped = 0;
 		while (!hreader.atEnd()) {
 			hreader.readNext();
 			if (hreader.isStartElement()) {
@@ -121,10 +125,47 @@ void XMLPinningHistory::init() {
 				else if (hreader.name() == "Pinning") {
 					QString sched = hreader.attributes().value("sched").toString();
 					QStringList sched_list = sched.split(':');
+					QString samples = hreader.attributes().value("samples").toString();
+					QString variance = hreader.attributes().value("variance").toString();
+					QString tasks = hreader.attributes().value("tasks").toString();
+					QString placement = hreader.attributes().value("placement").toString();
+					pinning_metrics metrics;
+					for (const auto &attribute : hreader.attributes()) {
+						QString key = attribute.name().toString();
+						if (key != "sched" && key != "samples" && key != "variance" && key != "tasks" &&
+							key != "placement")
+							metrics[key] = attribute.value().toString().toDouble();
+					}
 					autopin_pinning pinning;
 					double value = hreader.readElementText().toDouble();
-					for (int i = 0; i < sched_list.size(); ++i) pinning.push_back(sched_list[i].toInt());
-					addPinning(current_phase, pinning, value);
+					if (!placement.isEmpty() && !placement_cpus.empty()) {
+						// Pinnings relative to the topology are resolved on this system, pinnings which can't be
+						// placed here (e.g. on a second socket) are only kept for predicting other pinnings
+						try {
+							pinning = readPlacement(placement);
+						} catch (Exception e) {
+							context.debug("Skipping pinning " + placement + " which doesn't fit the topology");
+							addUnplacedResult(current_phase, placement, value);
+							skipped++;
+							continue;
+						}
+					} else {
+						try {
+							for (int i = 0; i < sched_list.size(); ++i) pinning.push_back(readCpuSet(sched_list[i]));
+						} catch (Exception e) {
+							context.report(Error::HISTORY, "bad_syntax",
+										   "Error in file " + history_load_path + ": Invalid pinning " + sched);
+							return;
+						}
+					}
+					if (samples.isEmpty()) {
+						addPinning(current_phase, pinning, value);
+					} else {
+						pinning_stats stats = {samples.toInt(), variance.toDouble()};
+						addPinning(current_phase, pinning, value, stats);
+					}
+					if (!metrics.empty()) setPinningMetrics(current_phase, pinning, metrics);
+					if (!tasks.isEmpty()) setPinningTasks(current_phase, pinning, tasks.split(':'));
 					// context.info("Added pinning: phase: "+QString::number(current_phase)+", pinning: "+sched+",
 					// value: "+QString::number(value));
 				}
@@ -142,6 +183,9 @@ void XMLPinningHistory::init() {
 		}
 
 		hfile.close();
+
+		if (skipped > 0)
+			context.info("  :: Skipped " + QString::number(skipped) + " pinnings which don't fit the topology");
 	}
 
 	if (!history_save_path.isEmpty()) context.info("  :: Changes will be saved to " + history_save_path);
@@ -199,6 +243,7 @@ void XMLPinningHistory::deinit() {
 
 		hwriter.writeStartElement("ControlStrategy");
 		hwriter.writeAttribute("type", strategy);
+		hwriter.writeAttribute("objective", PerformanceMonitor::showMontype(objective));
 		writeNodeChildren(hwriter, strategy_options);
 		hwriter.writeEndElement();
 
@@ -235,12 +280,18 @@ void XMLPinningHistory::writePinnings(QXmlStreamWriter &xmlstream) {
 		xmlstream.writeAttribute("id", QString::number(phase));
 		for (auto jt = pinmap[phase].begin(); jt != pinmap[phase].end(); jt++) {
 			xmlstream.writeStartElement("Pinning");
-			QString pinstr;
-			for (auto kt = jt->first.begin(); kt != jt->first.end(); kt++) {
-				if (kt != jt->first.begin()) pinstr += ":";
-				pinstr += QString::number(*kt);
+			xmlstream.writeAttribute("sched", showPinning(jt->first));
+			QString placement = showPlacement(jt->first);
+			if (!placement.isEmpty()) xmlstream.writeAttribute("placement", placement);
+			pinning_stats stats = getPinningStats(phase, jt->first);
+			if (stats.samples > 0) {
+				xmlstream.writeAttribute("samples", QString::number(stats.samples));
+				xmlstream.writeAttribute("variance", QString::number(stats.variance));
 			}
-			xmlstream.writeAttribute("sched", pinstr);
+			QStringList tasks = getPinningTasks(phase, jt->first);
+			if (!tasks.empty()) xmlstream.writeAttribute("tasks", tasks.join(":"));
+			for (const auto &metric : getPinningMetrics(phase, jt->first))
+				xmlstream.writeAttribute(metric.first, QString::number(metric.second));
 			xmlstream.writeCharacters(QString::number(jt->second));
 			xmlstream.writeEndElement();
 		}
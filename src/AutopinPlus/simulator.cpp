@@ -0,0 +1,59 @@
+/*
+ * Autopin+ - Automatic thread-to-core-pinning tool
+ * Copyright (C) 2012 LRR
+ *
+ * Author:
+ * Florian Walter
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contact address:
+ * LRR (I10)
+ * Technische Universitaet Muenchen
+ * Boltzmannstr. 3
+ * D-85784 Garching b. Muenchen
+ * http://autopin.in.tum.de
+ */
+
+#include <AutopinPlus/OS/Simulator/EventDispatcher.h>
+#include <AutopinPlus/OS/Simulator/Simulator.h>
+
+/*!
+ * \brief main-function of the autopin+ simulator
+ *
+ * Installs the virtual time event dispatcher, creates the application and starts the event loop.
+ *
+ * \param[in] argc 	The number of command line arguments
+ * \param[in] argv	String array with command line arguments
+ *
+ * \return		Return value of the application
+ */
+int main(int argc, char **argv) {
+	// The dispatcher has to exist before the application, otherwise Qt installs its own
+	new AutopinPlus::OS::Simulator::EventDispatcher();
+
+	AutopinPlus::OS::Simulator::Simulator app(argc, argv);
+
+	app.setApplicationName("autopin+-sim");
+	app.setApplicationVersion("1.0.0");
+
+	// Connect the start-/quit-signals with the slots of the Simulator-object
+	QObject::connect(&app, SIGNAL(sig_eventLoopStarted()), &app, SLOT(slot_autopinSetup()));
+	QObject::connect(&app, SIGNAL(aboutToQuit()), &app, SLOT(slot_simulatorSummary()));
+	QObject::connect(&app, SIGNAL(aboutToQuit()), &app, SLOT(slot_autopinCleanup()));
+
+	QTimer::singleShot(0, &app, SIGNAL(sig_eventLoopStarted()));
+
+	return app.exec();
+}